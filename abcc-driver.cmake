@@ -6,13 +6,16 @@ endif()
 
 # Complete list of source (.c) files inside the Anybus CompactCom Driver. 
 set(abcc_driver_SRCS
+   ${ABCC_DRIVER_DIR}/src/abcc_cmd_async.c
    ${ABCC_DRIVER_DIR}/src/abcc_command_sequencer.c
    ${ABCC_DRIVER_DIR}/src/abcc_copy.c
    ${ABCC_DRIVER_DIR}/src/abcc_handler.c
    ${ABCC_DRIVER_DIR}/src/abcc_link.c
    ${ABCC_DRIVER_DIR}/src/abcc_log.c
    ${ABCC_DRIVER_DIR}/src/abcc_memory.c
+   ${ABCC_DRIVER_DIR}/src/abcc_pd_exchange.c
    ${ABCC_DRIVER_DIR}/src/abcc_remap.c
+   ${ABCC_DRIVER_DIR}/src/abcc_rx_dispatch.c
    ${ABCC_DRIVER_DIR}/src/abcc_segmentation.c
    ${ABCC_DRIVER_DIR}/src/abcc_setup.c
    ${ABCC_DRIVER_DIR}/src/abcc_timer.c
@@ -41,11 +44,14 @@ set(abcc_driver_INCS
    ${ABCC_DRIVER_DIR}/inc/abcc_log.h
    ${ABCC_DRIVER_DIR}/inc/abcc_message.h
    ${ABCC_DRIVER_DIR}/inc/abcc_port.h
+   ${ABCC_DRIVER_DIR}/src/abcc_cmd_async.h
    ${ABCC_DRIVER_DIR}/src/abcc_command_sequencer.h
    ${ABCC_DRIVER_DIR}/src/abcc_driver_interface.h
    ${ABCC_DRIVER_DIR}/src/abcc_handler.h
    ${ABCC_DRIVER_DIR}/src/abcc_link.h
    ${ABCC_DRIVER_DIR}/src/abcc_memory.h
+   ${ABCC_DRIVER_DIR}/src/abcc_pd_exchange.h
+   ${ABCC_DRIVER_DIR}/src/abcc_rx_dispatch.h
    ${ABCC_DRIVER_DIR}/src/abcc_segmentation.h
    ${ABCC_DRIVER_DIR}/src/abcc_setup.h
    ${ABCC_DRIVER_DIR}/src/abcc_timer.h
@@ -16,13 +16,16 @@ ABCC_ABP_DIR := $(ABCC_DRIVER_DIR)/abcc-abp
 include $(ABCC_ABP_DIR)/abcc-abp.mk
 
 # add the Anybus CompactCom Driver source files
+SRCS += $(ABCC_DRIVER_DIR)/src/abcc_cmd_async.c
 SRCS += $(ABCC_DRIVER_DIR)/src/abcc_command_sequencer.c
 SRCS += $(ABCC_DRIVER_DIR)/src/abcc_copy.c
 SRCS += $(ABCC_DRIVER_DIR)/src/abcc_handler.c
 SRCS += $(ABCC_DRIVER_DIR)/src/abcc_link.c
 SRCS += $(ABCC_DRIVER_DIR)/src/abcc_log.c
 SRCS += $(ABCC_DRIVER_DIR)/src/abcc_memory.c
+SRCS += $(ABCC_DRIVER_DIR)/src/abcc_pd_exchange.c
 SRCS += $(ABCC_DRIVER_DIR)/src/abcc_remap.c
+SRCS += $(ABCC_DRIVER_DIR)/src/abcc_rx_dispatch.c
 SRCS += $(ABCC_DRIVER_DIR)/src/abcc_segmentation.c
 SRCS += $(ABCC_DRIVER_DIR)/src/abcc_setup.c
 SRCS += $(ABCC_DRIVER_DIR)/src/abcc_timer.c
@@ -94,6 +94,142 @@ typedef enum ABCC_ParameterSupportType
 }
 ABCC_ParameterSupportType;
 
+/*------------------------------------------------------------------------------
+** Usage statistics of one size class of the message buffer pool, see
+** ABCC_MemGetStats().
+**
+** iBufferSize:        Size of the message data area of the buffers in octets.
+** iNumBuffers:        Number of buffers in the class.
+** iNumFree:           Number of buffers currently in the pool.
+** iMaxNumUsed:        Highest number of buffers allocated at the same time.
+** lNumAllocFailures:  Number of times the class was empty when a buffer was
+**                     requested from it. A request that falls back to a larger
+**                     class is counted in each empty class it passes.
+** iNumAllocated, iNumInApplHandler, iNumSent, iNumOwned:
+**                     Number of buffers currently in each buffer state.
+**------------------------------------------------------------------------------
+*/
+typedef struct ABCC_MemStats
+{
+   UINT16 iBufferSize;
+   UINT16 iNumBuffers;
+   UINT16 iNumFree;
+   UINT16 iMaxNumUsed;
+   UINT32 lNumAllocFailures;
+   UINT16 iNumAllocated;
+   UINT16 iNumInApplHandler;
+   UINT16 iNumSent;
+   UINT16 iNumOwned;
+}
+ABCC_MemStatsType;
+
+/*------------------------------------------------------------------------------
+** Command queueing delay statistics of one priority class, see
+** ABCC_GetCmdQueueStats().
+**
+** lNumCmds:       Number of commands handed to the operating mode driver.
+** lTotalDelayMs:  Sum of the queueing delays of all commands.
+** lMaxDelayMs:    Longest queueing delay.
+**------------------------------------------------------------------------------
+*/
+typedef struct ABCC_CmdQueueStats
+{
+   UINT32 lNumCmds;
+   UINT32 lTotalDelayMs;
+   UINT32 lMaxDelayMs;
+}
+ABCC_CmdQueueStatsType;
+
+/*------------------------------------------------------------------------------
+** Command latency phases, see ABCC_LatencyStatsType.
+**
+** ABCC_LATENCY_QUEUE:     From ABCC_SendCmdMsg() until the command is handed
+**                         to the operating mode driver.
+** ABCC_LATENCY_TRANSMIT:  From the hand-off until the driver has completed the
+**                         transmission, including all fragments.
+** ABCC_LATENCY_RESPONSE:  From the completed transmission until the response
+**                         is routed to the response handler.
+**------------------------------------------------------------------------------
+*/
+typedef enum ABCC_LatencyPhase
+{
+   ABCC_LATENCY_QUEUE = 0,
+   ABCC_LATENCY_TRANSMIT,
+   ABCC_LATENCY_RESPONSE,
+   ABCC_LATENCY_NUM_PHASES
+}
+ABCC_LatencyPhaseType;
+
+/*------------------------------------------------------------------------------
+** Number of buckets in a latency histogram. The latencies are measured in us
+** if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED is set and in ms otherwise. Bucket 0
+** counts latencies below 1 unit and bucket n counts latencies from 2^(n-1) up
+** to 2^n units. The last bucket also counts all longer latencies.
+**------------------------------------------------------------------------------
+*/
+#if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED
+#define ABCC_LATENCY_NUM_BUCKETS    26
+#else
+#define ABCC_LATENCY_NUM_BUCKETS    16
+#endif
+
+/*------------------------------------------------------------------------------
+** Latency statistics of the commands sent to one destination object, see
+** ABCC_GetLatencyStats().
+**
+** lNumCmds:       Number of responses received.
+** alMax:          Longest latency per phase in us or ms, see
+**                 ABCC_LATENCY_NUM_BUCKETS.
+** aalHistogram:   Latency histogram per phase.
+**------------------------------------------------------------------------------
+*/
+typedef struct ABCC_LatencyStats
+{
+   UINT32 lNumCmds;
+   UINT32 alMax[ ABCC_LATENCY_NUM_PHASES ];
+   UINT32 aalHistogram[ ABCC_LATENCY_NUM_PHASES ][ ABCC_LATENCY_NUM_BUCKETS ];
+}
+ABCC_LatencyStatsType;
+
+/*------------------------------------------------------------------------------
+** Parallel ISR statistics, see ABCC_GetIsrStats().
+**
+** lNumIsr:           Number of ISR invocations.
+** lNumStatusReads:   Number of interrupt status register reads. The ISR
+**                    reads the register until no enabled interrupt is
+**                    pending.
+** lMaxStatusReads:   Most status register reads in one invocation.
+** lNumRdPd:          Number of RDPD events.
+** lNumRdMsg:         Number of RDMSG events.
+** lNumWrMsg:         Number of WRMSG events.
+** lNumAnbr:          Number of ANBR events.
+** lNumStatus:        Number of STATUS events.
+** lNumSync:          Number of SYNC events.
+** lNumDeferred:      Number of invocations where events were deferred to
+**                    ABCC_RunDriver(), see ABCC_CFG_INT_COALESCE_MASK.
+** lNumWindowExpired: Number of times deferred events were handled by the ISR
+**                    since ABCC_RunDriver() was not called in time.
+** lMaxDuration:      Longest ISR duration in ABCC_PORT_GetTimestamp() units.
+**                    0 if the port does not define ABCC_PORT_GetTimestamp().
+**------------------------------------------------------------------------------
+*/
+typedef struct ABCC_IsrStats
+{
+   UINT32 lNumIsr;
+   UINT32 lNumStatusReads;
+   UINT32 lMaxStatusReads;
+   UINT32 lNumRdPd;
+   UINT32 lNumRdMsg;
+   UINT32 lNumWrMsg;
+   UINT32 lNumAnbr;
+   UINT32 lNumStatus;
+   UINT32 lNumSync;
+   UINT32 lNumDeferred;
+   UINT32 lNumWindowExpired;
+   UINT32 lMaxDuration;
+}
+ABCC_IsrStatsType;
+
 /*------------------------------------------------------------------------------
 ** This function is used to measure sync timings.
 ** ABCC_CFG_SYNC_MEASUREMENT_OP_ENABLED is used when measuring the output
@@ -260,6 +396,38 @@ EXTFUNC void ABCC_RunTimerSystem( const INT16 iDeltaTimeMs );
 */
 EXTFUNC UINT64 ABCC_GetUptimeMs( void );
 
+#if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED
+/*------------------------------------------------------------------------------
+** Alternative to ABCC_RunTimerSystem() that reads the elapsed time from
+** ABCC_HAL_GetTimestampNs() instead of taking it as an argument. Elapsed time
+** below 1 ms is carried over to the next call, so the uptime does not drift
+** regardless of how often the function is called. Use either this function or
+** ABCC_RunTimerSystem(), not both, and call it from one context only.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_RunTimerSystemFromHal( void );
+#endif
+
+/*------------------------------------------------------------------------------
+** Returns a high resolution timestamp. If ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED is
+** set this is ABCC_HAL_GetTimestampNs(), otherwise the driver uptime converted
+** to ns.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    Timestamp in ns.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT64 ABCC_GetTimestampNs( void );
+
 /*------------------------------------------------------------------------------
 ** ABCC hardware reset.
 ** Note! This function will only set reset pin to low. It the responsibility of
@@ -302,6 +470,84 @@ EXTFUNC void ABCC_HWReleaseReset( void );
 */
 EXTFUNC ABCC_ErrorCodeType ABCC_RunDriver( void );
 
+/*------------------------------------------------------------------------------
+** Pending work reported by ABCC_RunDriverEx().
+**
+** ABCC_RUN_PENDING_TX_MSG:   Messages are queued, waiting for the ABCC to
+**                            accept them.
+** ABCC_RUN_PENDING_POLL:     The operating mode must be polled, the next
+**                            deadline is at most
+**                            ABCC_CFG_RUN_DRIVER_POLL_INTERVAL_MS.
+** ABCC_RUN_PENDING_TIMER:    A driver timer is running, the next deadline is
+**                            at most the time until it expires.
+**
+** ABCC_RUN_NO_DEADLINE is reported as next deadline if nothing has to be done
+** until the next ABCC interrupt or application request.
+**------------------------------------------------------------------------------
+*/
+#define ABCC_RUN_PENDING_TX_MSG     0x01
+#define ABCC_RUN_PENDING_POLL       0x02
+#define ABCC_RUN_PENDING_TIMER      0x04
+
+#define ABCC_RUN_NO_DEADLINE        0xFFFFFFFFUL
+
+/*------------------------------------------------------------------------------
+** Same as ABCC_RunDriver() but also reports what work is pending and the time
+** until the driver has to run again. This allows the application to sleep
+** until that deadline, an ABCC interrupt (ABCC_CbfEvent()) or an application
+** request instead of calling ABCC_RunDriver() cyclically. When woken up, the
+** elapsed time must be passed to ABCC_RunTimerSystem() before ABCC_RunDriverEx()
+** is called again.
+**------------------------------------------------------------------------------
+** Arguments:
+**    pbPendingWork      - Set to a bit mask of ABCC_RUN_PENDING_X.
+**    plNextDeadlineMs   - Set to the time in ms until the next call is needed,
+**                         or ABCC_RUN_NO_DEADLINE.
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_RunDriverEx( UINT8* pbPendingWork,
+                                             UINT32* plNextDeadlineMs );
+
+#if ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED
+/*------------------------------------------------------------------------------
+** Transfer part of ABCC_RunDriver(), see ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED.
+** Sends queued messages and write process data, starts the next transfer and
+** validates the received frame. The received messages, read process data and
+** Anybus state changes are queued for ABCC_RunDriverRx(). No new transfer is
+** started while the queue is full.
+**
+** ABCC_CbfUpdateWriteProcessData() is called from this context.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_RunDriverTx( void );
+
+/*------------------------------------------------------------------------------
+** Dispatch part of ABCC_RunDriver(), see ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED.
+** Dispatches the frames queued by ABCC_RunDriverTx() and runs the command
+** sequencer and response timeouts. ABCC_CbfNewReadPd(),
+** ABCC_CbfAnbStateChanged(), ABCC_CbfHandleCommandMessage() and the response
+** handlers are called from this context. May run in a different thread than
+** ABCC_RunDriverTx(), but each function must only be called from one thread.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_RunDriverRx( void );
+#endif
+
 /*------------------------------------------------------------------------------
 ** This function should be called by the application when the last response from
 ** the user specific setup has been received. This will end the ABCC setup
@@ -321,7 +567,12 @@ EXTFUNC void ABCC_UserInitComplete( void );
 /*------------------------------------------------------------------------------
 ** Sends a command message to the ABCC.
 ** The function ABCC_GetCmdMsgBuffer() must be used to allocate the message
-** buffer. It is OK to re-use a previously received response buffer
+** buffer. It is OK to re-use a previously received response buffer, but the
+** message data must fit ABCC_GetMsgBufferSize() of the buffer. A larger
+** message is rejected with ABCC_EC_WRMSG_SIZE_ERR.
+** If ABCC_EC_NO_ERROR is returned the buffer is owned by the driver. If
+** ABCC_EC_LINK_CMD_QUEUE_FULL is returned the driver has returned the buffer to
+** the pool. For any other error the buffer is still owned by the application.
 ** The driver will use the sourceId to map the response to the correct response
 ** handler. ABCC_GetNewSourceId() could be used to provide an new source id.
 ** Example where ABCC_CbfMessageReceived() function is used as response handler:
@@ -340,6 +591,219 @@ EXTFUNC void ABCC_UserInitComplete( void );
 EXTFUNC ABCC_ErrorCodeType ABCC_SendCmdMsg( ABP_MsgType* psCmdMsg,
                                             ABCC_MsgHandlerFuncType pnMsgHandler );
 
+/*------------------------------------------------------------------------------
+** Sends a command message to the ABCC with a given priority, see
+** ABCC_SendCmdMsg(). If the command has to be queued it is sent before all
+** queued commands of lower priority. See ABCC_CFG_NUM_CMD_PRIO in
+** abcc_config.h.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psCmdMsg     - Pointer to the command message.
+**    pnMsgHandler - Pointer to the function to handle the response
+**                   message.
+**    bPriority    - Priority class, 0 (lowest) to ABCC_CFG_NUM_CMD_PRIO - 1.
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_SendCmdMsgWithPriority( ABP_MsgType* psCmdMsg,
+                                                        ABCC_MsgHandlerFuncType pnMsgHandler,
+                                                        UINT8 bPriority );
+
+/*------------------------------------------------------------------------------
+** Sends a command message to the ABCC with a given priority and response
+** timeout, see ABCC_SendCmdMsgWithPriority() and ABCC_SendCmdMsgWithTimeout().
+**------------------------------------------------------------------------------
+** Arguments:
+**    psCmdMsg     - Pointer to the command message.
+**    pnMsgHandler - Pointer to the function to handle the response
+**                   message.
+**    bPriority    - Priority class, 0 (lowest) to ABCC_CFG_NUM_CMD_PRIO - 1.
+**    lTimeoutMs   - Time to wait for the response in ms, 0 for no timeout.
+**                   Must be 0 unless ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED is set.
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_SendCmdMsgEx( ABP_MsgType* psCmdMsg,
+                                              ABCC_MsgHandlerFuncType pnMsgHandler,
+                                              UINT8 bPriority,
+                                              UINT32 lTimeoutMs );
+
+/*------------------------------------------------------------------------------
+** One command of ABCC_SendCmdMsgBatch().
+**
+** psCmdMsg:       Command message.
+** pnMsgHandler:   Response handler.
+** bPriority:      Priority class, see ABCC_SendCmdMsgWithPriority().
+** lTimeoutMs:     Response timeout in ms, 0 for no timeout. See
+**                 ABCC_SendCmdMsgWithTimeout().
+**------------------------------------------------------------------------------
+*/
+typedef struct ABCC_CmdMsgBatchEntry
+{
+   ABP_MsgType*            psCmdMsg;
+   ABCC_MsgHandlerFuncType pnMsgHandler;
+   UINT8                   bPriority;
+   UINT32                  lTimeoutMs;
+}
+ABCC_CmdMsgBatchEntryType;
+
+/*------------------------------------------------------------------------------
+** Sends a burst of command messages to the ABCC, see ABCC_SendCmdMsgEx().
+** All response handlers are mapped and all commands are queued within one
+** critical section. Either all commands are accepted or none of them. The
+** buffers follow the same ownership rule as for ABCC_SendCmdMsg(): if
+** ABCC_EC_LINK_CMD_QUEUE_FULL is returned the driver has returned all of them
+** to the pool, for any other error they are still owned by the application.
+**------------------------------------------------------------------------------
+** Arguments:
+**    pasCmds        - Array of commands.
+**    bNumMsgs       - Number of commands. Nothing is sent if 0.
+**
+** Returns:
+**    ABCC_ErrorCodeType, ABCC_EC_PARAMETER_NOT_VALID if an entry is not a
+**    valid command.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_SendCmdMsgBatch( const ABCC_CmdMsgBatchEntryType* pasCmds,
+                                                 UINT8 bNumMsgs );
+
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+/*------------------------------------------------------------------------------
+** Sends a command message to the ABCC, see ABCC_SendCmdMsg().
+** If no response has been received within lTimeoutMs the response handler is
+** called with a timeout response built from the header of the command, see
+** ABCC_IsRespTimeout(). If the command was still queued it is removed and never
+** sent. Otherwise the ABCC has the command, so its command resource
+** (ABCC_GetCmdQueueSize()) and source id stay in use until the response
+** arrives, which is then discarded, or at most for
+** ABCC_CFG_CMD_RESP_TIMEOUT_GRACE_MS more. The timeout is checked from
+** ABCC_RunDriver() with the resolution of ABCC_RunTimerSystem().
+**------------------------------------------------------------------------------
+** Arguments:
+**    psCmdMsg     - Pointer to the command message.
+**    pnMsgHandler - Pointer to the function to handle the response
+**                   message.
+**    lTimeoutMs   - Time to wait for the response in ms.
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_SendCmdMsgWithTimeout( ABP_MsgType* psCmdMsg,
+                                                       ABCC_MsgHandlerFuncType pnMsgHandler,
+                                                       UINT32 lTimeoutMs );
+
+/*------------------------------------------------------------------------------
+** Checks if a message passed to a response handler is the timeout response of
+** ABCC_SendCmdMsgWithTimeout(). The timeout response is a response with the
+** E-bit set and no message data, so unlike a real error response it carries no
+** error code.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psMsg        - Pointer to the response message.
+**
+** Returns:
+**    TRUE if no response was received from the ABCC in time.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_IsRespTimeout( const ABP_MsgType* psMsg );
+#endif
+
+#if ABCC_CFG_CMD_ASYNC_ENABLED
+/*------------------------------------------------------------------------------
+** Handle of a command sent with ABCC_SendCmdAsync(). A handle is valid until
+** the response has been taken with ABCC_CmdTake().
+**------------------------------------------------------------------------------
+*/
+typedef UINT16 ABCC_CmdHandleType;
+
+#define ABCC_CMD_HANDLE_INVALID     ( (ABCC_CmdHandleType)0 )
+
+/*------------------------------------------------------------------------------
+** Sends a command message to the ABCC, see ABCC_SendCmdMsg(). Instead of
+** calling a response handler the driver keeps the response, which is fetched
+** with ABCC_CmdTake() once ABCC_CmdPoll() or ABCC_CmdWait() reports that it has
+** arrived. See ABCC_CFG_CMD_ASYNC_ENABLED.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psCmdMsg     - Pointer to the command message.
+**    pxHandle     - Set to the handle of the command, or to
+**                   ABCC_CMD_HANDLE_INVALID if an error is returned.
+**
+** Returns:
+**    ABCC_ErrorCodeType, ABCC_EC_NO_RESOURCES if all handles are in use.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_SendCmdAsync( ABP_MsgType* psCmdMsg,
+                                              ABCC_CmdHandleType* pxHandle );
+
+/*------------------------------------------------------------------------------
+** Checks if the response of a command has arrived. Does not block.
+**------------------------------------------------------------------------------
+** Arguments:
+**    xHandle      - Command handle from ABCC_SendCmdAsync().
+**
+** Returns:
+**    TRUE if the response can be taken with ABCC_CmdTake().
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_CmdPoll( ABCC_CmdHandleType xHandle );
+
+/*------------------------------------------------------------------------------
+** Waits for the response of a command. While waiting ABCC_PORT_CmdWaitYield()
+** is called, which by default runs ABCC_RunDriver(). Must not be called from a
+** driver callback.
+** The time is measured with ABCC_GetTimestampNs(). Unless
+** ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED is set that is the uptime of the timer
+** system, which only advances when ABCC_RunTimerSystem() is called. It must
+** then be called from another context, e.g. a timer interrupt, or from
+** ABCC_PORT_CmdWaitYield(), otherwise the wait never times out.
+**------------------------------------------------------------------------------
+** Arguments:
+**    xHandle      - Command handle from ABCC_SendCmdAsync().
+**    lTimeoutMs   - Longest time to wait in ms.
+**
+** Returns:
+**    TRUE if the response can be taken with ABCC_CmdTake(), FALSE on timeout
+**    or if the handle is not valid.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_CmdWait( ABCC_CmdHandleType xHandle, UINT32 lTimeoutMs );
+
+/*------------------------------------------------------------------------------
+** Takes the response of a command and releases the handle. The application
+** owns the returned buffer and must return it with ABCC_ReturnMsgBuffer(), or
+** reuse it for a new command.
+**------------------------------------------------------------------------------
+** Arguments:
+**    xHandle      - Command handle from ABCC_SendCmdAsync().
+**
+** Returns:
+**    The response message, NULL if it has not arrived or if the handle is not
+**    valid.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABP_MsgType* ABCC_CmdTake( ABCC_CmdHandleType xHandle );
+
+/*------------------------------------------------------------------------------
+** Cancels a command and releases the handle. A response that has already
+** arrived is freed. Otherwise the response is discarded when it arrives, and
+** until then the command keeps its handle entry and its source id.
+**------------------------------------------------------------------------------
+** Arguments:
+**    xHandle      - Command handle from ABCC_SendCmdAsync().
+**
+** Returns:
+**    TRUE if the command was cancelled, FALSE if the handle is not valid.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_CmdCancel( ABCC_CmdHandleType xHandle );
+#endif
+
 /*------------------------------------------------------------------------------
 ** Retrieves the number of entries left in the command queue.
 ** Note! When sending a message the returned status must always be checked to
@@ -354,11 +818,116 @@ EXTFUNC ABCC_ErrorCodeType ABCC_SendCmdMsg( ABP_MsgType* psCmdMsg,
 */
 EXTFUNC UINT16 ABCC_GetCmdQueueSize( void );
 
+#if ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+/*------------------------------------------------------------------------------
+** Retrieves the command queueing delay statistics of a priority class. The
+** delay is the time from ABCC_SendCmdMsg() until the command is handed to the
+** operating mode driver. The statistics are reset when the driver is started.
+**------------------------------------------------------------------------------
+** Arguments:
+**    bPriority    - Priority class.
+**    psStats      - Pointer to the statistics to fill in.
+**
+** Returns:
+**    TRUE if the priority class exists, FALSE otherwise.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_GetCmdQueueStats( UINT8 bPriority, ABCC_CmdQueueStatsType* psStats );
+#endif
+
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+/*------------------------------------------------------------------------------
+** Retrieves the latency statistics of the commands sent to a destination
+** object. The latencies are measured in us with ABCC_HAL_GetTimestampNs() if
+** ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED is set and with the resolution of the
+** driver uptime (ms) otherwise. The statistics are cleared when the driver is
+** started.
+**------------------------------------------------------------------------------
+** Arguments:
+**    bObject      - Destination object of the commands.
+**    psStats      - Pointer to the statistics to fill in.
+**    fReset       - TRUE to clear the statistics of the object after reading.
+**
+** Returns:
+**    TRUE if statistics are kept for the object, FALSE otherwise.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_GetLatencyStats( UINT8 bObject,
+                                   ABCC_LatencyStatsType* psStats,
+                                   BOOL fReset );
+#endif
+
+#if ABCC_CFG_ISR_STATS_ENABLED
+/*------------------------------------------------------------------------------
+** Retrieves the statistics of the parallel operating mode ISR.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psStats      - Pointer to the statistics to fill in.
+**    fReset       - TRUE to clear the statistics after reading.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_GetIsrStats( ABCC_IsrStatsType* psStats, BOOL fReset );
+#endif
+
+#if ABCC_CFG_PD_TRIPLE_BUFFER_ENABLED
+/*------------------------------------------------------------------------------
+** Fetches the latest complete read process data image received by the driver.
+** The image stays valid and unchanged until the next call. May be called from
+** any single application thread, concurrently with the driver.
+**------------------------------------------------------------------------------
+** Arguments:
+**    ppxReadPd    - Returns a pointer to the read process data image.
+**    piSize       - Returns the size of the image in bytes. 0 until the first
+**                   image has been received.
+**
+** Returns:
+**    TRUE  - The image is new since the last call.
+**    FALSE - No new image has been received since the last call.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_PdGetLatestReadPd( const void** ppxReadPd, UINT16* piSize );
+
+/*------------------------------------------------------------------------------
+** Returns the buffer where the application builds the next write process data
+** image. The buffer holds the image last published, so only changed fields
+** need to be updated. The buffer changes on every call to
+** ABCC_PdPublishWritePd().
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    Pointer to a buffer of ABCC_CFG_MAX_PROCESS_DATA_SIZE bytes.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void* ABCC_PdGetWriteBuffer( void );
+
+/*------------------------------------------------------------------------------
+** Publishes the image in the buffer returned by ABCC_PdGetWriteBuffer(). The
+** driver sends the latest published image at its next write process data
+** update. Images published in between are overwritten. May be called from any
+** single application thread, concurrently with the driver.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_PdPublishWritePd( void );
+#endif
+
 /*------------------------------------------------------------------------------
 ** Sends a response message to the ABCC.
 ** Note! The received command buffer can be reused as a response buffer. If a
 ** new buffer is used then the function ABCC_GetCmdMsgBuffer() must be used to
-** allocate the buffer.
+** allocate the buffer. The message data must fit ABCC_GetMsgBufferSize() of the
+** buffer, a larger message is rejected with ABCC_EC_WRMSG_SIZE_ERR and the
+** buffer is still owned by the application.
 **------------------------------------------------------------------------------
 ** Arguments:
 **    psMsgResp - Pointer to the message.
@@ -389,7 +958,9 @@ EXTFUNC ABCC_ErrorCodeType ABCC_SendRespMsg( ABP_MsgType* psMsgResp );
 **    lSize          - Size of first payload block.
 **    pnNext         - Callback to request the next data block.
 **                     NULL if all data is supplied in pxData.
-**    pnDone         - Callback to indicate that the entire message is sent.
+**    pnDone         - Callback to indicate that the entire message is sent, or
+**                     that the session was closed after being idle for
+**                     ABCC_CFG_SEG_IDLE_TIMEOUT_MS.
 **    pxObject       - User defined object. Forwarded as parameter in pnDone and
 **                     pnNext callback functions.
 **
@@ -405,6 +976,153 @@ EXTFUNC ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSession( const ABP_Ms
                                                                     ABCC_SegMsgHandlerDoneFuncType pnDone,
                                                                     const void* pxObject );
 
+/*------------------------------------------------------------------------------
+** Sends a segmented response message to the ABCC, see
+** ABCC_StartServerRespSegmentationSession(). The payload is scattered over an
+** array of fragments, which are copied to the segments in order without
+** assembling them in a separate buffer first. The fragment array and the data
+** must be kept until pnDone is called.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psReqMsgHeader - Pointer to request message header.
+**    bRspCmdExt0    - Value of command extension 0 to use in response segments.
+**    pasFragments   - Array of payload fragments.
+**    iNumFragments  - Number of entries in pasFragments.
+**    pnDone         - Callback to indicate that the entire message is sent.
+**    pxObject       - User defined object. Forwarded as parameter in pnDone.
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSessionFragments( const ABP_MsgHeaderType* psReqMsgHeader,
+                                                                             UINT8 bRspCmdExt0,
+                                                                             const ABCC_SegDataFragmentType* pasFragments,
+                                                                             UINT16 iNumFragments,
+                                                                             ABCC_SegMsgHandlerDoneFuncType pnDone,
+                                                                             const void* pxObject );
+
+/*------------------------------------------------------------------------------
+** Sends a segmented response message to the ABCC, see
+** ABCC_StartServerRespSegmentationSession(). For each segment pnRead is called
+** to read the next part of the payload directly into the message buffer, so
+** the application can copy from wherever the data is stored.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psReqMsgHeader - Pointer to request message header.
+**    bRspCmdExt0    - Value of command extension 0 to use in response segments.
+**    lSize          - Size of the entire payload.
+**    pnRead         - Callback to read a part of the payload.
+**    pnDone         - Callback to indicate that the entire message is sent.
+**    pxObject       - User defined object. Forwarded as parameter in pnRead
+**                     and pnDone.
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSessionRead( const ABP_MsgHeaderType* psReqMsgHeader,
+                                                                        UINT8 bRspCmdExt0,
+                                                                        UINT32 lSize,
+                                                                        ABCC_SegMsgHandlerReadFuncType pnRead,
+                                                                        ABCC_SegMsgHandlerDoneFuncType pnDone,
+                                                                        const void* pxObject );
+
+#if ABCC_CFG_SEG_CLIENT_ENABLED
+/*------------------------------------------------------------------------------
+** Function callback receiving the response data of a client segmentation
+** session, see ABCC_StartClientSegmentationSession().
+**------------------------------------------------------------------------------
+** Arguments:
+**    pxObject  - User defined object.
+**    pbData    - Data of one response segment.
+**    iSize     - Size of the segment.
+**    lOffset   - Offset of the segment in the entire response.
+**
+** Returns:
+**    TRUE to continue, FALSE to abort the session.
+**------------------------------------------------------------------------------
+*/
+typedef BOOL (*ABCC_SegClientRespDataFuncType)( void* pxObject,
+                                                const UINT8* pbData,
+                                                UINT16 iSize,
+                                                UINT32 lOffset );
+
+/*------------------------------------------------------------------------------
+** Function callback indicating that a client segmentation session is done,
+** see ABCC_StartClientSegmentationSession().
+**------------------------------------------------------------------------------
+** Arguments:
+**    pxObject  - User defined object.
+**    eResult   - ABCC_EC_NO_ERROR if the entire response has been received.
+**                ABCC_EC_RESP_MSG_E_BIT_SET if an error response was received.
+**                ABCC_EC_ERROR_RESP_SEGMENTATION if the session was aborted by
+**                the ABCC or because the response did not fit.
+**                Otherwise the error from sending a segment.
+**    psRespMsg - The last response, NULL if not available. The header and the
+**                error code of an error response can be read from it. The
+**                buffer is only valid during the callback.
+**    lRespSize - Total size of the response data received.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+typedef void (*ABCC_SegClientDoneFuncType)( void* pxObject,
+                                            ABCC_ErrorCodeType eResult,
+                                            const ABP_MsgType* psRespMsg,
+                                            UINT32 lRespSize );
+
+/*------------------------------------------------------------------------------
+** Sends a command to the ABCC as a sequence of segments and reassembles a
+** segmented response. The command payload is supplied the same way as for
+** ABCC_StartServerRespSegmentationSession(): in pxData, through the pnNext
+** callback, or both. A payload that fits in one message is sent as a normal
+** command.
+** Each segment is sent when the response to the previous one has arrived, as
+** required by the segmentation protocol, so a session has one command
+** outstanding at a time. If the command queue is full when the session is
+** started the first segment is sent from ABCC_RunDriver() when an entry is
+** released. Several sessions run in parallel within the command queue entries,
+** see ABCC_GetCmdQueueSize().
+** The response data is passed to pnRespData if supplied, otherwise it is
+** copied to pxRespBuffer. If both are NULL the response data is discarded.
+**------------------------------------------------------------------------------
+** Arguments:
+**    bObject         - Destination object.
+**    iInstance       - Instance.
+**    eCmd            - Command.
+**    bCmdExt0        - Command extension 0.
+**    pxData          - Pointer to first command payload block.
+**    lSize           - Size of first payload block.
+**    pnNext          - Callback to request the next command data block.
+**                      NULL if all data is supplied in pxData.
+**    pxRespBuffer    - Buffer for the response data, or NULL.
+**    lRespBufferSize - Size of pxRespBuffer.
+**    pnRespData      - Callback receiving the response data, or NULL.
+**    pnDone          - Callback to indicate that the session is done.
+**    pxObject        - User defined object. Forwarded as parameter in the
+**                      callback functions.
+**
+** Returns:
+**    ABCC_EC_NO_RESOURCES if all client sessions are in use, otherwise
+**    ABCC_EC_NO_ERROR. Later errors are reported through pnDone.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_StartClientSegmentationSession( UINT8 bObject,
+                                                                UINT16 iInstance,
+                                                                ABP_MsgCmdType eCmd,
+                                                                UINT8 bCmdExt0,
+                                                                const void* pxData,
+                                                                UINT32 lSize,
+                                                                ABCC_SegMsgHandlerNextBlockFuncType pnNext,
+                                                                void* pxRespBuffer,
+                                                                UINT32 lRespBufferSize,
+                                                                ABCC_SegClientRespDataFuncType pnRespData,
+                                                                ABCC_SegClientDoneFuncType pnDone,
+                                                                const void* pxObject );
+#endif
+
 /*------------------------------------------------------------------------------
 ** Sends a remap response to the ABCC. When the response is sent the new process
 ** data sizes will be set and the function ABCC_CbfRemapDone() will be called to
@@ -463,9 +1181,54 @@ EXTFUNC void ABCC_SetAppStatus( ABP_AppStatusType eAppStatus  );
 ** Returns:
 **    ABP_MsgType* - Pointer to the message buffer.
 **                   NULL is returned if no resource is available.
+**
+** If ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED is set this is a macro that
+** records the calling file and line in the buffer.
 **------------------------------------------------------------------------------
 */
+#if !ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED
 EXTFUNC ABP_MsgType* ABCC_GetCmdMsgBuffer( void );
+#endif
+
+/*------------------------------------------------------------------------------
+** Retrieves a message buffer with room for at least iDataSize octets of message
+** data. Same as ABCC_GetCmdMsgBuffer() but allows a buffer from a smaller size
+** class to be used, see ABCC_CFG_MEM_NUM_SMALL_MSG in abcc_config.h.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iDataSize      - Required size of the message data area in octets.
+**
+** Returns:
+**    ABP_MsgType* - Pointer to the message buffer.
+**                   NULL is returned if no resource is available.
+**------------------------------------------------------------------------------
+*/
+#if ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED
+EXTFUNC ABP_MsgType* ABCC_GetCmdMsgBufferTracked( UINT16 iDataSize,
+                                                  const char* pcFile,
+                                                  int xLine );
+#define ABCC_GetCmdMsgBuffer() \
+   ABCC_GetCmdMsgBufferTracked( ABCC_CFG_MAX_MSG_SIZE, ABCC_FILE_IDENTIFIER, __LINE__ )
+#define ABCC_GetCmdMsgBufferOfSize( iDataSize ) \
+   ABCC_GetCmdMsgBufferTracked( iDataSize, ABCC_FILE_IDENTIFIER, __LINE__ )
+#else
+EXTFUNC ABP_MsgType* ABCC_GetCmdMsgBufferOfSize( UINT16 iDataSize );
+#endif
+
+/*------------------------------------------------------------------------------
+** Returns the size of the message data area of a message buffer allocated by
+** the driver. Unless smaller size classes are configured (see
+** ABCC_CFG_MEM_NUM_SMALL_MSG in abcc_config.h) this is always
+** ABCC_CFG_MAX_MSG_SIZE.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psMsg          - Pointer to the message buffer.
+**
+** Returns:
+**    Size of the message data area in octets.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT16 ABCC_GetMsgBufferSize( ABP_MsgType* psMsg );
 
 /*------------------------------------------------------------------------------
 ** Returns the message buffer to the driver's message pool.
@@ -497,6 +1260,45 @@ EXTFUNC ABCC_ErrorCodeType ABCC_ReturnMsgBuffer( ABP_MsgType** ppsBuffer );
 */
 EXTFUNC void ABCC_TakeMsgBufferOwnership( ABP_MsgType* psMsg );
 
+/*------------------------------------------------------------------------------
+** Retrieves usage statistics of one size class of the message buffer pool.
+** Size classes are numbered from the smallest configured class, the last class
+** holds buffers of ABCC_CFG_MAX_MSG_SIZE. The high-water mark and failure
+** counter are reset when the driver is started.
+**
+** The buffer status breakdown is collected by walking the buffers of the class
+** and is not an atomic snapshot if buffers are allocated or freed from another
+** context during the call.
+**------------------------------------------------------------------------------
+** Arguments:
+**    bSizeClass     - Size class, 0 is the smallest configured class.
+**    psStats        - Pointer to the statistics to fill in.
+**
+** Returns:
+**    TRUE if the size class exists, FALSE otherwise.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_MemGetStats( UINT8 bSizeClass, ABCC_MemStatsType* psStats );
+
+#if ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED
+/*------------------------------------------------------------------------------
+** Lists all message buffers that have been held for at least lThresholdMs
+** together with their buffer status and the file and line that allocated them.
+** Each buffer is reported as an ABCC_EC_MSG_BUFFER_LEAK warning. Called by
+** ABCC_ShutdownDriver() with ABCC_CFG_DEBUG_MEM_LEAK_THRESHOLD_MS.
+** Only available if ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED is set.
+**------------------------------------------------------------------------------
+** Arguments:
+**    lThresholdMs   - Minimum time in ms a buffer must have been held to be
+**                     listed.
+**
+** Returns:
+**    Number of listed buffers.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT16 ABCC_MemDumpLeaks( UINT32 lThresholdMs );
+#endif
+
 /*------------------------------------------------------------------------------
 ** Reads the module ID.
 **------------------------------------------------------------------------------
@@ -770,6 +1572,7 @@ EXTFUNC void ABCC_CbfHandleCommandMessage( ABP_MsgType* psReceivedMsg );
 ** buffer before returning from the function.
 ** The data will only be sent to the ABCC if the return value is TRUE.
 ** Regarding callback context, see comment for callback section above.
+** Not called if ABCC_CFG_PD_TRIPLE_BUFFER_ENABLED is set.
 **------------------------------------------------------------------------------
 ** Arguments:
 **    pxWritePd - Pointer to the process data to be sent.
@@ -787,6 +1590,7 @@ EXTFUNC BOOL ABCC_CbfUpdateWriteProcessData( void* pxWritePd );
 ** be copied to the application ADI:s before returning from the function. Note
 ** that the data may not be changed since last time.
 ** Regarding callback context, see comment for callback section above.
+** Not called if ABCC_CFG_PD_TRIPLE_BUFFER_ENABLED is set.
 **------------------------------------------------------------------------------
 ** Arguments:
 **    pxReadPd - Pointer to the received process data.
@@ -955,6 +1759,27 @@ EXTFUNC void ABCC_TriggerReceiveMessage( void );
 */
 EXTFUNC void (*ABCC_TriggerWrPdUpdate)( void );
 
+#if ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED
+/*------------------------------------------------------------------------------
+** Marks a byte range of the write process data as modified. On the parallel
+** interface only the marked ranges are written to the ABCC on the next write
+** process data update. If nothing has been marked the whole write process data
+** is written. Has no effect on the other operating modes. Only available if
+** ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED is set, see abcc_config.h.
+** Must be called from the same context as ABCC_CbfUpdateWriteProcessData(),
+** typically from within the callback.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iOffset      - Offset of the first modified byte.
+**    iSize        - Number of modified bytes.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_MarkWrPdDirty( UINT16 iOffset, UINT16 iSize );
+#endif
+
 /*------------------------------------------------------------------------------
 ** Check if current anybus status has changed.
 ** If the status is changed ABCC_CbfAnbStateChanged() will be invoked.
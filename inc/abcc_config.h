@@ -152,6 +152,27 @@
     #error "At least one of the low-level drivers must be enabled."
 #endif
 
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_DRV_STATIC_BINDING_ENABLED   1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** If 1 the pnABCC_Drv* driver functions are bound to the enabled low-level
+** driver at compile time and called directly, instead of through function
+** pointers assigned by ABCC_StartDriver(). This allows the compiler to inline
+** the driver calls. Exactly one of the low-level drivers must be enabled.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_DRV_STATIC_BINDING_ENABLED
+    #define ABCC_CFG_DRV_STATIC_BINDING_ENABLED 0
+#endif
+
+#if ABCC_CFG_DRV_STATIC_BINDING_ENABLED
+    #if ( ABCC_CFG_DRV_SPI_ENABLED + ABCC_CFG_DRV_PARALLEL_ENABLED + ABCC_CFG_DRV_SERIAL_ENABLED ) != 1
+        #error "ABCC_CFG_DRV_STATIC_BINDING_ENABLED requires exactly one low-level driver to be enabled."
+    #endif
+#endif
+
 /*------------------------------------------------------------------------------
 ** #define ABCC_CFG_OP_MODE_GETTABLE         1 - Enable / 0 - Disable
 **
@@ -277,6 +298,37 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #endif
 #endif
 
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED  1 - Enable / 0 - Disable
+** #define ABCC_CFG_PAR_WRPD_NUM_DIRTY_RANGES       ( 4 )
+**
+** Default values below can be overridden in abcc_driver_config.h
+**
+** Enables ABCC_MarkWrPdDirty(). If ranges of the write process data have been
+** marked the parallel driver writes only those to the ABCC on the next write
+** process data update, otherwise the whole write process data is written.
+** Set to 1 only if the ABCC keeps the write process data image of the previous
+** update in its write process data area, since the unmarked bytes are not
+** rewritten. The default 0 always writes the whole write process data.
+** Has no effect if ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED is set.
+**
+** ABCC_CFG_PAR_WRPD_NUM_DIRTY_RANGES is the number of ranges tracked. Ranges
+** that overlap or touch are merged and if more ranges are marked the two
+** closest ranges are merged.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED
+    #define ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED 0
+#endif
+
+#ifndef ABCC_CFG_PAR_WRPD_NUM_DIRTY_RANGES
+    #define ABCC_CFG_PAR_WRPD_NUM_DIRTY_RANGES ( 4 )
+#endif
+
+#if ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED && ( ABCC_CFG_PAR_WRPD_NUM_DIRTY_RANGES < 1 )
+    #error "ABCC_CFG_PAR_WRPD_NUM_DIRTY_RANGES must be at least 1 if ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED is enabled."
+#endif
+
 /*------------------------------------------------------------------------------
 ** #define ABCC_CFG_SERIAL_TMO_19_2                      ( 350 )
 ** #define ABCC_CFG_SERIAL_TMO_57_6                      ( 120 )
@@ -352,26 +404,230 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
 ** Default value below can be overridden in abcc_driver_config.h
 **
 ** Number of commands that could be sent without receiving a response.
-** At least 2 buffers are required by the driver.
+** At least 2 buffers are required by the driver. At most 255, since every
+** outstanding command holds one of the 256 8-bit source ids and
+** ABCC_GetNewSourceId() must always find a free one.
 **------------------------------------------------------------------------------
 */
 #ifndef ABCC_CFG_MAX_NUM_APPL_CMDS
     #define ABCC_CFG_MAX_NUM_APPL_CMDS ( 2 )
 #endif
 
+#if ABCC_CFG_MAX_NUM_APPL_CMDS > 255
+    #error "ABCC_CFG_MAX_NUM_APPL_CMDS must not exceed 255."
+#endif
+
 /*------------------------------------------------------------------------------
 ** #define ABCC_CFG_MAX_NUM_ABCC_CMDS     ( 2 )
 **
 ** Default value below can be overridden in abcc_driver_config.h
 **
 ** Number of commands that could be received without sending a response.
-** At least 2 buffers are required by the driver.
+** At least 2 buffers are required by the driver. At most 32768.
 **------------------------------------------------------------------------------
 */
 #ifndef ABCC_CFG_MAX_NUM_ABCC_CMDS
     #define ABCC_CFG_MAX_NUM_ABCC_CMDS ( 2 )
 #endif
 
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED   1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** If 1 ABCC_SendCmdMsgWithTimeout() is available. If no response is received
+** within the given time the response handler is called with a timeout
+** response (ABCC_IsRespTimeout()). A command that is still queued when it times
+** out is never sent and its command resource is released. Uses one extra timer
+** of the driver timer system.
+**
+** #define ABCC_CFG_CMD_RESP_TIMEOUT_GRACE_MS  ( 1000 )
+**
+** A command that times out after it has been sent keeps its command resource
+** and source id for this many milliseconds more, in case the response is only
+** late. If no response has arrived by then they are released, and a response
+** that arrives later is discarded.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+    #define ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED 0
+#endif
+
+#ifndef ABCC_CFG_CMD_RESP_TIMEOUT_GRACE_MS
+    #define ABCC_CFG_CMD_RESP_TIMEOUT_GRACE_MS ( 1000 )
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_CMD_ASYNC_ENABLED          1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** If 1 ABCC_SendCmdAsync() is available. Instead of calling a response handler
+** the driver stores the response, and the application fetches it through a
+** command handle with ABCC_CmdPoll(), ABCC_CmdWait() and ABCC_CmdTake(), or
+** cancels it with ABCC_CmdCancel().
+**
+** #define ABCC_CFG_CMD_ASYNC_NUM_HANDLES      ( ABCC_CFG_MAX_NUM_APPL_CMDS )
+**
+** Number of commands sent with ABCC_SendCmdAsync() whose responses have not
+** yet been taken by the application, including cancelled commands whose
+** responses have not yet arrived.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_CMD_ASYNC_ENABLED
+    #define ABCC_CFG_CMD_ASYNC_ENABLED 0
+#endif
+
+#ifndef ABCC_CFG_CMD_ASYNC_NUM_HANDLES
+    #define ABCC_CFG_CMD_ASYNC_NUM_HANDLES ( ABCC_CFG_MAX_NUM_APPL_CMDS )
+#endif
+
+#if ABCC_CFG_CMD_ASYNC_ENABLED && ( ABCC_CFG_CMD_ASYNC_NUM_HANDLES > 0xFF )
+   #error "ABCC_CFG_CMD_ASYNC_NUM_HANDLES must not exceed 255"
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_MAX_NUM_TIMERS             ( 3 + ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Number of timers of the driver timer system. The driver uses up to three
+** timers (startup timeout, watchdog and serial telegram timeout) plus one for
+** the response timeouts if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED is set. Increase
+** it if more timers are needed, at most 65534. The cost of a timer tick does
+** not depend on the number of timers.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_MAX_NUM_TIMERS
+    #define ABCC_CFG_MAX_NUM_TIMERS ( 3 + ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED )
+#endif
+
+#if ABCC_CFG_MAX_NUM_TIMERS > 0xFFFE
+   #error "ABCC_CFG_MAX_NUM_TIMERS must not exceed 65534"
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_NUM_CMD_PRIO               ( 1 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Number of priority classes for queued command messages. Commands sent with
+** ABCC_SendCmdMsgWithPriority() are queued per priority class and the command
+** with the highest priority is sent first. Commands of the same priority are
+** sent in order. Commands sent with ABCC_SendCmdMsg() get priority 0, the
+** lowest priority. Response messages are always sent before any command.
+** All priority classes share one command queue of ABCC_CFG_MAX_NUM_APPL_CMDS
+** entries, so more classes do not take more memory for queued commands.
+**
+** #define ABCC_CFG_CMD_QUEUE_STATS_ENABLED     1 - Enable / 0 - Disable
+**
+** If 1 the time each command spends in the command queue is measured per
+** priority class, see ABCC_GetCmdQueueStats().
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_NUM_CMD_PRIO
+    #define ABCC_CFG_NUM_CMD_PRIO ( 1 )
+#endif
+#ifndef ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+    #define ABCC_CFG_CMD_QUEUE_STATS_ENABLED 0
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_LATENCY_STATS_ENABLED       1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** If 1 each command is timestamped when it is queued, when it is handed to the
+** operating mode driver, when the transmission is completed and when the
+** response is routed to the response handler. The latencies are collected in
+** log2 histograms per destination object, see ABCC_GetLatencyStats().
+**
+** #define ABCC_CFG_LATENCY_STATS_NUM_OBJECTS   ( 8 )
+**
+** Number of destination objects that latency histograms can be kept for. The
+** objects are assigned in the order the first response from each one is
+** received.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_LATENCY_STATS_ENABLED
+    #define ABCC_CFG_LATENCY_STATS_ENABLED 0
+#endif
+#ifndef ABCC_CFG_LATENCY_STATS_NUM_OBJECTS
+    #define ABCC_CFG_LATENCY_STATS_NUM_OBJECTS ( 8 )
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_NUM_SEGMENTATION_SESSIONS   ( 1 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Number of server response segmentation sessions that can be active at the
+** same time, see ABCC_StartServerRespSegmentationSession(). The legacy
+** ABCC_NUM_SEGMENTATION_SESSIONS define is used as default if it is defined.
+**
+** #define ABCC_CFG_SEG_HASH_SIZE               ( 8 )
+**
+** Number of buckets in the hash table used to match received segment commands
+** with active sessions. Must be a power of two. Should be at least
+** ABCC_CFG_NUM_SEGMENTATION_SESSIONS to keep the chains short.
+**
+** #define ABCC_CFG_SEG_IDLE_TIMEOUT_MS         ( 0 )
+**
+** A session that has not received a segment command for this long is closed
+** and its done callback is called, so sessions aborted by the peer are not
+** kept forever. Idle sessions are closed when a new session is started. The
+** time is measured with the driver uptime, see ABCC_RunTimerSystem(). 0
+** disables the timeout.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_NUM_SEGMENTATION_SESSIONS
+    #ifdef ABCC_NUM_SEGMENTATION_SESSIONS
+        #define ABCC_CFG_NUM_SEGMENTATION_SESSIONS ABCC_NUM_SEGMENTATION_SESSIONS
+    #else
+        #define ABCC_CFG_NUM_SEGMENTATION_SESSIONS ( 1 )
+    #endif
+#endif
+#ifndef ABCC_CFG_SEG_HASH_SIZE
+    #define ABCC_CFG_SEG_HASH_SIZE ( 8 )
+#endif
+#ifndef ABCC_CFG_SEG_IDLE_TIMEOUT_MS
+    #define ABCC_CFG_SEG_IDLE_TIMEOUT_MS ( 0 )
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_SEG_CLIENT_ENABLED          1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** If 1 the application can send commands with payloads larger than one
+** message and receive segmented responses, see
+** ABCC_StartClientSegmentationSession().
+**
+** #define ABCC_CFG_SEG_CLIENT_NUM_SESSIONS     ( 2 )
+**
+** Number of client segmentation sessions that can be active at the same time.
+** Each active session has one command outstanding.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_SEG_CLIENT_ENABLED
+    #define ABCC_CFG_SEG_CLIENT_ENABLED 0
+#endif
+#ifndef ABCC_CFG_SEG_CLIENT_NUM_SESSIONS
+    #define ABCC_CFG_SEG_CLIENT_NUM_SESSIONS ( 2 )
+#endif
+
+#if ABCC_CFG_SEG_CLIENT_ENABLED && ( ( ABCC_CFG_SEG_CLIENT_NUM_SESSIONS < 1 ) || ( ABCC_CFG_SEG_CLIENT_NUM_SESSIONS > 255 ) )
+   #error "ABCC_CFG_SEG_CLIENT_NUM_SESSIONS must be 1 - 255"
+#endif
+
+#if ( ABCC_CFG_NUM_SEGMENTATION_SESSIONS < 1 ) || ( ABCC_CFG_NUM_SEGMENTATION_SESSIONS > 255 )
+   #error "ABCC_CFG_NUM_SEGMENTATION_SESSIONS must be 1 - 255"
+#endif
+
+#if ( ABCC_CFG_SEG_HASH_SIZE < 1 ) || ( ABCC_CFG_SEG_HASH_SIZE > 256 ) || ( ( ABCC_CFG_SEG_HASH_SIZE & ( ABCC_CFG_SEG_HASH_SIZE - 1 ) ) != 0 )
+   #error "ABCC_CFG_SEG_HASH_SIZE must be a power of two, at most 256"
+#endif
+
 /*------------------------------------------------------------------------------
 ** #define ABCC_CFG_MAX_MSG_SIZE                       ( 1524 )
 **
@@ -400,6 +656,151 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #define ABCC_CFG_MAX_PROCESS_DATA_SIZE ( 512 )
 #endif
 
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_PD_TRIPLE_BUFFER_ENABLED   1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** If 1 the driver exchanges process data with the application through triple
+** buffers instead of calling ABCC_CbfNewReadPd() and
+** ABCC_CbfUpdateWriteProcessData(). Application threads can then fetch the
+** latest read process data with ABCC_PdGetLatestReadPd() and publish write
+** process data with ABCC_PdPublishWritePd() at their own cycle rate, without
+** locks and without blocking the driver.
+**
+** Requires a C11 compiler with <stdatomic.h>. Uses 6 buffers of
+** ABCC_CFG_MAX_PROCESS_DATA_SIZE bytes.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_PD_TRIPLE_BUFFER_ENABLED
+    #define ABCC_CFG_PD_TRIPLE_BUFFER_ENABLED 0
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED    1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** If 1 the SPI and serial operating modes can be run from two threads.
+** ABCC_RunDriverTx() transfers frames to and from the ABCC and
+** ABCC_RunDriverRx() dispatches the received messages, process data and
+** Anybus state changes to the application. The two are decoupled by a
+** lock-free queue of ABCC_CFG_DRV_SPLIT_TX_RX_QUEUE_SIZE entries, so the
+** application callbacks overlap with the bus transfers. ABCC_RunDriver()
+** still runs both back to back.
+**
+** Requires a C11 compiler with <stdatomic.h>. Not supported by the parallel
+** operating modes.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED
+    #define ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED 0
+#endif
+
+#if ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED && ABCC_CFG_DRV_PARALLEL_ENABLED
+   #error "ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED is not supported by the parallel operating modes"
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_DRV_SPLIT_TX_RX_QUEUE_SIZE     ( 4 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Number of received frames that ABCC_RunDriverTx() can get ahead of
+** ABCC_RunDriverRx(). Each entry holds a copy of the read process data. When
+** the queue is full ABCC_RunDriverTx() does not start new transfers. Must be a
+** power of two.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_DRV_SPLIT_TX_RX_QUEUE_SIZE
+    #define ABCC_CFG_DRV_SPLIT_TX_RX_QUEUE_SIZE ( 4 )
+#endif
+
+#if ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED && \
+    ( ( ABCC_CFG_DRV_SPLIT_TX_RX_QUEUE_SIZE == 0 ) || \
+      ( ABCC_CFG_DRV_SPLIT_TX_RX_QUEUE_SIZE & ( ABCC_CFG_DRV_SPLIT_TX_RX_QUEUE_SIZE - 1 ) ) )
+   #error "ABCC_CFG_DRV_SPLIT_TX_RX_QUEUE_SIZE must be a power of two"
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_MAX_NUM_MSG_RESOURCES     ( ABCC_CFG_MAX_NUM_APPL_CMDS + ABCC_CFG_MAX_NUM_ABCC_CMDS )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Number of message buffers of ABCC_CFG_MAX_MSG_SIZE in the message buffer
+** pool. ABCC_MemGetStats() reports the high-water mark and the number of failed
+** allocations of each size class, which can be used to size the pool.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_MAX_NUM_MSG_RESOURCES
+    #define ABCC_CFG_MAX_NUM_MSG_RESOURCES ( ABCC_CFG_MAX_NUM_APPL_CMDS + ABCC_CFG_MAX_NUM_ABCC_CMDS )
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_MEM_NUM_SMALL_MSG         ( 0 )
+** #define ABCC_CFG_MEM_SMALL_MSG_SIZE        ( 32 )
+** #define ABCC_CFG_MEM_NUM_MEDIUM_MSG        ( 0 )
+** #define ABCC_CFG_MEM_MEDIUM_MSG_SIZE       ( 128 )
+**
+** Default values below can be overridden in abcc_driver_config.h
+**
+** Optional smaller size classes in the message buffer pool. Each class holds
+** ABCC_CFG_MEM_NUM_X_MSG buffers with a message data area of
+** ABCC_CFG_MEM_X_MSG_SIZE octets. A class is disabled when its number of
+** buffers is 0. The sizes must be less than ABCC_CFG_MAX_MSG_SIZE and the small
+** size must be less than the medium size.
+**
+** Since most messages are small the RAM used by the pool can be reduced by
+** lowering ABCC_CFG_MAX_NUM_MSG_RESOURCES and adding small buffers instead.
+** A buffer is taken from the smallest class that fits and falls back to a
+** larger class when that class is empty:
+**
+** - ABCC_GetCmdMsgBuffer() always returns a buffer of ABCC_CFG_MAX_MSG_SIZE.
+**   ABCC_GetCmdMsgBufferOfSize() can be used for smaller commands.
+** - Received responses get a buffer fitting the received data size.
+** - Received commands always get a buffer of ABCC_CFG_MAX_MSG_SIZE since the
+**   response is built in the same buffer. At least ABCC_CFG_MAX_NUM_ABCC_CMDS
+**   buffers of that size are therefore required.
+**
+** NOTE: An application that reuses a received response buffer for a new
+**       command must check that the command fits, see
+**       ABCC_GetMsgBufferSize().
+** NOTE: ABCC_CFG_SPI_MSG_FRAG_LEN must be at least the 12 octet message header
+**       when size classes are used in SPI operating mode.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_MEM_NUM_SMALL_MSG
+    #define ABCC_CFG_MEM_NUM_SMALL_MSG ( 0 )
+#endif
+#ifndef ABCC_CFG_MEM_SMALL_MSG_SIZE
+    #define ABCC_CFG_MEM_SMALL_MSG_SIZE ( 32 )
+#endif
+#ifndef ABCC_CFG_MEM_NUM_MEDIUM_MSG
+    #define ABCC_CFG_MEM_NUM_MEDIUM_MSG ( 0 )
+#endif
+#ifndef ABCC_CFG_MEM_MEDIUM_MSG_SIZE
+    #define ABCC_CFG_MEM_MEDIUM_MSG_SIZE ( 128 )
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED   1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** If 1 the message buffer pool (ABCC_MemAlloc()/ABCC_MemFree()) is
+** implemented as a lock-free free list using C11 atomics instead of being
+** protected by ABCC_PORT_EnterCritical()/ABCC_PORT_ExitCritical(). Buffers can
+** then be allocated and returned from interrupt and application context
+** without disabling interrupts or blocking each other.
+**
+** Requires a C11 compiler with <stdatomic.h> and a target supporting lock-free
+** 32 bit compare-and-swap.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+    #define ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED 0
+#endif
+
 /*------------------------------------------------------------------------------
 ** #define ABCC_CFG_SYNC_ENABLED   1 - Enable / 0 - Disable
 **
@@ -520,6 +921,73 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #define ABCC_CFG_HANDLE_INT_IN_ISR_MASK ( 0 )
 #endif
 
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_INT_COALESCE_MASK                  ( 0 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Defines what interrupt events from the ABCC that are deferred from the ISR
+** to the next ABCC_RunDriver() call, where all events that occurred in between
+** are handled once. The mask is composed of ABP_INTSTATUS_STATUSI,
+** ABP_INTSTATUS_WRMSGI and ABP_INTSTATUS_ANBRI. Deferred events are neither
+** handled in the ISR nor forwarded to ABCC_CbfEvent(), unless
+** ABCC_RunDriver() has not been called within
+** ABCC_CFG_INT_COALESCE_WINDOW_MS when the next interrupt occurs.
+** Parallel 16/8 only.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_INT_COALESCE_MASK
+    #define ABCC_CFG_INT_COALESCE_MASK ( 0 )
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_INT_COALESCE_WINDOW_MS             ( 10 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Time after which events deferred according to ABCC_CFG_INT_COALESCE_MASK
+** are handled in the ISR instead. The window is only checked when the next
+** interrupt occurs, so it does not bound the latency by itself: without further
+** interrupts the events wait for the next ABCC_RunDriver() call.
+** ABCC_RunDriverEx() reports a deadline within this window while events are
+** deferred, call it again by then to keep the latency within the window.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_INT_COALESCE_WINDOW_MS
+    #define ABCC_CFG_INT_COALESCE_WINDOW_MS ( 10 )
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_ISR_STATS_ENABLED   1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** If 1 the parallel ISR counts its invocations, interrupt status reads and
+** events per type, see ABCC_GetIsrStats(). The longest ISR duration is also
+** recorded if the port defines ABCC_PORT_GetTimestamp().
+** Parallel 16/8 only.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_ISR_STATS_ENABLED
+    #define ABCC_CFG_ISR_STATS_ENABLED 0
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED   1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** If 1 the HAL provides a free-running nanosecond counter,
+** ABCC_HAL_GetTimestampNs(). The command latency statistics are then measured
+** in us instead of ms, the default ABCC_PORT_GetTimestamp() reads the counter
+** and the timer system can be driven by ABCC_RunTimerSystemFromHal() instead
+** of ABCC_RunTimerSystem(). The timers themselves keep ms resolution.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED
+    #define ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED 0
+#endif
+
 /*------------------------------------------------------------------------------
 ** #define ABCC_CFG_WD_TIMEOUT_MS                      ( 1000 )
 **
@@ -534,6 +1002,22 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #define ABCC_CFG_WD_TIMEOUT_MS ( 1000 )
 #endif
 
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_RUN_DRIVER_POLL_INTERVAL_MS        ( 10 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Longest time ABCC_RunDriverEx() tells the application to wait before the
+** next call when the operating mode has to be polled. This applies to the SPI
+** and serial operating modes, and to the parallel operating modes if not all
+** ABCC events are notified by the ABCC interrupt. Must be well below
+** ABCC_CFG_WD_TIMEOUT_MS.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_RUN_DRIVER_POLL_INTERVAL_MS
+    #define ABCC_CFG_RUN_DRIVER_POLL_INTERVAL_MS ( 10 )
+#endif
+
 /*------------------------------------------------------------------------------
 ** #define ABCC_CFG_REMAP_SUPPORT_ENABLED   1 - Enable / 0 - Disable
 **
@@ -720,6 +1204,30 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #define ABCC_CFG_DEBUG_CMD_SEQ_ENABLED 0
 #endif
 
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED    1 - Enable / 0 - Disable
+** #define ABCC_CFG_DEBUG_MEM_LEAK_THRESHOLD_MS        ( 10000 )
+**
+** Default values below can be overridden in abcc_driver_config.h
+**
+** Enable/disable tracking of message buffer leaks. If enabled each message
+** buffer records the file, line and uptime of the call that allocated it.
+** ABCC_MemDumpLeaks() lists all buffers that have been held for longer than a
+** given time, and ABCC_ShutdownDriver() calls it with
+** ABCC_CFG_DEBUG_MEM_LEAK_THRESHOLD_MS. The list is printed as warnings, so
+** ABCC_CFG_LOG_SEVERITY must be at least ABCC_LOG_SEVERITY_WARNING_ENABLED.
+**
+** Enabling this turns ABCC_GetCmdMsgBuffer() and ABCC_GetCmdMsgBufferOfSize()
+** into macros to capture the call site, and adds some RAM to each buffer.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED
+    #define ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED 0
+#endif
+#ifndef ABCC_CFG_DEBUG_MEM_LEAK_THRESHOLD_MS
+    #define ABCC_CFG_DEBUG_MEM_LEAK_THRESHOLD_MS ( 10000 )
+#endif
+
 /*------------------------------------------------------------------------------
 ** #define ABCC_CFG_MESSAGE_SIZE_CHECK_ENABLED        1 - Enable / 0 - Disable
 **
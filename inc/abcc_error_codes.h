@@ -56,6 +56,8 @@ typedef enum ABCC_ErrorCodeType
    ABCC_EC_UNKNOWN_ENDIAN = 42,
    ABCC_EC_ASSERT_FAILED = 43,
    ABCC_EC_PD_SIZE_MISMATCH = 44,
+   ABCC_EC_MSG_BUFFER_LEAK = 45,
+   ABCC_EC_RESP_TIMEOUT = 46,
    ABCC_EC_SET_ENUM_ANSI_SIZE       = 0x7FFF
 }
 ABCC_ErrorCodeType;
@@ -253,6 +253,23 @@ EXTFUNC void ABCC_HAL_GpioReset( void );
 EXTFUNC void ABCC_HAL_GpioSet( void );
 #endif
 
+/*------------------------------------------------------------------------------
+** Reads a free-running, monotonic nanosecond counter, e.g. a hardware timer
+** or a scaled CPU cycle counter. The counter must not be adjusted while the
+** driver is running. It may be called from any driver context, including the
+** ABCC interrupt. Only required if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED is set.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    Counter value in ns.
+**------------------------------------------------------------------------------
+*/
+#if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED
+EXTFUNC UINT64 ABCC_HAL_GetTimestampNs( void );
+#endif
+
 /*------------------------------------------------------------------------------
 ** This function is called by the driver at the beginning ABCC_StartDriver().
 ** If there is any hardware specific tasks required to be done every time the
@@ -55,6 +55,45 @@ typedef void (*ABCC_SegMsgHandlerDoneFuncType)( void* pxObject );
 */
 typedef UINT8* (*ABCC_SegMsgHandlerNextBlockFuncType)( void* pxObject, UINT32* plSize );
 
+/*------------------------------------------------------------------------------
+** One fragment of a payload scattered over several buffers.
+**
+** See ABCC_StartServerRespSegmentationSessionFragments
+**------------------------------------------------------------------------------
+**       pxData   - Start of the fragment.
+**       lSize    - Size of the fragment. Empty fragments are skipped.
+**------------------------------------------------------------------------------
+*/
+typedef struct ABCC_SegDataFragment
+{
+   const void* pxData;
+   UINT32 lSize;
+}
+ABCC_SegDataFragmentType;
+
+/*------------------------------------------------------------------------------
+** Function callback to read a part of the data to be sent by the segmentation
+** handler directly into the message buffer. The parts are read in order and
+** are at most one segment each.
+**
+** See ABCC_StartServerRespSegmentationSessionRead
+**------------------------------------------------------------------------------
+** Arguments:
+**       pxObject - User defined (Supplied in
+**                  ABCC_StartServerRespSegmentationSessionRead)
+**       lOffset  - Offset of the part in the entire payload.
+**       pxDest   - Destination of the data.
+**       iSize    - Number of bytes to read.
+**
+** Returns:
+**       Number of bytes read. Less than iSize ends the payload.
+**------------------------------------------------------------------------------
+*/
+typedef UINT16 (*ABCC_SegMsgHandlerReadFuncType)( void* pxObject,
+                                                  UINT32 lOffset,
+                                                  void* pxDest,
+                                                  UINT16 iSize );
+
 /*------------------------------------------------------------------------------
 ** Macros for basic endian swap. Used by conversion macros below.
 **------------------------------------------------------------------------------
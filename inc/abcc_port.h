@@ -226,6 +226,92 @@
 #define ABCC_PORT_TIMER_ExitCritical() ABCC_PORT_ExitCritical()
 #endif
 
+/*------------------------------------------------------------------------------
+** Lock domains.
+**
+** By default all driver resources are protected by the critical section above.
+** On a host where the critical section is a mutex this serializes all
+** application threads against each other and against the driver. The driver
+** therefore protects its resources with separate lock domains, each mapped to
+** ABCC_PORT_UseCritical()/EnterCritical()/ExitCritical() unless overridden in
+** abcc_software_port.h:
+**
+** ABCC_PORT_CMDSEQ_xxx()       Command sequencer table and states.
+** ABCC_PORT_LINK_xxx()         Message TX queues, the outstanding command
+**                              count and the command statistics.
+** ABCC_PORT_MSG_HANDLER_xxx()  Response handler table, source id allocation
+**                              and the response timeouts.
+** ABCC_PORT_MEM_xxx()          Message buffer pool.
+** ABCC_PORT_xxx()              Operating mode drivers, segmentation sessions
+**                              and interrupt event bookkeeping.
+** ABCC_PORT_TIMER_xxx()        Timer table, see above.
+**
+** Each domain may be mapped to a separate mutex. A domain lock must be
+** recursive if it is mapped to the same lock as another domain it may be
+** nested with. Locks are nested only in this order, a lock never being taken
+** while a lock further down the list is held:
+**
+**    CMDSEQ -> LINK -> MSG_HANDLER -> MEM -> ABCC_PORT -> TIMER
+**
+** CMDSEQ is held while a command sequence is aborted and its done callback is
+** called. LINK is held while the operating mode driver is handed a message.
+** TIMER is held while timeout callbacks run, e.g. ABCC_CbfWdTimeout(), which
+** must therefore not call the driver. All other critical sections take a
+** single lock.
+**
+** Each domain has the same three macros as the critical section above:
+** ABCC_PORT_<domain>_UseCritical() holds the declarations needed by the other
+** two, ABCC_PORT_<domain>_EnterCritical() takes the domain lock and
+** ABCC_PORT_<domain>_ExitCritical() releases it. Define all three in
+** abcc_software_port.h to override a domain. test/port/abcc_software_port.h
+** shows a POSIX mapping with one pthread mutex per domain.
+**------------------------------------------------------------------------------
+*/
+
+/* Command sequencer lock domain. */
+#ifndef ABCC_PORT_CMDSEQ_UseCritical
+#define ABCC_PORT_CMDSEQ_UseCritical() ABCC_PORT_UseCritical()
+#endif
+#ifndef ABCC_PORT_CMDSEQ_EnterCritical
+#define ABCC_PORT_CMDSEQ_EnterCritical() ABCC_PORT_EnterCritical()
+#endif
+#ifndef ABCC_PORT_CMDSEQ_ExitCritical
+#define ABCC_PORT_CMDSEQ_ExitCritical() ABCC_PORT_ExitCritical()
+#endif
+
+/* Message queue lock domain. */
+#ifndef ABCC_PORT_LINK_UseCritical
+#define ABCC_PORT_LINK_UseCritical() ABCC_PORT_UseCritical()
+#endif
+#ifndef ABCC_PORT_LINK_EnterCritical
+#define ABCC_PORT_LINK_EnterCritical() ABCC_PORT_EnterCritical()
+#endif
+#ifndef ABCC_PORT_LINK_ExitCritical
+#define ABCC_PORT_LINK_ExitCritical() ABCC_PORT_ExitCritical()
+#endif
+
+/* Response handler lock domain. */
+#ifndef ABCC_PORT_MSG_HANDLER_UseCritical
+#define ABCC_PORT_MSG_HANDLER_UseCritical() ABCC_PORT_UseCritical()
+#endif
+#ifndef ABCC_PORT_MSG_HANDLER_EnterCritical
+#define ABCC_PORT_MSG_HANDLER_EnterCritical() ABCC_PORT_EnterCritical()
+#endif
+#ifndef ABCC_PORT_MSG_HANDLER_ExitCritical
+#define ABCC_PORT_MSG_HANDLER_ExitCritical() ABCC_PORT_ExitCritical()
+#endif
+
+/* Message buffer pool lock domain. */
+#ifndef ABCC_PORT_MEM_UseCritical
+#define ABCC_PORT_MEM_UseCritical() ABCC_PORT_UseCritical()
+#endif
+#ifndef ABCC_PORT_MEM_EnterCritical
+#define ABCC_PORT_MEM_EnterCritical() ABCC_PORT_EnterCritical()
+#endif
+#ifndef ABCC_PORT_MEM_ExitCritical
+#define ABCC_PORT_MEM_ExitCritical() ABCC_PORT_ExitCritical()
+#endif
+
 /*------------------------------------------------------------------------------
 ** Copy a number of octets, from the source pointer to the destination pointer.
 **
@@ -500,4 +586,43 @@ void ABCC_CopyOctetsImpl( void* pxDest, UINT16 iDestOctetOffset,
 #define ABCC_PORT_Uint8CpyToPacked( pxDest, iDestOctetOffset, pxSrc, iNbrOfOctets ) \
         ABCC_PORT_StrCpyToPacked( pxDest, iDestOctetOffset, pxSrc, iNbrOfOctets )
 
+/*------------------------------------------------------------------------------
+** Read a free-running timestamp counter, e.g. a CPU cycle counter.
+**
+** Define ABCC_PORT_GetTimestamp in abcc_software_port.h to let the driver
+** measure the ISR duration when ABCC_CFG_ISR_STATS_ENABLED is set. The unit is
+** port specific. If ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED is set the default reads
+** ABCC_HAL_GetTimestampNs(), otherwise there is no default implementation.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    UINT32 timestamp, wrapping around.
+**------------------------------------------------------------------------------
+*/
+#if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED && !defined( ABCC_PORT_GetTimestamp )
+   #define ABCC_PORT_GetTimestamp()   ( (UINT32)ABCC_HAL_GetTimestampNs() )
+#endif
+
+/*------------------------------------------------------------------------------
+** Called by ABCC_CmdWait() while waiting for a response, see
+** ABCC_CFG_CMD_ASYNC_ENABLED.
+**
+** Define ABCC_PORT_CmdWaitYield in abcc_software_port.h if the driver is run
+** from another thread than the one waiting, e.g. to sleep or yield to the
+** scheduler. The default implementation runs the driver, which suits an
+** application that waits in the context that calls ABCC_RunDriver().
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_PORT_CmdWaitYield
+#define ABCC_PORT_CmdWaitYield() (void)ABCC_RunDriver()
+#endif
+
 #endif  /* inclusion lock */
@@ -0,0 +1,333 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Command handles for ABCC_SendCmdAsync().
+**
+** Each handle refers to an entry in a fixed table. The response handler of the
+** command stores the response in the entry, where the application picks it up
+** through the handle. A handle holds the entry index and a generation count
+** that is stepped each time the entry is released, so a handle that has
+** already been taken is not mistaken for a later command using the same entry.
+** A cancelled command keeps its entry, and with it its source id, until the
+** response arrives and is discarded.
+********************************************************************************
+*/
+
+#include "abcc_config.h"
+
+#if ABCC_CFG_CMD_ASYNC_ENABLED
+
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc.h"
+#include "abcc_port.h"
+#include "abcc_log.h"
+#include "abcc_timer.h"
+#include "abcc_cmd_async.h"
+
+/*
+** Command entry states.
+*/
+#define CMD_ASYNC_FREE         ( 0 )
+#define CMD_ASYNC_PENDING      ( 1 )
+#define CMD_ASYNC_DONE         ( 2 )
+#define CMD_ASYNC_CANCELLED    ( 3 )
+
+#define CMD_ASYNC_HANDLE( bIndex, bGeneration ) \
+        ( (ABCC_CmdHandleType)( ( (UINT16)( bGeneration ) << 8 ) | ( bIndex ) ) )
+#define CMD_ASYNC_INDEX( xHandle )              ( (UINT8)( ( xHandle ) & 0xFF ) )
+#define CMD_ASYNC_GENERATION( xHandle )         ( (UINT8)( ( xHandle ) >> 8 ) )
+
+/*------------------------------------------------------------------------------
+** Command entry.
+**
+** psResp:         Response message, owned by the entry until taken.
+** bState:         CMD_ASYNC_FREE, CMD_ASYNC_PENDING, CMD_ASYNC_DONE or
+**                 CMD_ASYNC_CANCELLED.
+** bSourceId:      Source id of the command.
+** bGeneration:    Generation of the current handle, never 0.
+**------------------------------------------------------------------------------
+*/
+typedef struct cmd_async_Entry
+{
+   ABP_MsgType* psResp;
+   UINT8        bState;
+   UINT8        bSourceId;
+   UINT8        bGeneration;
+}
+cmd_async_EntryType;
+
+static cmd_async_EntryType cmd_async_asEntry[ ABCC_CFG_CMD_ASYNC_NUM_HANDLES ];
+
+/*------------------------------------------------------------------------------
+** Finds the entry of a handle.
+** Must be called within the response handler critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    xHandle         - Command handle.
+**
+** Returns:
+**    The entry, NULL if the handle is not valid.
+**------------------------------------------------------------------------------
+*/
+static cmd_async_EntryType* cmd_async_GetEntry( ABCC_CmdHandleType xHandle )
+{
+   cmd_async_EntryType* psEntry;
+
+   if( CMD_ASYNC_INDEX( xHandle ) >= ABCC_CFG_CMD_ASYNC_NUM_HANDLES )
+   {
+      return( NULL );
+   }
+
+   psEntry = &cmd_async_asEntry[ CMD_ASYNC_INDEX( xHandle ) ];
+
+   if( ( psEntry->bState == CMD_ASYNC_FREE ) ||
+       ( psEntry->bState == CMD_ASYNC_CANCELLED ) ||
+       ( psEntry->bGeneration != CMD_ASYNC_GENERATION( xHandle ) ) )
+   {
+      return( NULL );
+   }
+
+   return( psEntry );
+}
+
+/*------------------------------------------------------------------------------
+** Invalidates the handle of an entry.
+** Must be called within the response handler critical section.
+**------------------------------------------------------------------------------
+*/
+static void cmd_async_Invalidate( cmd_async_EntryType* psEntry )
+{
+   if( ++psEntry->bGeneration == 0 )
+   {
+      psEntry->bGeneration = 1;
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Releases an entry and invalidates its handle.
+** Must be called within the response handler critical section.
+**------------------------------------------------------------------------------
+*/
+static void cmd_async_Release( cmd_async_EntryType* psEntry )
+{
+   psEntry->bState = CMD_ASYNC_FREE;
+   psEntry->psResp = NULL;
+   cmd_async_Invalidate( psEntry );
+}
+
+/*------------------------------------------------------------------------------
+** Gets the state of a command.
+**------------------------------------------------------------------------------
+** Arguments:
+**    xHandle         - Command handle.
+**
+** Returns:
+**    CMD_ASYNC_PENDING or CMD_ASYNC_DONE, CMD_ASYNC_FREE if the handle is not
+**    valid.
+**------------------------------------------------------------------------------
+*/
+static UINT8 cmd_async_GetState( ABCC_CmdHandleType xHandle )
+{
+   cmd_async_EntryType* psEntry;
+   UINT8 bState = CMD_ASYNC_FREE;
+   ABCC_PORT_MSG_HANDLER_UseCritical();
+
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   psEntry = cmd_async_GetEntry( xHandle );
+   if( psEntry != NULL )
+   {
+      bState = psEntry->bState;
+   }
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
+
+   return( bState );
+}
+
+/*------------------------------------------------------------------------------
+** Response handler of all commands sent with ABCC_SendCmdAsync(). Keeps the
+** response buffer in the entry of the command. The response of a cancelled
+** command only releases the entry, the driver frees the buffer when this
+** handler returns.
+**------------------------------------------------------------------------------
+*/
+static void cmd_async_RespHandler( ABP_MsgType* psMsg )
+{
+   UINT8 bSourceId;
+   UINT8 bIndex;
+   ABCC_PORT_MSG_HANDLER_UseCritical();
+
+   bSourceId = ABCC_GetMsgSourceId( psMsg );
+
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   for( bIndex = 0; bIndex < ABCC_CFG_CMD_ASYNC_NUM_HANDLES; bIndex++ )
+   {
+      if( ( cmd_async_asEntry[ bIndex ].bState == CMD_ASYNC_CANCELLED ) &&
+          ( cmd_async_asEntry[ bIndex ].bSourceId == bSourceId ) )
+      {
+         cmd_async_Release( &cmd_async_asEntry[ bIndex ] );
+         break;
+      }
+
+      if( ( cmd_async_asEntry[ bIndex ].bState == CMD_ASYNC_PENDING ) &&
+          ( cmd_async_asEntry[ bIndex ].bSourceId == bSourceId ) )
+      {
+         /*
+         ** The buffer must be owned by the entry before the application can
+         ** see the response, otherwise the driver could free it after this
+         ** handler returns.
+         */
+         ABCC_TakeMsgBufferOwnership( psMsg );
+         cmd_async_asEntry[ bIndex ].psResp = psMsg;
+         cmd_async_asEntry[ bIndex ].bState = CMD_ASYNC_DONE;
+         break;
+      }
+   }
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
+}
+
+void ABCC_CmdAsyncInit( void )
+{
+   UINT8 bIndex;
+
+   for( bIndex = 0; bIndex < ABCC_CFG_CMD_ASYNC_NUM_HANDLES; bIndex++ )
+   {
+      cmd_async_asEntry[ bIndex ].bState = CMD_ASYNC_FREE;
+      cmd_async_asEntry[ bIndex ].psResp = NULL;
+      cmd_async_asEntry[ bIndex ].bGeneration = 1;
+   }
+}
+
+ABCC_ErrorCodeType ABCC_SendCmdAsync( ABP_MsgType* psCmdMsg,
+                                      ABCC_CmdHandleType* pxHandle )
+{
+   ABCC_ErrorCodeType eResult;
+   ABCC_CmdHandleType xHandle = ABCC_CMD_HANDLE_INVALID;
+   UINT8 bIndex;
+   ABCC_PORT_MSG_HANDLER_UseCritical();
+
+   *pxHandle = ABCC_CMD_HANDLE_INVALID;
+
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   for( bIndex = 0; bIndex < ABCC_CFG_CMD_ASYNC_NUM_HANDLES; bIndex++ )
+   {
+      if( cmd_async_asEntry[ bIndex ].bState == CMD_ASYNC_FREE )
+      {
+         cmd_async_asEntry[ bIndex ].bState = CMD_ASYNC_PENDING;
+         cmd_async_asEntry[ bIndex ].bSourceId = ABCC_GetMsgSourceId( psCmdMsg );
+         xHandle = CMD_ASYNC_HANDLE( bIndex, cmd_async_asEntry[ bIndex ].bGeneration );
+         break;
+      }
+   }
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
+
+   if( xHandle == ABCC_CMD_HANDLE_INVALID )
+   {
+      ABCC_LOG_WARNING( ABCC_EC_NO_RESOURCES, 0, "No free command handle\n" );
+      return( ABCC_EC_NO_RESOURCES );
+   }
+
+   /*
+   ** The entry is pending before the command is sent, so the response can be
+   ** stored even if it arrives before this function returns.
+   */
+   eResult = ABCC_SendCmdMsg( psCmdMsg, cmd_async_RespHandler );
+
+   if( eResult != ABCC_EC_NO_ERROR )
+   {
+      ABCC_PORT_MSG_HANDLER_EnterCritical();
+      cmd_async_Release( &cmd_async_asEntry[ bIndex ] );
+      ABCC_PORT_MSG_HANDLER_ExitCritical();
+      return( eResult );
+   }
+
+   *pxHandle = xHandle;
+
+   return( ABCC_EC_NO_ERROR );
+}
+
+BOOL ABCC_CmdPoll( ABCC_CmdHandleType xHandle )
+{
+   return( cmd_async_GetState( xHandle ) == CMD_ASYNC_DONE );
+}
+
+BOOL ABCC_CmdWait( ABCC_CmdHandleType xHandle, UINT32 lTimeoutMs )
+{
+   UINT64 llStartNs;
+   UINT64 llTimeoutNs;
+   UINT8 bState;
+
+   /*
+   ** With ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED this is the HAL clock, which runs
+   ** without the timer system being ticked.
+   */
+   llStartNs = ABCC_TimerGetTimestampNs();
+   llTimeoutNs = (UINT64)lTimeoutMs * 1000000u;
+
+   while( ( bState = cmd_async_GetState( xHandle ) ) == CMD_ASYNC_PENDING )
+   {
+      if( ( ABCC_TimerGetTimestampNs() - llStartNs ) >= llTimeoutNs )
+      {
+         return( FALSE );
+      }
+
+      ABCC_PORT_CmdWaitYield();
+   }
+
+   return( bState == CMD_ASYNC_DONE );
+}
+
+ABP_MsgType* ABCC_CmdTake( ABCC_CmdHandleType xHandle )
+{
+   cmd_async_EntryType* psEntry;
+   ABP_MsgType* psResp = NULL;
+   ABCC_PORT_MSG_HANDLER_UseCritical();
+
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   psEntry = cmd_async_GetEntry( xHandle );
+   if( ( psEntry != NULL ) && ( psEntry->bState == CMD_ASYNC_DONE ) )
+   {
+      psResp = psEntry->psResp;
+      cmd_async_Release( psEntry );
+   }
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
+
+   return( psResp );
+}
+
+BOOL ABCC_CmdCancel( ABCC_CmdHandleType xHandle )
+{
+   cmd_async_EntryType* psEntry;
+   ABP_MsgType* psResp = NULL;
+   BOOL fCancelled = FALSE;
+   ABCC_PORT_MSG_HANDLER_UseCritical();
+
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   psEntry = cmd_async_GetEntry( xHandle );
+   if( psEntry != NULL )
+   {
+      if( psEntry->bState == CMD_ASYNC_DONE )
+      {
+         psResp = psEntry->psResp;
+         cmd_async_Release( psEntry );
+      }
+      else
+      {
+         psEntry->bState = CMD_ASYNC_CANCELLED;
+         cmd_async_Invalidate( psEntry );
+      }
+      fCancelled = TRUE;
+   }
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
+
+   if( psResp != NULL )
+   {
+      ABCC_ReturnMsgBuffer( &psResp );
+   }
+
+   return( fCancelled );
+}
+
+#endif
@@ -0,0 +1,32 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Command handles for ABCC_SendCmdAsync(). See ABCC_CFG_CMD_ASYNC_ENABLED.
+********************************************************************************
+*/
+
+#ifndef ABCC_CMD_ASYNC_H_
+#define ABCC_CMD_ASYNC_H_
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+
+#if ABCC_CFG_CMD_ASYNC_ENABLED
+
+/*------------------------------------------------------------------------------
+** Init internal variables. Releases all command handles.
+**------------------------------------------------------------------------------
+** Arguments:
+**       None.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_CmdAsyncInit( void );
+
+#endif
+
+#endif  /* inclusion lock */
@@ -86,11 +86,11 @@ static CmdSeqEntryType* AllocCmdSeqEntry( const ABCC_CmdSeqType* pasCmdSeq )
 {
    UINT8 i;
    CmdSeqEntryType* psEntry;
-   ABCC_PORT_UseCritical();
+   ABCC_PORT_CMDSEQ_UseCritical();
 
    psEntry = NULL;
 
-   ABCC_PORT_EnterCritical();
+   ABCC_PORT_CMDSEQ_EnterCritical();
 
    for( i = 0; i < ABCC_CFG_MAX_NUM_CMD_SEQ; i++ )
    {
@@ -102,7 +102,7 @@ static CmdSeqEntryType* AllocCmdSeqEntry( const ABCC_CmdSeqType* pasCmdSeq )
       }
    }
 
-   ABCC_PORT_ExitCritical();
+   ABCC_PORT_CMDSEQ_ExitCritical();
    return( psEntry );
 }
 
@@ -228,10 +228,10 @@ static BOOL CheckAndSetState( CmdSeqEntryType* psCmdSeqHandler,
                               CmdSeqStateType eNewState )
 {
    BOOL fRet;
-   ABCC_PORT_UseCritical();
+   ABCC_PORT_CMDSEQ_UseCritical();
 
    fRet = FALSE;
-   ABCC_PORT_EnterCritical();
+   ABCC_PORT_CMDSEQ_EnterCritical();
 
    if( ( eCheckState == CMD_SEQ_STATE_ANY ) ||
        ( eCheckState == psCmdSeqHandler->eState ) )
@@ -252,7 +252,7 @@ static BOOL CheckAndSetState( CmdSeqEntryType* psCmdSeqHandler,
       fRet = TRUE;
    }
 
-   ABCC_PORT_ExitCritical();
+   ABCC_PORT_CMDSEQ_ExitCritical();
 
    return( fRet );
 }
@@ -273,10 +273,10 @@ static void DoAbort( CmdSeqEntryType* psEntry )
    UINT8 bSourceId = 0;
    ABCC_CmdSeqDoneHandler pnSeqDone;
    void *pxUserData;
-   ABCC_PORT_UseCritical();
+   ABCC_PORT_CMDSEQ_UseCritical();
 
    fFreeSourceId = FALSE;
-   ABCC_PORT_EnterCritical();
+   ABCC_PORT_CMDSEQ_EnterCritical();
 
    if( psEntry->eState == CMD_SEQ_STATE_BUSY )
    {
@@ -314,7 +314,7 @@ static void DoAbort( CmdSeqEntryType* psEntry )
          pnSeqDone( ABCC_CMDSEQ_RESULT_ABORT_EXT, pxUserData );
       }
    }
-   ABCC_PORT_ExitCritical();
+   ABCC_PORT_CMDSEQ_ExitCritical();
 
    /*
    ** Free of sourceId is done outside critical section to avoid nested
@@ -412,6 +412,15 @@ static void HandleResponse( ABP_MsgType* psMsg )
             */
             psMsg = ABCC_GetCmdMsgBuffer();
          }
+         else if( ABCC_MemGetBufferSize( psMsg ) < ABCC_GetMaxMessageSize() )
+         {
+            /*
+            ** The response was received in a smaller buffer than the next
+            ** command may need. The response buffer is freed by the driver when
+            ** the response handler returns.
+            */
+            psMsg = ABCC_GetCmdMsgBuffer();
+         }
 
          /*
          ** Execute next command. The return value is ignored
@@ -481,4 +481,135 @@ EXTFUNC BOOL ( *pnABCC_DrvIsSupervised )( void );
 */
 EXTFUNC UINT8 ( *pnABCC_DrvGetAnbStatus )( void );
 
+/*------------------------------------------------------------------------------
+** Static binding of the driver functions above to the only enabled low-level
+** driver, see ABCC_CFG_DRV_STATIC_BINDING_ENABLED. Functions not implemented
+** by the driver are bound to a typed NULL pointer so that the NULL checks at
+** the call sites still compile and are resolved at compile time.
+**------------------------------------------------------------------------------
+*/
+#if ABCC_CFG_DRV_STATIC_BINDING_ENABLED
+#if ABCC_CFG_DRV_SPI_ENABLED
+#include "spi/abcc_driver_spi_interface.h"
+
+EXTFUNC void ABCC_SpiRunDriver( void );
+
+#define pnABCC_DrvRun                    ABCC_SpiRunDriver
+#define pnABCC_DrvInit                   ABCC_DrvSpiInit
+#define pnABCC_DrvISR                    ( (UINT16 (*)( void ))NULL )
+#define pnABCC_DrvRunDriverTx            ABCC_DrvSpiRunDriverTx
+#define pnABCC_DrvRunDriverRx            ABCC_DrvSpiRunDriverRx
+#define pnABCC_DrvPrepareWriteMessage    ( (void (*)( ABP_MsgType* ))NULL )
+#define pnABCC_DrvWriteMessage           ABCC_DrvSpiWriteMessage
+#define pnABCC_DrvWriteProcessData       ABCC_DrvSpiWriteProcessData
+#define pnABCC_DrvISReadyForWrPd         ABCC_DrvSpiIsReadyForWrPd
+#define pnABCC_DrvISReadyForWriteMessage ABCC_DrvSpiIsReadyForWriteMessage
+#define pnABCC_DrvISReadyForCmd          ABCC_DrvSpiIsReadyForCmd
+#define pnABCC_DrvSetNbrOfCmds           ABCC_DrvSpiSetNbrOfCmds
+#define pnABCC_DrvSetAppStatus           ABCC_DrvSpiSetAppStatus
+#define pnABCC_DrvSetPdSize              ABCC_DrvSpiSetPdSize
+#define pnABCC_DrvSetIntMask             ABCC_DrvSpiSetIntMask
+#define pnABCC_DrvGetWrPdBuffer          ABCC_DrvSpiGetWrPdBuffer
+#define pnABCC_DrvGetModCap              ABCC_DrvSpiGetModCap
+#define pnABCC_DrvGetLedStatus           ABCC_DrvSpiGetLedStatus
+#define pnABCC_DrvGetIntStatus           ABCC_DrvSpiGetIntStatus
+#define pnABCC_DrvGetAnybusState         ABCC_DrvSpiGetAnybusState
+#define pnABCC_DrvReadProcessData        ABCC_DrvSpiReadProcessData
+#define pnABCC_DrvReadMessage            ABCC_DrvSpiReadMessage
+#define pnABCC_DrvIsSupervised           ABCC_DrvSpiIsSupervised
+#define pnABCC_DrvGetAnbStatus           ABCC_DrvSpiGetAnbStatus
+#endif
+
+#if ABCC_CFG_DRV_PARALLEL_ENABLED
+#include "par/abcc_driver_parallel_interface.h"
+
+EXTFUNC void ABCC_ParRunDriver( void );
+
+#define pnABCC_DrvRun                    ABCC_ParRunDriver
+#define pnABCC_DrvInit                   ABCC_DrvParInit
+#define pnABCC_DrvISR                    ABCC_DrvParISR
+#define pnABCC_DrvRunDriverTx            ( (void (*)( void ))NULL )
+#define pnABCC_DrvRunDriverRx            ABCC_DrvParRunDriverRx
+#define pnABCC_DrvPrepareWriteMessage    ABCC_DrvParPrepareWriteMessage
+#define pnABCC_DrvWriteMessage           ABCC_DrvParWriteMessage
+#define pnABCC_DrvWriteProcessData       ABCC_DrvParWriteProcessData
+#define pnABCC_DrvISReadyForWrPd         ABCC_DrvParIsReadyForWrPd
+#define pnABCC_DrvISReadyForWriteMessage ABCC_DrvParIsReadyForWriteMessage
+#define pnABCC_DrvISReadyForCmd          ABCC_DrvParIsReadyForCmd
+#define pnABCC_DrvSetNbrOfCmds           ABCC_DrvParSetNbrOfCmds
+#define pnABCC_DrvSetAppStatus           ABCC_DrvParSetAppStatus
+#define pnABCC_DrvSetPdSize              ABCC_DrvParSetPdSize
+#define pnABCC_DrvSetIntMask             ABCC_DrvParSetIntMask
+#define pnABCC_DrvGetWrPdBuffer          ABCC_DrvParGetWrPdBuffer
+#define pnABCC_DrvGetModCap              ABCC_DrvParGetModCap
+#define pnABCC_DrvGetLedStatus           ABCC_DrvParGetLedStatus
+#define pnABCC_DrvGetIntStatus           ABCC_DrvParGetIntStatus
+#define pnABCC_DrvGetAnybusState         ABCC_DrvParGetAnybusState
+#define pnABCC_DrvReadProcessData        ABCC_DrvParReadProcessData
+#define pnABCC_DrvReadMessage            ABCC_DrvParReadMessage
+#define pnABCC_DrvIsSupervised           ABCC_DrvParIsSupervised
+#define pnABCC_DrvGetAnbStatus           ABCC_DrvParGetAnbStatus
+#endif
+
+#if ABCC_CFG_DRV_SERIAL_ENABLED
+#include "serial/abcc_driver_serial_interface.h"
+
+EXTFUNC void ABCC_SerRunDriver( void );
+
+#define pnABCC_DrvRun                    ABCC_SerRunDriver
+#define pnABCC_DrvInit                   ABCC_DrvSerInit
+#define pnABCC_DrvISR                    ABCC_DrvSerISR
+#define pnABCC_DrvRunDriverTx            ABCC_DrvSerRunDriverTx
+#define pnABCC_DrvRunDriverRx            ABCC_DrvSerRunDriverRx
+#define pnABCC_DrvPrepareWriteMessage    ( (void (*)( ABP_MsgType* ))NULL )
+#define pnABCC_DrvWriteMessage           ABCC_DrvSerWriteMessage
+#define pnABCC_DrvWriteProcessData       ABCC_DrvSerWriteProcessData
+#define pnABCC_DrvISReadyForWrPd         ABCC_DrvSerIsReadyForWrPd
+#define pnABCC_DrvISReadyForWriteMessage ABCC_DrvSerIsReadyForWriteMessage
+#define pnABCC_DrvISReadyForCmd          ABCC_DrvSerIsReadyForCmd
+#define pnABCC_DrvSetNbrOfCmds           ABCC_DrvSerSetNbrOfCmds
+#define pnABCC_DrvSetAppStatus           ABCC_DrvSerSetAppStatus
+#define pnABCC_DrvSetPdSize              ABCC_DrvSerSetPdSize
+#define pnABCC_DrvSetIntMask             ABCC_DrvSerSetIntMask
+#define pnABCC_DrvGetWrPdBuffer          ABCC_DrvSerGetWrPdBuffer
+#define pnABCC_DrvGetModCap              ABCC_DrvSerGetModCap
+#define pnABCC_DrvGetLedStatus           ABCC_DrvSerGetLedStatus
+#define pnABCC_DrvGetIntStatus           ABCC_DrvSerGetIntStatus
+#define pnABCC_DrvGetAnybusState         ABCC_DrvSerGetAnybusState
+#define pnABCC_DrvReadProcessData        ABCC_DrvSerReadProcessData
+#define pnABCC_DrvReadMessage            ABCC_DrvSerReadMessage
+#define pnABCC_DrvIsSupervised           ABCC_DrvSerIsSupervised
+#define pnABCC_DrvGetAnbStatus           ABCC_DrvSerGetAnbStatus
+#endif
+#endif
+
+/*------------------------------------------------------------------------------
+** Calls pnABCC_DrvPrepareWriteMessage() if it is implemented by the driver.
+** With static binding the check is resolved at compile time.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psWriteMsg   - Pointer to message.
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+#if ABCC_CFG_DRV_STATIC_BINDING_ENABLED
+#if ABCC_CFG_DRV_PARALLEL_ENABLED
+#define ABCC_DrvPrepareWriteMessage( psWriteMsg )                              \
+        ABCC_DrvParPrepareWriteMessage( psWriteMsg )
+#else
+#define ABCC_DrvPrepareWriteMessage( psWriteMsg )
+#endif
+#else
+#define ABCC_DrvPrepareWriteMessage( psWriteMsg )                              \
+do                                                                             \
+{                                                                              \
+   if( pnABCC_DrvPrepareWriteMessage != NULL )                                 \
+   {                                                                           \
+      pnABCC_DrvPrepareWriteMessage( psWriteMsg );                             \
+   }                                                                           \
+}                                                                              \
+while( 0 )
+#endif
+
 #endif  /* inclusion lock */
@@ -23,6 +23,9 @@
 #include "abcc_setup.h"
 #include "abcc_port.h"
 #include "abcc_segmentation.h"
+#include "abcc_pd_exchange.h"
+#include "abcc_rx_dispatch.h"
+#include "abcc_cmd_async.h"
 
 #if ABCC_CFG_DRV_SPI_ENABLED
 #include "spi/abcc_driver_spi_interface.h"
@@ -56,6 +59,9 @@ EXTFUNC void ABCC_SpiISR( void );
 
 EXTFUNC void ABCC_ParRunDriver( void );
 EXTFUNC void ABCC_ParISR( void );
+#if ABCC_CFG_INT_ENABLED && ABCC_CFG_INT_COALESCE_MASK
+EXTFUNC BOOL ABCC_ParIsIntDeferred( void );
+#endif
 
 EXTFUNC void ABCC_SerRunDriver( void );
 EXTFUNC void ABCC_SerISR( void );
@@ -72,8 +78,10 @@ void ( *ABCC_TriggerWrPdUpdate )( void );
 UINT16 ABCC_iInterruptEnableMask;
 
 /*
-** Registerd driver functions
+** Registerd driver functions. With ABCC_CFG_DRV_STATIC_BINDING_ENABLED they
+** are bound at compile time in abcc_driver_interface.h.
 */
+#if !ABCC_CFG_DRV_STATIC_BINDING_ENABLED
 void ( *pnABCC_DrvRun )( void );
 void  ( *pnABCC_DrvInit )( UINT8 bOpmode );
 UINT16 ( *pnABCC_DrvISR )( void );
@@ -98,6 +106,7 @@ void* ( *pnABCC_DrvReadProcessData )( void );
 ABP_MsgType* ( *pnABCC_DrvReadMessage )( void );
 BOOL ( *pnABCC_DrvIsSupervised )( void );
 UINT8 ( *pnABCC_DrvGetAnbStatus )( void );
+#endif
 
 #if ABCC_CFG_SYNC_MEASUREMENT_IP_ENABLED
 BOOL fAbccUserSyncMeasurementIp;
@@ -138,6 +147,12 @@ static BOOL abcc_fReadyForCommunication = FALSE;
 */
 static UINT8 abcc_bOpmode = 0;
 
+/*
+** TRUE if the operating mode has to be polled by ABCC_RunDriver(), FALSE if
+** all events are notified by the ABCC interrupt.
+*/
+static BOOL abcc_fPollRequired = TRUE;
+
 #if ( ABCC_CFG_DRV_SPI_ENABLED || ABCC_CFG_DRV_SERIAL_ENABLED )
 /*
 ** Flag to indicate that WrPD update shall be done
@@ -165,7 +180,11 @@ static void TriggerWrPdUpdateNow( void )
       ** The application converts the data accordingly.
       */
 
+#if ABCC_CFG_PD_TRIPLE_BUFFER_ENABLED
+      if( ABCC_PdExchangeUpdateWritePd( abcc_pbWrPdBuffer ) )
+#else
       if( ABCC_CbfUpdateWriteProcessData( abcc_pbWrPdBuffer ) )
+#endif
       {
          pnABCC_DrvWriteProcessData( abcc_pbWrPdBuffer );
 #if ABCC_CFG_SYNC_MEASUREMENT_IP_ENABLED
@@ -313,9 +332,11 @@ UINT16 ABCC_GetMaxMessageSize( void )
 
 void ABCC_TriggerAnbStatusUpdate( void )
 {
-   UINT8 bAnbState;
+   ABCC_HandleAnbState( pnABCC_DrvGetAnybusState() );
+}
 
-   bAnbState = pnABCC_DrvGetAnybusState();
+void ABCC_HandleAnbState( UINT8 bAnbState )
+{
    if( bAnbState != abcc_bAnbState )
    {
       abcc_bAnbState = bAnbState;
@@ -391,6 +412,7 @@ ABCC_ErrorCodeType ABCC_StartDriver( UINT32 lMaxStartupTimeMs )
       ABCC_ISR                   = NULL;
       ABCC_TriggerWrPdUpdate     = &TriggerWrPdUpdateLater;
 
+#if !ABCC_CFG_DRV_STATIC_BINDING_ENABLED
       pnABCC_DrvRun              = &ABCC_SerRunDriver;
       pnABCC_DrvInit               = &ABCC_DrvSerInit;
       pnABCC_DrvISR                = &ABCC_DrvSerISR;
@@ -415,9 +437,11 @@ ABCC_ErrorCodeType ABCC_StartDriver( UINT32 lMaxStartupTimeMs )
       pnABCC_DrvReadMessage        = &ABCC_DrvSerReadMessage;
       pnABCC_DrvIsSupervised       = &ABCC_DrvSerIsSupervised;
       pnABCC_DrvGetAnbStatus       = &ABCC_DrvSerGetAnbStatus;
+#endif
 
       ABCC_iInterruptEnableMask = 0;
       abcc_iMessageChannelSize = ABP_MAX_MSG_255_DATA_BYTES;
+      abcc_fPollRequired = TRUE;
 
       break;
 #endif /* End of #if ABCC_CFG_DRV_SERIAL_ENABLED */
@@ -427,6 +451,7 @@ ABCC_ErrorCodeType ABCC_StartDriver( UINT32 lMaxStartupTimeMs )
       ABCC_ISR                   = &ABCC_SpiISR;
       ABCC_TriggerWrPdUpdate     = &TriggerWrPdUpdateLater;
 
+#if !ABCC_CFG_DRV_STATIC_BINDING_ENABLED
       pnABCC_DrvRun                = &ABCC_SpiRunDriver;
       pnABCC_DrvInit               = &ABCC_DrvSpiInit;
       pnABCC_DrvISR                = NULL;
@@ -451,9 +476,11 @@ ABCC_ErrorCodeType ABCC_StartDriver( UINT32 lMaxStartupTimeMs )
       pnABCC_DrvReadMessage        = &ABCC_DrvSpiReadMessage;
       pnABCC_DrvIsSupervised       = &ABCC_DrvSpiIsSupervised;
       pnABCC_DrvGetAnbStatus       = &ABCC_DrvSpiGetAnbStatus;
+#endif
 
       ABCC_iInterruptEnableMask = ABCC_CFG_INT_ENABLE_MASK_SPI;
       abcc_iMessageChannelSize = ABP_MAX_MSG_DATA_BYTES;
+      abcc_fPollRequired = TRUE;
 
       break;
 #endif /* End of #if ABCC_CFG_DRV_SPI_ENABLED */
@@ -464,6 +491,7 @@ ABCC_ErrorCodeType ABCC_StartDriver( UINT32 lMaxStartupTimeMs )
       ABCC_ISR                   = &ABCC_ParISR;
       ABCC_TriggerWrPdUpdate     = &TriggerWrPdUpdateNow;
 
+#if !ABCC_CFG_DRV_STATIC_BINDING_ENABLED
       pnABCC_DrvRun                = &ABCC_ParRunDriver;
       pnABCC_DrvInit               = &ABCC_DrvParInit;
       pnABCC_DrvISR                = &ABCC_DrvParISR;
@@ -488,6 +516,7 @@ ABCC_ErrorCodeType ABCC_StartDriver( UINT32 lMaxStartupTimeMs )
       pnABCC_DrvReadMessage        = &ABCC_DrvParReadMessage;
       pnABCC_DrvIsSupervised       = &ABCC_DrvParIsSupervised;
       pnABCC_DrvGetAnbStatus       = &ABCC_DrvParGetAnbStatus;
+#endif
 
       abcc_iMessageChannelSize = ABP_MAX_MSG_DATA_BYTES;
 
@@ -501,6 +530,13 @@ ABCC_ErrorCodeType ABCC_StartDriver( UINT32 lMaxStartupTimeMs )
       ABCC_iInterruptEnableMask = 0;
 #endif
 
+      /*
+      ** Polling is only avoided if all events that ABCC_RunDriver() acts on
+      ** are notified by the interrupt.
+      */
+      abcc_fPollRequired = ( ( ABCC_iInterruptEnableMask & ABCC_POLL_EVENT_INT_MASK ) !=
+                             ABCC_POLL_EVENT_INT_MASK );
+
       break;
 #endif /* End of #if ABCC_CFG_DRV_PARALLEL_ENABLED */
    default:
@@ -532,6 +568,18 @@ ABCC_ErrorCodeType ABCC_StartDriver( UINT32 lMaxStartupTimeMs )
 #endif
    ABCC_SetupInit();
    ABCC_SegmentationInit();
+#if ABCC_CFG_SEG_CLIENT_ENABLED
+   ABCC_SegClientInit();
+#endif
+#if ABCC_CFG_PD_TRIPLE_BUFFER_ENABLED
+   ABCC_PdExchangeInit();
+#endif
+#if ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED
+   ABCC_RxDispatchInit();
+#endif
+#if ABCC_CFG_CMD_ASYNC_ENABLED
+   ABCC_CmdAsyncInit();
+#endif
 
    abcc_bAnbState = 0xff;
 
@@ -671,7 +719,7 @@ void ABCC_TriggerRdPdUpdate( void )
          ** The data format of the process data is network specific.
          ** Convert it to our native format.
          */
-         ABCC_CbfNewReadPd( bpRdPd );
+         ABCC_HandleNewReadPd( bpRdPd );
       }
    }
 
@@ -685,16 +733,32 @@ void ABCC_TriggerRdPdUpdate( void )
 #endif
 }
 
+void ABCC_HandleNewReadPd( void* pxRdPd )
+{
+#if ABCC_CFG_PD_TRIPLE_BUFFER_ENABLED
+   ABCC_PdExchangeNewReadPd( pxRdPd );
+#else
+   ABCC_CbfNewReadPd( pxRdPd );
+#endif
+}
+
 void ABCC_TriggerReceiveMessage ( void )
 {
-   ABCC_MsgType sRdMsg;
+   ABP_MsgType* psRdMsg;
 
-   sRdMsg.psMsg = ABCC_LinkReadMessage();
+   psRdMsg = ABCC_LinkReadMessage();
 
-   if( sRdMsg.psMsg == NULL )
+   if( psRdMsg != NULL )
    {
-      return;
+      ABCC_HandleReceivedMessage( psRdMsg );
    }
+}
+
+void ABCC_HandleReceivedMessage( ABP_MsgType* psMsg )
+{
+   ABCC_MsgType sRdMsg;
+
+   sRdMsg.psMsg = psMsg;
 
    ABCC_LOG_DEBUG_HEXDUMP_MSG_RX( sRdMsg.psMsg );
    ABCC_LOG_DEBUG_MSG_CONTENT( sRdMsg.psMsg, "Msg received\n" );
@@ -756,6 +820,9 @@ void ABCC_TriggerReceiveMessage ( void )
 
          if( pnMsgHandler )
          {
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+            ABCC_LinkLatencyRespReceived( sRdMsg.psMsg );
+#endif
             ABCC_LOG_DEBUG_MSG_EVENT( sRdMsg.psMsg, "Routing response to registered response handler: " );
             pnMsgHandler( sRdMsg.psMsg );
          }
@@ -776,13 +843,48 @@ void ABCC_TriggerReceiveMessage ( void )
    }
 }
 
-ABCC_ErrorCodeType ABCC_SendCmdMsg( ABP_MsgType*  psCmdMsg, ABCC_MsgHandlerFuncType pnMsgHandler )
+/*------------------------------------------------------------------------------
+** Maps the response handler and sends a command message.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psCmdMsg     - Pointer to the command message.
+**    pnMsgHandler - Pointer to the function to handle the response message.
+**    bPriority    - Command queue priority class.
+**    lTimeoutMs   - Response timeout in ms. 0 means no timeout.
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+static ABCC_ErrorCodeType SendCmdMsg( ABP_MsgType* psCmdMsg,
+                                      ABCC_MsgHandlerFuncType pnMsgHandler,
+                                      UINT8 bPriority,
+                                      UINT32 lTimeoutMs )
 {
    ABCC_ErrorCodeType eResult;
    ABCC_MsgType sMsg;
 
    sMsg.psMsg = psCmdMsg;
 
+   if( bPriority >= ABCC_CFG_NUM_CMD_PRIO )
+   {
+      ABCC_LOG_WARNING( ABCC_EC_PARAMETER_NOT_VALID,
+         (UINT32)bPriority,
+         "Invalid command priority: %" PRIu8 "\n",
+         bPriority );
+      return( ABCC_EC_PARAMETER_NOT_VALID );
+   }
+
+#if !ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+   if( lTimeoutMs > 0 )
+   {
+      ABCC_LOG_WARNING( ABCC_EC_PARAMETER_NOT_VALID,
+         lTimeoutMs,
+         "Response timeouts not enabled\n" );
+      return( ABCC_EC_PARAMETER_NOT_VALID );
+   }
+#endif
+
    /*
    ** Register function to handle response.
    ** Must be done before sending the message to avoid race condition.
@@ -790,7 +892,13 @@ ABCC_ErrorCodeType ABCC_SendCmdMsg( ABP_MsgType*  psCmdMsg, ABCC_MsgHandlerFuncT
    if( ABCC_LinkMapMsgHandler( ABCC_GetLowAddrOct( sMsg.psMsg16->sHeader.iSourceIdDestObj ),
                                pnMsgHandler ) == ABCC_EC_NO_ERROR )
    {
-      eResult = ABCC_LinkWriteMessage( sMsg.psMsg );
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+      if( lTimeoutMs > 0 )
+      {
+         ABCC_LinkStartRespTimer( sMsg.psMsg, lTimeoutMs );
+      }
+#endif
+      eResult = ABCC_LinkWriteCmdMessage( sMsg.psMsg, bPriority );
       if( eResult != ABCC_EC_NO_ERROR )
       {
          /*
@@ -812,24 +920,110 @@ ABCC_ErrorCodeType ABCC_SendCmdMsg( ABP_MsgType*  psCmdMsg, ABCC_MsgHandlerFuncT
    return( eResult );
 }
 
+ABCC_ErrorCodeType ABCC_SendCmdMsg( ABP_MsgType*  psCmdMsg, ABCC_MsgHandlerFuncType pnMsgHandler )
+{
+   return( SendCmdMsg( psCmdMsg, pnMsgHandler, 0, 0 ) );
+}
+
+ABCC_ErrorCodeType ABCC_SendCmdMsgWithPriority( ABP_MsgType* psCmdMsg,
+                                                ABCC_MsgHandlerFuncType pnMsgHandler,
+                                                UINT8 bPriority )
+{
+   return( SendCmdMsg( psCmdMsg, pnMsgHandler, bPriority, 0 ) );
+}
+
+ABCC_ErrorCodeType ABCC_SendCmdMsgEx( ABP_MsgType* psCmdMsg,
+                                      ABCC_MsgHandlerFuncType pnMsgHandler,
+                                      UINT8 bPriority,
+                                      UINT32 lTimeoutMs )
+{
+   return( SendCmdMsg( psCmdMsg, pnMsgHandler, bPriority, lTimeoutMs ) );
+}
+
+ABCC_ErrorCodeType ABCC_SendCmdMsgBatch( const ABCC_CmdMsgBatchEntryType* pasCmds,
+                                         UINT8 bNumMsgs )
+{
+   return( ABCC_LinkWriteCmdMessages( pasCmds, bNumMsgs ) );
+}
+
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+ABCC_ErrorCodeType ABCC_SendCmdMsgWithTimeout( ABP_MsgType* psCmdMsg,
+                                               ABCC_MsgHandlerFuncType pnMsgHandler,
+                                               UINT32 lTimeoutMs )
+{
+   return( SendCmdMsg( psCmdMsg, pnMsgHandler, 0, lTimeoutMs ) );
+}
+
+BOOL ABCC_IsRespTimeout( const ABP_MsgType* psMsg )
+{
+   const ABP_MsgType16* psMsg16 = (const ABP_MsgType16*)psMsg;
+
+   return( ( ( ABCC_GetLowAddrOct( psMsg16->sHeader.iCmdReserved ) & ABP_MSG_HEADER_E_BIT ) != 0 ) &&
+           ( ABCC_GetMsgDataSize( psMsg ) == 0 ) );
+}
+#endif
+
 UINT16 ABCC_GetCmdQueueSize( void )
 {
    return( ABCC_LinkGetNumCmdQueueEntries() );
 }
 
+#if ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+BOOL ABCC_GetCmdQueueStats( UINT8 bPriority, ABCC_CmdQueueStatsType* psStats )
+{
+   return( ABCC_LinkGetCmdQueueStats( bPriority, psStats ) );
+}
+#endif
+
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+BOOL ABCC_GetLatencyStats( UINT8 bObject,
+                           ABCC_LatencyStatsType* psStats,
+                           BOOL fReset )
+{
+   return( ABCC_LinkGetLatencyStats( bObject, psStats, fReset ) );
+}
+#endif
+
 
 ABCC_ErrorCodeType ABCC_SendRespMsg( ABP_MsgType* psMsgResp )
 {
    return( ABCC_LinkWriteMessage( psMsgResp ) );
 }
 
+#if ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED
+ABP_MsgType* ABCC_GetCmdMsgBufferTracked( UINT16 iDataSize,
+                                          const char* pcFile,
+                                          int xLine )
+{
+   if( ABCC_GetCmdQueueSize() == 0 )
+   {
+      return( NULL );
+   }
+   return( ABCC_MemAllocTracked( iDataSize, pcFile, xLine ) );
+}
+#else
 ABP_MsgType* ABCC_GetCmdMsgBuffer( void )
 {
    if( ABCC_GetCmdQueueSize() == 0 )
    {
       return( NULL );
    }
-   return( ABCC_MemAlloc() );
+   return( ABCC_MemAlloc( ABCC_CFG_MAX_MSG_SIZE ) );
+}
+
+ABP_MsgType* ABCC_GetCmdMsgBufferOfSize( UINT16 iDataSize )
+{
+   if( ABCC_GetCmdQueueSize() == 0 )
+   {
+      return( NULL );
+   }
+   return( ABCC_MemAlloc( iDataSize ) );
+}
+#endif
+
+UINT16 ABCC_GetMsgBufferSize( ABP_MsgType* psMsg )
+{
+   return( ABCC_MemGetBufferSize( psMsg ) );
 }
 
 ABCC_ErrorCodeType ABCC_ReturnMsgBuffer( ABP_MsgType** ppsBuffer )
@@ -844,12 +1038,97 @@ void ABCC_TakeMsgBufferOwnership( ABP_MsgType* psMsg )
    ABCC_MemSetBufferStatus( psMsg, ABCC_MEM_BUFSTAT_OWNED );
 }
 
+#if ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED
+void ABCC_MarkWrPdDirty( UINT16 iOffset, UINT16 iSize )
+{
+#if ABCC_CFG_DRV_PARALLEL_ENABLED
+   if( ( abcc_bOpmode == ABP_OP_MODE_8_BIT_PARALLEL ) ||
+       ( abcc_bOpmode == ABP_OP_MODE_16_BIT_PARALLEL ) )
+   {
+      ABCC_DrvParMarkWrPdDirty( iOffset, iSize );
+   }
+#else
+   (void)iOffset;
+   (void)iSize;
+#endif
+}
+#endif
+
 void ABCC_SetPdSize( const UINT16 iReadPdSize, const UINT16 iWritePdSize )
 {
    ABCC_LOG_INFO( "New process data sizes RdPd %" PRIu16 " WrPd %" PRIu16 "\n", iReadPdSize, iWritePdSize );
    pnABCC_DrvSetPdSize( iReadPdSize, iWritePdSize );
+#if ABCC_CFG_PD_TRIPLE_BUFFER_ENABLED
+   ABCC_PdExchangeSetSize( iReadPdSize, iWritePdSize );
+#endif
+#if ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED
+   ABCC_RxDispatchSetPdSize( iReadPdSize );
+#endif
 }
 
+#if ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED
+ABCC_ErrorCodeType ABCC_RunDriver( void )
+{
+   ABCC_ErrorCodeType eResult;
+
+   eResult = ABCC_RunDriverTx();
+
+   if( eResult == ABCC_EC_NO_ERROR )
+   {
+      eResult = ABCC_RunDriverRx();
+   }
+
+   return( eResult );
+}
+
+ABCC_ErrorCodeType ABCC_RunDriverTx( void )
+{
+   if( abcc_eMainState == ABCC_DRV_ERROR )
+   {
+      return( abcc_eLastErrorCode );
+   }
+
+   pnABCC_DrvRun();
+
+   if( abcc_eMainState == ABCC_DRV_ERROR )
+   {
+      return( abcc_eLastErrorCode );
+   }
+
+   return( ABCC_EC_NO_ERROR );
+}
+
+ABCC_ErrorCodeType ABCC_RunDriverRx( void )
+{
+   if( abcc_eMainState == ABCC_DRV_ERROR )
+   {
+      return( abcc_eLastErrorCode );
+   }
+
+   ABCC_RxDispatchExec();
+
+#if ABCC_CFG_DRV_CMD_SEQ_ENABLED
+   if( abcc_eMainState >= ABCC_DRV_SETUP )
+   {
+      ABCC_CmdSequencerExec();
+   }
+#endif
+
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+   ABCC_LinkCheckRespTimeouts();
+#endif
+#if ABCC_CFG_SEG_CLIENT_ENABLED
+   ABCC_SegClientExec();
+#endif
+
+   if( abcc_eMainState == ABCC_DRV_ERROR )
+   {
+      return( abcc_eLastErrorCode );
+   }
+
+   return( ABCC_EC_NO_ERROR );
+}
+#else
 ABCC_ErrorCodeType ABCC_RunDriver( void )
 {
    if( abcc_eMainState == ABCC_DRV_ERROR )
@@ -859,6 +1138,13 @@ ABCC_ErrorCodeType ABCC_RunDriver( void )
 
    pnABCC_DrvRun();
 
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+   ABCC_LinkCheckRespTimeouts();
+#endif
+#if ABCC_CFG_SEG_CLIENT_ENABLED
+   ABCC_SegClientExec();
+#endif
+
    if( abcc_eMainState == ABCC_DRV_ERROR )
    {
       return( abcc_eLastErrorCode );
@@ -866,6 +1152,57 @@ ABCC_ErrorCodeType ABCC_RunDriver( void )
 
    return( ABCC_EC_NO_ERROR );
 }
+#endif
+
+ABCC_ErrorCodeType ABCC_RunDriverEx( UINT8* pbPendingWork,
+                                     UINT32* plNextDeadlineMs )
+{
+   ABCC_ErrorCodeType eResult;
+   UINT32 lNextDeadlineMs;
+   UINT8 bPendingWork = 0;
+
+   eResult = ABCC_RunDriver();
+
+   lNextDeadlineMs = ABCC_TimerGetTimeToNextTmoMs();
+   if( lNextDeadlineMs != ABCC_TIMER_NO_TMO )
+   {
+      bPendingWork |= ABCC_RUN_PENDING_TIMER;
+   }
+   else
+   {
+      lNextDeadlineMs = ABCC_RUN_NO_DEADLINE;
+   }
+
+   if( abcc_fPollRequired )
+   {
+      bPendingWork |= ABCC_RUN_PENDING_POLL;
+      if( lNextDeadlineMs > ABCC_CFG_RUN_DRIVER_POLL_INTERVAL_MS )
+      {
+         lNextDeadlineMs = ABCC_CFG_RUN_DRIVER_POLL_INTERVAL_MS;
+      }
+   }
+
+#if ABCC_CFG_DRV_PARALLEL_ENABLED && ABCC_CFG_INT_ENABLED && ABCC_CFG_INT_COALESCE_MASK
+   if( ABCC_ParIsIntDeferred() )
+   {
+      bPendingWork |= ABCC_RUN_PENDING_POLL;
+      if( lNextDeadlineMs > ABCC_CFG_INT_COALESCE_WINDOW_MS )
+      {
+         lNextDeadlineMs = ABCC_CFG_INT_COALESCE_WINDOW_MS;
+      }
+   }
+#endif
+
+   if( ABCC_LinkIsSendPending() )
+   {
+      bPendingWork |= ABCC_RUN_PENDING_TX_MSG;
+   }
+
+   *pbPendingWork = bPendingWork;
+   *plNextDeadlineMs = lNextDeadlineMs;
+
+   return( eResult );
+}
 
 void ABCC_HWReset( void )
 {
@@ -889,6 +1226,10 @@ void ABCC_ShutdownDriver( void )
    ABCC_HAL_Close();
    ABCC_TimerDisable();
    SetMainState( ABCC_DRV_SHUTDOWN );
+
+#if ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED
+   (void)ABCC_MemDumpLeaks( ABCC_CFG_DEBUG_MEM_LEAK_THRESHOLD_MS );
+#endif
 }
 
 
@@ -960,17 +1301,29 @@ UINT64 ABCC_GetUptimeMs( void )
    return( ABCC_TimerGetUptimeMs() );
 }
 
+#if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED
+void ABCC_RunTimerSystemFromHal( void )
+{
+   ABCC_TimerTickFromHal();
+}
+#endif
+
+UINT64 ABCC_GetTimestampNs( void )
+{
+   return( ABCC_TimerGetTimestampNs() );
+}
+
 UINT8 ABCC_GetNewSourceId( void )
 {
    static UINT8 bSourceId = 0;
    UINT8 bTempSrcId;
-   ABCC_PORT_UseCritical();
+   ABCC_PORT_MSG_HANDLER_UseCritical();
 
    do
    {
-      ABCC_PORT_EnterCritical();
+      ABCC_PORT_MSG_HANDLER_EnterCritical();
       bTempSrcId = ++bSourceId;
-      ABCC_PORT_ExitCritical();
+      ABCC_PORT_MSG_HANDLER_ExitCritical();
    } while( ABCC_LinkIsSrcIdUsed( bTempSrcId ) );
 
    return( bTempSrcId );
@@ -28,6 +28,15 @@
 #endif
 #endif
 
+/*
+** ABCC interrupts of the events handled by ABCC_ParRunDriver() when not
+** enabled. If all are enabled the parallel operating mode runs on interrupts
+** only, see ABCC_RunDriverEx(). If none is enabled all events are polled.
+*/
+#define ABCC_POLL_EVENT_INT_MASK ( ABP_INTMASK_RDPDIEN | ABP_INTMASK_RDMSGIEN |   \
+                                   ABP_INTMASK_WRMSGIEN | ABP_INTMASK_ANBRIEN |   \
+                                   ABP_INTMASK_STATUSIEN )
+
 typedef union
 {
    ABP_MsgType*    psMsg;
@@ -130,4 +139,44 @@ EXTFUNC ABCC_MainStateType ABCC_GetMainState( void );
 */
 EXTFUNC void ABCC_CheckWrPdUpdate( void );
 
+/*------------------------------------------------------------------------------
+** Reports an Anybus state to the application if it has changed.
+** Called by ABCC_TriggerAnbStatusUpdate().
+**------------------------------------------------------------------------------
+** Arguments:
+**       bAnbState:  Anybus state read from the operating mode driver.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_HandleAnbState( UINT8 bAnbState );
+
+/*------------------------------------------------------------------------------
+** Hands new read process data over to the application.
+** Called by ABCC_TriggerRdPdUpdate().
+**------------------------------------------------------------------------------
+** Arguments:
+**       pxRdPd:     Read process data, valid in the PROCESS_ACTIVE state.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_HandleNewReadPd( void* pxRdPd );
+
+/*------------------------------------------------------------------------------
+** Routes a received message to the application command handler, a
+** segmentation session or the response handler of the command.
+** Called by ABCC_TriggerReceiveMessage().
+**------------------------------------------------------------------------------
+** Arguments:
+**       psMsg:      Message read from the link.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_HandleReceivedMessage( ABP_MsgType* psMsg );
+
 #endif  /* inclusion lock */
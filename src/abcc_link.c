@@ -26,6 +26,30 @@
 #define LINK_MAX_NUM_CMDS_IN_Q            ABCC_CFG_MAX_NUM_APPL_CMDS
 #define LINK_MAX_NUM_RESP_IN_Q            ABCC_CFG_MAX_NUM_ABCC_CMDS
 
+#if LINK_MAX_NUM_RESP_IN_Q > 0x8000
+#error "ABCC_CFG_MAX_NUM_ABCC_CMDS must not exceed 32768"
+#endif
+
+/*
+** Rounds a 16 bit value up to the nearest power of two.
+*/
+#define LINK_SMEAR_1( x )                 ( (x) | ( (x) >> 1 ) )
+#define LINK_SMEAR_2( x )                 ( LINK_SMEAR_1( x ) | ( LINK_SMEAR_1( x ) >> 2 ) )
+#define LINK_SMEAR_4( x )                 ( LINK_SMEAR_2( x ) | ( LINK_SMEAR_2( x ) >> 4 ) )
+#define LINK_SMEAR_8( x )                 ( LINK_SMEAR_4( x ) | ( LINK_SMEAR_4( x ) >> 8 ) )
+#define LINK_ROUND_UP_POW2( x )           ( LINK_SMEAR_8( (x) - 1 ) + 1 )
+
+/*
+** Size of the response queue ring buffer. The ring is a power of two so that
+** the indices can be masked instead of using a modulo operation.
+*/
+#define LINK_RESP_RING_SIZE               LINK_ROUND_UP_POW2( LINK_MAX_NUM_RESP_IN_Q )
+
+/*
+** Marks the end of a command queue list.
+*/
+#define LINK_NO_CMD_ENTRY                 0xFFFF
+
 /*
 ** Total number of message resources.
 */
@@ -40,16 +64,106 @@
 #define LINK_MAX_NUM_MSG_HDL ( LINK_MAX_NUM_CMDS_IN_Q + 1 )
 
 /*
-** Message queue type for queueing cmds and responses.
+** Number of possible source ids and the size of the source id occupancy
+** bitmap in 32 bit words.
+*/
+#define LINK_NUM_SRC_ID              256
+#define LINK_SRC_ID_BITMAP_SIZE      ( LINK_NUM_SRC_ID / 32 )
+
+/*
+** Source id occupancy bitmap helpers.
+*/
+#define LINK_SRC_ID_WORD( bSrcId )   ( (bSrcId) >> 5 )
+#define LINK_SRC_ID_MASK( bSrcId )   ( (UINT32)1 << ( (bSrcId) & 0x1F ) )
+#define LINK_IS_SRC_ID_USED( bSrcId ) \
+   ( ( link_alSrcIdUsed[ LINK_SRC_ID_WORD( bSrcId ) ] & LINK_SRC_ID_MASK( bSrcId ) ) != 0 )
+#define LINK_IS_SRC_ID_OUTSTANDING( bSrcId ) \
+   ( ( link_alSrcIdOutstanding[ LINK_SRC_ID_WORD( bSrcId ) ] & LINK_SRC_ID_MASK( bSrcId ) ) != 0 )
+
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+#if LINK_MAX_NUM_MSG_HDL >= 0xFF
+#error "ABCC_CFG_MAX_NUM_APPL_CMDS must be less than 254 when ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED is set"
+#endif
+
+/*
+** Marks a source id without an active response timeout.
+*/
+#define LINK_NO_RESP_TMO             0xFF
+
+/*
+** Response timeout of an outstanding command. The command header is kept to
+** be able to build the timeout response if the timeout expires. fGrace is set
+** for the grace period of a sent command that has already timed out.
+*/
+typedef struct link_RespTmoType
+{
+   BOOL                fActive;
+   BOOL                fGrace;
+   UINT32              lDeadlineMs;
+   ABP_MsgHeaderType16 sCmdHeader;
+}
+link_RespTmoType;
+#endif
+
+#if ABCC_CFG_NUM_CMD_PRIO < 1
+#error "ABCC_CFG_NUM_CMD_PRIO must be at least 1"
+#endif
+
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+/*
+** Latency timestamps taken for each command. The latency of phase n of
+** ABCC_LatencyPhaseType is the time from timestamp n to timestamp n + 1, the
+** last phase ends when the response is routed to the response handler.
+*/
+#define LINK_LATENCY_QUEUED          0
+#define LINK_LATENCY_HAND_OFF        1
+#define LINK_LATENCY_SENT            2
+#endif
+
+/*
+** Message queue type for queueing responses.
 */
 typedef struct MsgQueueType
 {
    ABP_MsgType** queue;
-   INT8 bReadIndex;
-   INT8 bQueueSize;
-   INT8 bNumInQueue;
+   UINT16 iReadIndex;
+   UINT16 iQueueSize;
+   UINT16 iIndexMask;
+   UINT16 iNumInQueue;
 } MsgQueueType;
 
+/*
+** Queued command. The entries of all priority classes come from one array of
+** LINK_MAX_NUM_CMDS_IN_Q entries, iNext links the entries of a class in send
+** order and the free entries.
+*/
+typedef struct link_CmdEntryType
+{
+   ABP_MsgType* psMsg;
+   UINT16 iNext;
+#if ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+   UINT32 lQueuedTimeMs;
+#endif
+}
+link_CmdEntryType;
+
+/*
+** Command queue of one priority class, a list of link_CmdEntryType.
+*/
+typedef struct link_CmdQueueType
+{
+   UINT16 iHead;
+   UINT16 iTail;
+   UINT16 iNumInQueue;
+}
+link_CmdQueueType;
+
+/*
+** Ring buffer index of a queue entry, iOffset is counted from the oldest entry.
+*/
+#define LINK_QUEUE_INDEX( psQueue, iOffset ) \
+   ( (UINT16)( (psQueue)->iReadIndex + (iOffset) ) & (psQueue)->iIndexMask )
+
 /*
 ** Callback function used by serial driver to indicate that a read remap is ready
 ** and the RdPd size can be updated.
@@ -64,19 +178,75 @@ void ( *pnABCC_DrvCbfReadRemapDone )( const ABP_MsgType* const psMsg );
 static UINT16 link_iMaxMsgSize;
 
 /*
-** Command and response queues
+** Command entries shared by all priority classes, and the response queue.
 */
-static ABP_MsgType* link_psCmds[LINK_MAX_NUM_CMDS_IN_Q ];
-static ABP_MsgType* link_psResponses[LINK_MAX_NUM_RESP_IN_Q];
+static link_CmdEntryType link_asCmdEntry[ LINK_MAX_NUM_CMDS_IN_Q ];
+static ABP_MsgType* link_psResponses[ LINK_RESP_RING_SIZE ];
 
-static MsgQueueType link_sCmdQueue;
+/*
+** One command queue per priority class, the last one has the highest priority.
+** link_iNumCmdsInQueue is the total number of queued commands and
+** link_iFreeCmdEntry the first free entry of link_asCmdEntry.
+*/
+static link_CmdQueueType link_asCmdQueue[ ABCC_CFG_NUM_CMD_PRIO ];
 static MsgQueueType link_sRespQueue;
+static UINT16 link_iNumCmdsInQueue;
+static UINT16 link_iFreeCmdEntry;
+
+#if ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+/*
+** Queueing delay statistics of each priority class.
+*/
+static ABCC_CmdQueueStatsType link_asCmdQueueStats[ ABCC_CFG_NUM_CMD_PRIO ];
+#endif
 
 /*
-** Response handlers
+** Response handlers indexed directly by source id. link_alSrcIdUsed marks
+** which entries are mapped and link_iNumMsgHandlers limits the number of
+** mapped entries to LINK_MAX_NUM_MSG_HDL.
 */
-static ABCC_MsgHandlerFuncType link_pnMsgHandler[ LINK_MAX_NUM_MSG_HDL ];
-static UINT8              link_bMsgSrcId[ LINK_MAX_NUM_MSG_HDL ];
+static ABCC_MsgHandlerFuncType link_pnMsgHandler[ LINK_NUM_SRC_ID ];
+static UINT32             link_alSrcIdUsed[ LINK_SRC_ID_BITMAP_SIZE ];
+static UINT16             link_iNumMsgHandlers;
+
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+/*
+** Response timeouts. There is at most one timeout per mapped response handler
+** or grace period, link_abRespTmoIndex maps a source id to its entry in
+** link_asRespTmo. link_iNumGraceTmo is the number of grace periods, which
+** together with link_iNumMsgHandlers is limited to LINK_MAX_NUM_MSG_HDL.
+**
+** link_alSrcIdOutstanding marks the source ids that hold one count of
+** link_iNumberOfOutstandingCommands. The flag is set when the command is
+** accepted by the link layer and cleared when the count is released: by the
+** response, by the timeout if the command was still queued and is never sent,
+** or at the end of the grace period of a sent command. A source id stays
+** reserved while its flag is set, also after the response handler of a timed
+** out command has been removed.
+**
+** link_fRespTmoExpired is set by the timer callback and is protected by the
+** timer lock, the other timer state by the response handler lock.
+*/
+static link_RespTmoType   link_asRespTmo[ LINK_MAX_NUM_MSG_HDL ];
+static UINT8              link_abRespTmoIndex[ LINK_NUM_SRC_ID ];
+static UINT32             link_alSrcIdOutstanding[ LINK_SRC_ID_BITMAP_SIZE ];
+static UINT16             link_iNumGraceTmo;
+static ABCC_TimerHandle   link_xRespTmoHandle;
+static BOOL               link_fRespTmoTimerActive;
+static BOOL               link_fRespTmoExpired;
+static UINT32             link_lRespTmoTimerDeadlineMs;
+#endif
+
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+/*
+** Latency timestamps of the outstanding command of each source id and the
+** latency statistics of each destination object in link_abLatencyObject.
+*/
+static UINT32                link_alLatencyStamp[ LINK_NUM_SRC_ID ][ ABCC_LATENCY_NUM_PHASES ];
+static UINT8                 link_abLatencyObject[ ABCC_CFG_LATENCY_STATS_NUM_OBJECTS ];
+static UINT8                 link_bNumLatencyObjects;
+static ABCC_LatencyStatsType link_asLatencyStats[ ABCC_CFG_LATENCY_STATS_NUM_OBJECTS ];
+#endif
 
 static ABCC_LinkNotifyIndType pnMsgSentHandler;
 static ABP_MsgType* link_psNotifyMsg;
@@ -84,7 +254,7 @@ static ABP_MsgType* link_psNotifyMsg;
 /*
 ** Max number of outstanding commands ( no received response yet )
 */
-static UINT8 link_bNumberOfOutstandingCommands = 0;
+static UINT16 link_iNumberOfOutstandingCommands = 0;
 
 /*
 ** Flag used to ensure that a context have exclusive access to
@@ -96,36 +266,589 @@ static BOOL link_fDrvWriteMsgLock = FALSE;
 static ABP_MsgType* link_DeQueue( MsgQueueType* psMsgQueue )
 {
    ABP_MsgType* psMsg = NULL;
-   if( psMsgQueue->bNumInQueue != 0 )
+   if( psMsgQueue->iNumInQueue != 0 )
    {
-      psMsg = psMsgQueue->queue[ psMsgQueue->bReadIndex++];
-      psMsgQueue->bNumInQueue--;
-      psMsgQueue->bReadIndex %= psMsgQueue->bQueueSize;
+      psMsg = psMsgQueue->queue[ psMsgQueue->iReadIndex ];
+      psMsgQueue->iNumInQueue--;
+      psMsgQueue->iReadIndex = LINK_QUEUE_INDEX( psMsgQueue, 1 );
    }
 
-   if( psMsgQueue->bNumInQueue < 0 )
+   return( psMsg );
+}
+
+
+static BOOL link_EnQueue( MsgQueueType* psMsgQueue, ABP_MsgType* psMsg )
+{
+   if( psMsgQueue->iNumInQueue <  psMsgQueue->iQueueSize )
    {
-      ABCC_LOG_FATAL( ABCC_EC_ASSERT_FAILED,
-         psMsgQueue->bNumInQueue,
-         "Queue underflow (%" PRId8 ")\n",
-         psMsgQueue->bNumInQueue );
+      psMsgQueue->queue[ LINK_QUEUE_INDEX( psMsgQueue, psMsgQueue->iNumInQueue ) ] = psMsg;
+      psMsgQueue->iNumInQueue++;
+      return( TRUE );
+   }
+   return( FALSE );
+}
+
+#if ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+/*------------------------------------------------------------------------------
+** Adds a queueing delay sample to the statistics of a priority class.
+** Must be called within a critical section.
+**------------------------------------------------------------------------------
+*/
+static void link_AddCmdQueueDelay( UINT8 bPriority, UINT32 lDelayMs )
+{
+   ABCC_CmdQueueStatsType* const psStats = &link_asCmdQueueStats[ bPriority ];
+
+   psStats->lNumCmds++;
+   psStats->lTotalDelayMs += lDelayMs;
+
+   if( lDelayMs > psStats->lMaxDelayMs )
+   {
+      psStats->lMaxDelayMs = lDelayMs;
+   }
+}
+#endif
+
+/*------------------------------------------------------------------------------
+** Checks if any command of at least the given priority is queued.
+** Must be called within a critical section.
+**------------------------------------------------------------------------------
+*/
+static BOOL link_IsCmdQueued( UINT8 bMinPriority )
+{
+   UINT8 bPriority;
+
+   for( bPriority = bMinPriority; bPriority < ABCC_CFG_NUM_CMD_PRIO; bPriority++ )
+   {
+      if( link_asCmdQueue[ bPriority ].iNumInQueue > 0 )
+      {
+         return( TRUE );
+      }
+   }
+
+   return( FALSE );
+}
+
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+/*------------------------------------------------------------------------------
+** Reads the latency timebase, us if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED is set
+** and ms otherwise.
+**------------------------------------------------------------------------------
+** Returns:
+**    Wrapping timestamp.
+**------------------------------------------------------------------------------
+*/
+static UINT32 link_LatencyNow( void )
+{
+#if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED
+   return( (UINT32)( ABCC_TimerGetTimestampNs() / 1000 ) );
+#else
+   return( (UINT32)ABCC_TimerGetUptimeMs() );
+#endif
+}
+
+/*------------------------------------------------------------------------------
+** Stores a latency timestamp of a command. Other messages are ignored.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psMsg           - Message.
+**    bStamp          - LINK_LATENCY_QUEUED, LINK_LATENCY_HAND_OFF or
+**                      LINK_LATENCY_SENT.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void link_LatencyStamp( const ABP_MsgType* psMsg, UINT8 bStamp )
+{
+   const ABP_MsgHeaderType16* psHeader = (const ABP_MsgHeaderType16*)psMsg;
+
+   if( ABCC_IsCmdMsg( psMsg ) )
+   {
+      link_alLatencyStamp[ ABCC_GetLowAddrOct( psHeader->iSourceIdDestObj ) ][ bStamp ] = link_LatencyNow();
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Clears latency statistics.
+**------------------------------------------------------------------------------
+*/
+static void link_ClearLatencyStats( ABCC_LatencyStatsType* psStats )
+{
+   UINT8 bPhase;
+   UINT8 bBucket;
+
+   psStats->lNumCmds = 0;
+
+   for( bPhase = 0; bPhase < ABCC_LATENCY_NUM_PHASES; bPhase++ )
+   {
+      psStats->alMax[ bPhase ] = 0;
+
+      for( bBucket = 0; bBucket < ABCC_LATENCY_NUM_BUCKETS; bBucket++ )
+      {
+         psStats->aalHistogram[ bPhase ][ bBucket ] = 0;
+      }
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Finds the latency statistics of a destination object.
+** Must be called within a critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    bObject         - Destination object.
+**    fCreate         - TRUE to assign a free entry if the object has none.
+**
+** Returns:
+**    Latency statistics, NULL if not found.
+**------------------------------------------------------------------------------
+*/
+static ABCC_LatencyStatsType* link_GetLatencyStats( UINT8 bObject, BOOL fCreate )
+{
+   UINT8 bIndex;
+
+   for( bIndex = 0; bIndex < link_bNumLatencyObjects; bIndex++ )
+   {
+      if( link_abLatencyObject[ bIndex ] == bObject )
+      {
+         return( &link_asLatencyStats[ bIndex ] );
+      }
+   }
+
+   if( fCreate && ( link_bNumLatencyObjects < ABCC_CFG_LATENCY_STATS_NUM_OBJECTS ) )
+   {
+      link_abLatencyObject[ link_bNumLatencyObjects ] = bObject;
+      link_ClearLatencyStats( &link_asLatencyStats[ link_bNumLatencyObjects ] );
+      return( &link_asLatencyStats[ link_bNumLatencyObjects++ ] );
+   }
+
+   return( NULL );
+}
+#endif
+
+/*------------------------------------------------------------------------------
+** Queues a command last in its priority class.
+** Must be called within a critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    bPriority       - Priority class.
+**    psMsg           - Command message.
+**    lNowMs          - Current uptime, used for the queueing statistics.
+**
+** Returns:
+**    FALSE if the command queues are full.
+**------------------------------------------------------------------------------
+*/
+static BOOL link_EnQueueCmd( UINT8 bPriority, ABP_MsgType* psMsg, UINT32 lNowMs )
+{
+   link_CmdQueueType* const psQueue = &link_asCmdQueue[ bPriority ];
+   const UINT16 iEntry = link_iFreeCmdEntry;
+
+   (void)lNowMs;
+
+   if( iEntry == LINK_NO_CMD_ENTRY )
+   {
+      return( FALSE );
+   }
+
+   link_iFreeCmdEntry = link_asCmdEntry[ iEntry ].iNext;
+   link_asCmdEntry[ iEntry ].psMsg = psMsg;
+   link_asCmdEntry[ iEntry ].iNext = LINK_NO_CMD_ENTRY;
+#if ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+   link_asCmdEntry[ iEntry ].lQueuedTimeMs = lNowMs;
+#endif
+
+   if( psQueue->iNumInQueue == 0 )
+   {
+      psQueue->iHead = iEntry;
+   }
+   else
+   {
+      link_asCmdEntry[ psQueue->iTail ].iNext = iEntry;
+   }
+   psQueue->iTail = iEntry;
+   psQueue->iNumInQueue++;
+   link_iNumCmdsInQueue++;
+
+   return( TRUE );
+}
+
+/*------------------------------------------------------------------------------
+** Unlinks a queued command and returns its entry to the free list.
+** Must be called within a critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    bPriority       - Priority class of the command.
+**    iPrev           - Entry before the command, LINK_NO_CMD_ENTRY if the
+**                      command is first in its class.
+**
+** Returns:
+**    Command message.
+**------------------------------------------------------------------------------
+*/
+static ABP_MsgType* link_UnlinkCmd( UINT8 bPriority, UINT16 iPrev )
+{
+   link_CmdQueueType* const psQueue = &link_asCmdQueue[ bPriority ];
+   UINT16 iEntry;
+
+   if( iPrev == LINK_NO_CMD_ENTRY )
+   {
+      iEntry = psQueue->iHead;
+      psQueue->iHead = link_asCmdEntry[ iEntry ].iNext;
+   }
+   else
+   {
+      iEntry = link_asCmdEntry[ iPrev ].iNext;
+      link_asCmdEntry[ iPrev ].iNext = link_asCmdEntry[ iEntry ].iNext;
+   }
+
+   if( psQueue->iTail == iEntry )
+   {
+      psQueue->iTail = iPrev;
+   }
+
+   psQueue->iNumInQueue--;
+   link_iNumCmdsInQueue--;
+
+   link_asCmdEntry[ iEntry ].iNext = link_iFreeCmdEntry;
+   link_iFreeCmdEntry = iEntry;
+
+   return( link_asCmdEntry[ iEntry ].psMsg );
+}
+
+/*------------------------------------------------------------------------------
+** Removes the oldest command of the highest non-empty priority class.
+** Must be called within a critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    lNowMs          - Current uptime, used for the queueing statistics.
+**
+** Returns:
+**    Command message, NULL if no command is queued.
+**------------------------------------------------------------------------------
+*/
+static ABP_MsgType* link_DeQueueCmd( UINT32 lNowMs )
+{
+   ABP_MsgType* psMsg = NULL;
+   UINT8 bPriority = ABCC_CFG_NUM_CMD_PRIO;
+
+   (void)lNowMs;
+
+   while( bPriority-- > 0 )
+   {
+      if( link_asCmdQueue[ bPriority ].iNumInQueue > 0 )
+      {
+#if ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+         link_AddCmdQueueDelay( bPriority,
+            lNowMs - link_asCmdEntry[ link_asCmdQueue[ bPriority ].iHead ].lQueuedTimeMs );
+#endif
+         psMsg = link_UnlinkCmd( bPriority, LINK_NO_CMD_ENTRY );
+         break;
+      }
    }
 
    return( psMsg );
 }
 
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+/*------------------------------------------------------------------------------
+** Timer callback for response timeouts. The timeouts are handled in
+** ABCC_LinkCheckRespTimeouts() since the response handlers must not be called
+** from the timer context. Called with the timer lock held, which is the
+** innermost lock, so only link_fRespTmoExpired is touched here.
+**------------------------------------------------------------------------------
+*/
+static void link_RespTimerExpired( void )
+{
+   link_fRespTmoExpired = TRUE;
+}
 
-static BOOL link_EnQueue( MsgQueueType* psMsgQueue, ABP_MsgType* psMsg )
+/*------------------------------------------------------------------------------
+** Sets link_fRespTmoExpired and returns its previous value.
+**------------------------------------------------------------------------------
+** Arguments:
+**    fExpired        - New value.
+**
+** Returns:
+**    Previous value.
+**------------------------------------------------------------------------------
+*/
+static BOOL link_SwapRespTmoExpired( BOOL fExpired )
 {
-   if( psMsgQueue->bNumInQueue <  psMsgQueue->bQueueSize )
+   BOOL fWasExpired;
+   ABCC_PORT_TIMER_UseCritical();
+
+   ABCC_PORT_TIMER_EnterCritical();
+   fWasExpired = link_fRespTmoExpired;
+   link_fRespTmoExpired = fExpired;
+   ABCC_PORT_TIMER_ExitCritical();
+
+   return( fWasExpired );
+}
+
+/*------------------------------------------------------------------------------
+** Removes a command that is still waiting in one of the command queues.
+** Must be called within the link critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    bSrcId          - Source id of the command.
+**
+** Returns:
+**    The removed command, NULL if it has already been handed to the driver.
+**------------------------------------------------------------------------------
+*/
+static ABP_MsgType* link_RemoveQueuedCmd( UINT8 bSrcId )
+{
+   UINT16 iPrev;
+   UINT16 iEntry;
+   UINT8 bPriority;
+
+   for( bPriority = 0; bPriority < ABCC_CFG_NUM_CMD_PRIO; bPriority++ )
    {
-      psMsgQueue->queue[  ( psMsgQueue->bNumInQueue + psMsgQueue->bReadIndex ) %  psMsgQueue->bQueueSize ] = psMsg;
-      psMsgQueue->bNumInQueue++;
+      iPrev = LINK_NO_CMD_ENTRY;
+
+      for( iEntry = link_asCmdQueue[ bPriority ].iHead;
+           iEntry != LINK_NO_CMD_ENTRY;
+           iEntry = link_asCmdEntry[ iEntry ].iNext )
+      {
+         if( ABCC_GetMsgSourceId( link_asCmdEntry[ iEntry ].psMsg ) == bSrcId )
+         {
+            return( link_UnlinkCmd( bPriority, iPrev ) );
+         }
+         iPrev = iEntry;
+      }
+   }
+
+   return( NULL );
+}
+
+/*------------------------------------------------------------------------------
+** Ends the grace period of a source id, if it has one.
+** Must be called within the response handler critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    bSrcId          - Source id of the command.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void link_StopGraceTmo( UINT8 bSrcId )
+{
+   const UINT8 bIndex = link_abRespTmoIndex[ bSrcId ];
+
+   if( ( bIndex != LINK_NO_RESP_TMO ) && link_asRespTmo[ bIndex ].fGrace )
+   {
+      link_asRespTmo[ bIndex ].fActive = FALSE;
+      link_asRespTmo[ bIndex ].fGrace = FALSE;
+      link_abRespTmoIndex[ bSrcId ] = LINK_NO_RESP_TMO;
+      link_iNumGraceTmo--;
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Sets the outstanding flag of a source id. Called within the link critical
+** section when a command takes one count of link_iNumberOfOutstandingCommands,
+** so that the flag is set exactly while the command holds the count.
+**------------------------------------------------------------------------------
+** Arguments:
+**    bSrcId          - Source id of the command.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void link_SetSrcIdOutstanding( UINT8 bSrcId )
+{
+   ABCC_PORT_MSG_HANDLER_UseCritical();
+
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   link_alSrcIdOutstanding[ LINK_SRC_ID_WORD( bSrcId ) ] |= LINK_SRC_ID_MASK( bSrcId );
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
+}
+
+/*------------------------------------------------------------------------------
+** Clears the outstanding flag of a source id and ends its grace period. The
+** flag is cleared by the response, or when it is known that the command will
+** never be sent.
+**------------------------------------------------------------------------------
+** Arguments:
+**    bSrcId          - Source id of the command.
+**
+** Returns:
+**    TRUE if the flag was set, i.e. the command resource shall be released.
+**------------------------------------------------------------------------------
+*/
+static BOOL link_ClearSrcIdOutstanding( UINT8 bSrcId )
+{
+   BOOL fOutstanding = FALSE;
+   ABCC_PORT_MSG_HANDLER_UseCritical();
+
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   if( LINK_IS_SRC_ID_OUTSTANDING( bSrcId ) )
+   {
+      link_alSrcIdOutstanding[ LINK_SRC_ID_WORD( bSrcId ) ] &= ~LINK_SRC_ID_MASK( bSrcId );
+      link_StopGraceTmo( bSrcId );
+      fOutstanding = TRUE;
+   }
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
+
+   return( fOutstanding );
+}
+
+/*------------------------------------------------------------------------------
+** Adds a response timeout and moves the timer deadline forward if the new
+** deadline is earlier. The caller makes sure that a free entry is available.
+** Must be called within the response handler critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psHeader        - Header of the command.
+**    lTimeoutMs      - Timeout in milliseconds.
+**    fGrace          - TRUE for the grace period of a timed out command.
+**
+** Returns:
+**    TRUE if the timer shall be started with lTimeoutMs.
+**------------------------------------------------------------------------------
+*/
+static BOOL link_AddRespTmo( const ABP_MsgHeaderType16* psHeader,
+                             UINT32 lTimeoutMs,
+                             BOOL fGrace )
+{
+   UINT32 lDeadlineMs;
+   UINT8 bIndex;
+
+   lDeadlineMs = (UINT32)ABCC_TimerGetUptimeMs() + lTimeoutMs;
+
+   for( bIndex = 0; bIndex < LINK_MAX_NUM_MSG_HDL; bIndex++ )
+   {
+      if( !link_asRespTmo[ bIndex ].fActive )
+      {
+         link_asRespTmo[ bIndex ].fActive = TRUE;
+         link_asRespTmo[ bIndex ].fGrace = fGrace;
+         link_asRespTmo[ bIndex ].lDeadlineMs = lDeadlineMs;
+         link_asRespTmo[ bIndex ].sCmdHeader = *psHeader;
+         link_abRespTmoIndex[ ABCC_GetLowAddrOct( psHeader->iSourceIdDestObj ) ] = bIndex;
+         break;
+      }
+   }
+
+   if( fGrace )
+   {
+      link_iNumGraceTmo++;
+   }
+
+   if( !link_fRespTmoTimerActive ||
+       ( (INT32)( lDeadlineMs - link_lRespTmoTimerDeadlineMs ) < 0 ) )
+   {
+      link_fRespTmoTimerActive = TRUE;
+      link_lRespTmoTimerDeadlineMs = lDeadlineMs;
       return( TRUE );
    }
+
    return( FALSE );
 }
 
+static ABCC_MsgHandlerFuncType link_UnmapMsgHandler( UINT8 bSrcId );
+
+/*------------------------------------------------------------------------------
+** Handles a timed out command. A command that is still queued is removed and
+** its command resource released. A command that has been handed to the driver
+** keeps its resource and source id until the ABCC responds, or at most for
+** ABCC_CFG_CMD_RESP_TIMEOUT_GRACE_MS, the response is then discarded. The
+** response handler is called with a timeout response, see
+** ABCC_IsRespTimeout().
+**------------------------------------------------------------------------------
+** Arguments:
+**    psCmdHeader     - Header of the timed out command.
+**
+** Returns:
+**    FALSE if no message buffer was available, the timeout shall be retried.
+**------------------------------------------------------------------------------
+*/
+static BOOL link_HandleRespTimeout( const ABP_MsgHeaderType16* psCmdHeader )
+{
+   ABCC_MsgHandlerFuncType pnHandler;
+   ABCC_MsgType sMsg;
+   ABP_MsgType* psQueuedCmd;
+   UINT8 bSrcId;
+   BOOL fStartTimer = FALSE;
+   ABCC_PORT_LINK_UseCritical();
+   ABCC_PORT_MSG_HANDLER_UseCritical();
+
+   bSrcId = ABCC_GetLowAddrOct( psCmdHeader->iSourceIdDestObj );
+
+   sMsg.psMsg = ABCC_MemAlloc( 0 );
+
+   if( sMsg.psMsg == NULL )
+   {
+      return( FALSE );
+   }
+
+   ABCC_PORT_LINK_EnterCritical();
+   psQueuedCmd = link_RemoveQueuedCmd( bSrcId );
+   if( psQueuedCmd != NULL )
+   {
+      link_iNumberOfOutstandingCommands--;
+   }
+   ABCC_PORT_LINK_ExitCritical();
+
+   if( psQueuedCmd != NULL )
+   {
+      /*
+      ** The command was never sent, so no response will release the source id.
+      */
+      (void)link_ClearSrcIdOutstanding( bSrcId );
+      ABCC_LinkFree( &psQueuedCmd );
+   }
+
+   /*
+   ** If the response arrived in the meantime the handler has already been
+   ** fetched by the receive path. A sent command gets its grace period in the
+   ** entry released by the handler, so no other mapping can take it first.
+   */
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   pnHandler = link_UnmapMsgHandler( bSrcId );
+   if( ( pnHandler != NULL ) && LINK_IS_SRC_ID_OUTSTANDING( bSrcId ) )
+   {
+      fStartTimer = link_AddRespTmo( psCmdHeader, ABCC_CFG_CMD_RESP_TIMEOUT_GRACE_MS, TRUE );
+   }
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
+
+   if( fStartTimer )
+   {
+      ABCC_TimerStart( link_xRespTmoHandle, ABCC_CFG_CMD_RESP_TIMEOUT_GRACE_MS );
+   }
+
+   if( pnHandler == NULL )
+   {
+      ABCC_LinkFree( &sMsg.psMsg );
+      return( TRUE );
+   }
+
+   ABCC_LOG_WARNING( ABCC_EC_RESP_TIMEOUT,
+      (UINT32)bSrcId,
+      "No response to command with source id %" PRIu8 "\n",
+      bSrcId );
+
+   /*
+   ** An error response without error code, which the ABCC never sends.
+   */
+   sMsg.psMsg16->sHeader = *psCmdHeader;
+   ABP_SetMsgResponse( sMsg.psMsg, 0 );
+   ABCC_SetLowAddrOct( sMsg.psMsg16->sHeader.iCmdReserved,
+                       ABCC_GetLowAddrOct( sMsg.psMsg16->sHeader.iCmdReserved ) | ABP_MSG_HEADER_E_BIT );
+
+   ABCC_MemSetBufferStatus( sMsg.psMsg, ABCC_MEM_BUFSTAT_IN_APPL_HANDLER );
+   pnHandler( sMsg.psMsg );
+
+   if( ABCC_MemGetBufferStatus( sMsg.psMsg ) == ABCC_MEM_BUFSTAT_IN_APPL_HANDLER )
+   {
+      ABCC_LinkFree( &sMsg.psMsg );
+   }
+
+   return( TRUE );
+}
+#endif
+
 static void link_CheckNotification( const ABP_MsgType* const psMsg )
 {
    if( ( pnMsgSentHandler != NULL ) && ( psMsg == link_psNotifyMsg ) )
@@ -143,28 +866,77 @@ void ABCC_LinkInit( void )
    /*
    ** Init Queue structures.
    */
-   link_sCmdQueue.bNumInQueue = 0;
-   link_sCmdQueue.bQueueSize = LINK_MAX_NUM_CMDS_IN_Q;
-   link_sCmdQueue.bReadIndex = 0;
-   link_sCmdQueue.queue = link_psCmds;
-
-   link_sRespQueue.bNumInQueue = 0;
-   link_sRespQueue.bQueueSize = LINK_MAX_NUM_RESP_IN_Q;
-   link_sRespQueue.bReadIndex = 0;
+   for( iCount = 0; iCount < ABCC_CFG_NUM_CMD_PRIO; iCount++ )
+   {
+      link_asCmdQueue[ iCount ].iNumInQueue = 0;
+      link_asCmdQueue[ iCount ].iHead = LINK_NO_CMD_ENTRY;
+      link_asCmdQueue[ iCount ].iTail = LINK_NO_CMD_ENTRY;
+#if ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+      link_asCmdQueueStats[ iCount ].lNumCmds = 0;
+      link_asCmdQueueStats[ iCount ].lTotalDelayMs = 0;
+      link_asCmdQueueStats[ iCount ].lMaxDelayMs = 0;
+#endif
+   }
+   link_iNumCmdsInQueue = 0;
+
+   for( iCount = 0; iCount < LINK_MAX_NUM_CMDS_IN_Q; iCount++ )
+   {
+      link_asCmdEntry[ iCount ].iNext = iCount + 1;
+   }
+   link_asCmdEntry[ LINK_MAX_NUM_CMDS_IN_Q - 1 ].iNext = LINK_NO_CMD_ENTRY;
+   link_iFreeCmdEntry = 0;
+
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+   link_bNumLatencyObjects = 0;
+#endif
+
+   link_sRespQueue.iNumInQueue = 0;
+   link_sRespQueue.iQueueSize = LINK_MAX_NUM_RESP_IN_Q;
+   link_sRespQueue.iIndexMask = LINK_RESP_RING_SIZE - 1;
+   link_sRespQueue.iReadIndex = 0;
    link_sRespQueue.queue = link_psResponses;
 
    ABCC_MemCreatePool();
 
-   for( iCount = 0; iCount < LINK_MAX_NUM_CMDS_IN_Q; iCount++  )
+   for( iCount = 0; iCount < LINK_NUM_SRC_ID; iCount++  )
    {
       link_pnMsgHandler[ iCount ] = 0;
-      link_bMsgSrcId[iCount ] = 0;
    }
 
+   for( iCount = 0; iCount < LINK_SRC_ID_BITMAP_SIZE; iCount++  )
+   {
+      link_alSrcIdUsed[ iCount ] = 0;
+   }
+
+   link_iNumMsgHandlers = 0;
+
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+   for( iCount = 0; iCount < LINK_MAX_NUM_MSG_HDL; iCount++  )
+   {
+      link_asRespTmo[ iCount ].fActive = FALSE;
+      link_asRespTmo[ iCount ].fGrace = FALSE;
+   }
+
+   for( iCount = 0; iCount < LINK_NUM_SRC_ID; iCount++  )
+   {
+      link_abRespTmoIndex[ iCount ] = LINK_NO_RESP_TMO;
+   }
+
+   for( iCount = 0; iCount < LINK_SRC_ID_BITMAP_SIZE; iCount++  )
+   {
+      link_alSrcIdOutstanding[ iCount ] = 0;
+   }
+
+   link_iNumGraceTmo = 0;
+   link_fRespTmoTimerActive = FALSE;
+   link_fRespTmoExpired = FALSE;
+   link_xRespTmoHandle = ABCC_TimerCreate( link_RespTimerExpired );
+#endif
+
    /*
    ** Initialize driver privates and states to default values.
    */
-   link_bNumberOfOutstandingCommands = 0;
+   link_iNumberOfOutstandingCommands = 0;
 
    pnMsgSentHandler = NULL;
    link_psNotifyMsg = NULL;
@@ -185,7 +957,7 @@ void ABCC_LinkInit( void )
 ABP_MsgType* ABCC_LinkReadMessage( void )
 {
    ABCC_MsgType psReadMessage;
-   ABCC_PORT_UseCritical();
+   ABCC_PORT_LINK_UseCritical();
 
    psReadMessage.psMsg = pnABCC_DrvReadMessage();
 
@@ -196,11 +968,24 @@ ABP_MsgType* ABCC_LinkReadMessage( void )
          /*
          ** Decrement number of outstanding commands if a response is received
          */
-         ABCC_PORT_EnterCritical();
-         link_bNumberOfOutstandingCommands--;
-         ABCC_PORT_ExitCritical();
-         ABCC_LOG_DEBUG_MSG_GENERAL( "Outstanding commands: %" PRIu8 "\n",
-                                     link_bNumberOfOutstandingCommands );
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+         /*
+         ** The count has already been released if the command timed out while
+         ** queued or its grace period has ended.
+         */
+         if( link_ClearSrcIdOutstanding(
+                ABCC_GetLowAddrOct( psReadMessage.psMsg16->sHeader.iSourceIdDestObj ) ) )
+#endif
+         {
+            ABCC_PORT_LINK_EnterCritical();
+            if( link_iNumberOfOutstandingCommands > 0 )
+            {
+               link_iNumberOfOutstandingCommands--;
+            }
+            ABCC_PORT_LINK_ExitCritical();
+         }
+         ABCC_LOG_DEBUG_MSG_GENERAL( "Outstanding commands: %" PRIu16 "\n",
+                                     link_iNumberOfOutstandingCommands );
       }
    }
    return( psReadMessage.psMsg );
@@ -211,11 +996,16 @@ void ABCC_LinkCheckSendMessage( void )
 {
    BOOL fMsgWritten;
    ABP_MsgType* psWriteMessage;
-   ABCC_PORT_UseCritical();
+   UINT32 lNowMs = 0;
+   ABCC_PORT_LINK_UseCritical();
 
    psWriteMessage = NULL;
 
-   ABCC_PORT_EnterCritical();
+#if ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+   lNowMs = (UINT32)ABCC_TimerGetUptimeMs();
+#endif
+
+   ABCC_PORT_LINK_EnterCritical();
 
    /*
    ** Check that no other context are in progress with sending a message.
@@ -228,7 +1018,7 @@ void ABCC_LinkCheckSendMessage( void )
       ** If the queue index > 0 then there are messages in the queue.
       ** Response messages are prioritized over command messages.
       */
-      if( ( link_sRespQueue.bNumInQueue > 0 ) && pnABCC_DrvISReadyForWriteMessage() )
+      if( ( link_sRespQueue.iNumInQueue > 0 ) && pnABCC_DrvISReadyForWriteMessage() )
       {
          /*
          ** At this point it is sure that we will send a message. Lock the
@@ -238,11 +1028,11 @@ void ABCC_LinkCheckSendMessage( void )
          link_fDrvWriteMsgLock = TRUE;
          psWriteMessage = link_DeQueue( &link_sRespQueue );
          ABCC_LOG_DEBUG_MSG_EVENT( psWriteMessage, "Response dequeued: " );
-         ABCC_LOG_DEBUG_MSG_GENERAL( "RespQ status: %" PRIu8 "(%" PRIu8 ")\n",
-               link_sRespQueue.bNumInQueue,
-               link_sRespQueue.bQueueSize );
+         ABCC_LOG_DEBUG_MSG_GENERAL( "RespQ status: %" PRIu16 "(%" PRIu16 ")\n",
+               link_sRespQueue.iNumInQueue,
+               link_sRespQueue.iQueueSize );
       }
-      else if( ( link_sCmdQueue.bNumInQueue > 0 ) && pnABCC_DrvISReadyForCmd() )
+      else if( ( link_iNumCmdsInQueue > 0 ) && pnABCC_DrvISReadyForCmd() )
       {
          /*
          ** At this point it is sure that we will send a message. Lock the
@@ -250,111 +1040,363 @@ void ABCC_LinkCheckSendMessage( void )
          ** section.
          */
          link_fDrvWriteMsgLock = TRUE;
-         psWriteMessage = link_DeQueue( &link_sCmdQueue );
+         psWriteMessage = link_DeQueueCmd( lNowMs );
          ABCC_LOG_DEBUG_MSG_EVENT( psWriteMessage, "Command dequeued: " );
-         ABCC_LOG_DEBUG_MSG_GENERAL( "CmdQ status: %" PRIu8 "(%" PRIu8 ")\n",
-               link_sCmdQueue.bNumInQueue,
-               link_sCmdQueue.bQueueSize );
+         ABCC_LOG_DEBUG_MSG_GENERAL( "CmdQ status: %" PRIu16 "(%" PRIu16 ")\n",
+               link_iNumCmdsInQueue,
+               LINK_MAX_NUM_CMDS_IN_Q );
       }
    }
-   ABCC_PORT_ExitCritical();
+   ABCC_PORT_LINK_ExitCritical();
 
    if( psWriteMessage != NULL )
    {
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+      link_LatencyStamp( psWriteMessage, LINK_LATENCY_HAND_OFF );
+#endif
+
       /*
       ** Only call ABCC_DrvPrepareWriteMessage if it's implemented by the
       ** driver. Note that this function will not deliver the message to the
       ** ABCC just copy the message data to the memory.
       */
-      if( pnABCC_DrvPrepareWriteMessage != NULL )
+      ABCC_DrvPrepareWriteMessage( psWriteMessage );
+
+      ABCC_PORT_LINK_EnterCritical();
+      /*
+      ** Do the actual write of the message and unlock the driver to enable
+      ** use from other contexts. Both these actions need to be done within the
+      ** same critical section.
+      */
+      fMsgWritten = pnABCC_DrvWriteMessage( psWriteMessage );
+      link_fDrvWriteMsgLock = FALSE;
+      ABCC_PORT_LINK_ExitCritical();
+
+      if( fMsgWritten )
       {
-         pnABCC_DrvPrepareWriteMessage( psWriteMessage );
+         /*
+         ** The message was successfully written and can be deallocated now.
+         */
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+         link_LatencyStamp( psWriteMessage, LINK_LATENCY_SENT );
+#endif
+         ABCC_LOG_DEBUG_HEXDUMP_MSG_TX( psWriteMessage );
+         ABCC_LOG_DEBUG_MSG_CONTENT( psWriteMessage, "Msg sent\n" );
+         link_CheckNotification( psWriteMessage );
+         ABCC_LinkFree( &psWriteMessage );
       }
+   }
+}
+
+
+void ABCC_LinkRunDriverRx( void )
+{
+   ABP_MsgType* psSentMsg;
+
+   psSentMsg = pnABCC_DrvRunDriverRx();
+   /*
+   ** If a write message was sent, free the buffer.
+   */
+   if( psSentMsg )
+   {
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+      link_LatencyStamp( psSentMsg, LINK_LATENCY_SENT );
+#endif
+      ABCC_LOG_DEBUG_HEXDUMP_MSG_TX( psSentMsg );
+      ABCC_LOG_DEBUG_MSG_CONTENT( psSentMsg, "Msg sent\n" );
+      link_CheckNotification( psSentMsg );
+      ABCC_LinkFree( &psSentMsg );
+   }
+}
+
+
+UINT16 ABCC_LinkGetNumCmdQueueEntries( void )
+{
+   UINT16 iQEntries;
+   ABCC_PORT_LINK_UseCritical();
+
+   ABCC_PORT_LINK_EnterCritical();
+   iQEntries = 0;
+   if( link_iNumberOfOutstandingCommands < LINK_MAX_NUM_CMDS_IN_Q )
+   {
+      iQEntries = LINK_MAX_NUM_CMDS_IN_Q - link_iNumberOfOutstandingCommands;
+   }
+   ABCC_PORT_LINK_ExitCritical();
+
+   return( iQEntries );
+}
+
+
+BOOL ABCC_LinkIsSendPending( void )
+{
+   BOOL fPending;
+   ABCC_PORT_LINK_UseCritical();
+
+   ABCC_PORT_LINK_EnterCritical();
+   fPending = ( link_sRespQueue.iNumInQueue + link_iNumCmdsInQueue ) > 0;
+   ABCC_PORT_LINK_ExitCritical();
+
+   return( fPending );
+}
+
+
+/*------------------------------------------------------------------------------
+** Maps a source id to a response handler.
+** Must be called within the response handler critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    bSrcId          - Source id of the command.
+**    pnMsgHandler    - Response handler.
+**
+** Returns:
+**    FALSE if the maximum number of handlers are mapped or if the source id is
+**    already mapped.
+**------------------------------------------------------------------------------
+*/
+static BOOL link_MapMsgHandler( UINT8 bSrcId, ABCC_MsgHandlerFuncType pnMsgHandler )
+{
+   /*
+   ** A source id can only be mapped once, a second mapping would make the
+   ** response of one of the commands end up in the wrong handler. The same
+   ** goes for a timed out command that is still waiting for its response.
+   */
+   if( ( link_iNumMsgHandlers >= LINK_MAX_NUM_MSG_HDL ) ||
+       LINK_IS_SRC_ID_USED( bSrcId ) )
+   {
+      return( FALSE );
+   }
+
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+   /*
+   ** Each mapped handler and each grace period may need a timeout entry.
+   */
+   if( ( ( link_iNumMsgHandlers + link_iNumGraceTmo ) >= LINK_MAX_NUM_MSG_HDL ) ||
+       LINK_IS_SRC_ID_OUTSTANDING( bSrcId ) )
+   {
+      return( FALSE );
+   }
+#endif
+
+   link_pnMsgHandler[ bSrcId ] = pnMsgHandler;
+   link_alSrcIdUsed[ LINK_SRC_ID_WORD( bSrcId ) ] |= LINK_SRC_ID_MASK( bSrcId );
+   link_iNumMsgHandlers++;
+
+   return( TRUE );
+}
 
-      ABCC_PORT_EnterCritical();
-      /*
-      ** Do the actual write of the message and unlock the driver to enable
-      ** use from other contexts. Both these actions need to be done within the
-      ** same critical section.
-      */
-      fMsgWritten = pnABCC_DrvWriteMessage( psWriteMessage );
-      link_fDrvWriteMsgLock = FALSE;
-      ABCC_PORT_ExitCritical();
+/*------------------------------------------------------------------------------
+** Removes the response handler mapped to a source id.
+** Must be called within the response handler critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    bSrcId          - Source id of the command.
+**
+** Returns:
+**    The response handler, NULL if the source id is not mapped.
+**------------------------------------------------------------------------------
+*/
+static ABCC_MsgHandlerFuncType link_UnmapMsgHandler( UINT8 bSrcId )
+{
+   ABCC_MsgHandlerFuncType pnHandler = NULL;
 
-      if( fMsgWritten )
+   if( LINK_IS_SRC_ID_USED( bSrcId ) )
+   {
+      pnHandler = link_pnMsgHandler[ bSrcId ];
+      link_pnMsgHandler[ bSrcId ] = NULL;
+      link_alSrcIdUsed[ LINK_SRC_ID_WORD( bSrcId ) ] &= ~LINK_SRC_ID_MASK( bSrcId );
+      link_iNumMsgHandlers--;
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+      if( link_abRespTmoIndex[ bSrcId ] != LINK_NO_RESP_TMO )
       {
-         /*
-         ** The message was successfully written and can be deallocated now.
-         */
-         ABCC_LOG_DEBUG_HEXDUMP_MSG_TX( psWriteMessage );
-         ABCC_LOG_DEBUG_MSG_CONTENT( psWriteMessage, "Msg sent\n" );
-         link_CheckNotification( psWriteMessage );
-         ABCC_LinkFree( &psWriteMessage );
+         link_asRespTmo[ link_abRespTmoIndex[ bSrcId ] ].fActive = FALSE;
+         link_abRespTmoIndex[ bSrcId ] = LINK_NO_RESP_TMO;
       }
+#endif
    }
-}
 
+   return( pnHandler );
+}
 
-void ABCC_LinkRunDriverRx( void )
+/*------------------------------------------------------------------------------
+** Checks that the message data fits both the message channel and the message
+** buffer. A buffer from a small size class may be reused for a message with
+** more data than it has room for, see ABCC_GetMsgBufferSize().
+**------------------------------------------------------------------------------
+** Arguments:
+**    psWriteMsg      - Message to send.
+**
+** Returns:
+**    ABCC_EC_WRMSG_SIZE_ERR if the message is too large.
+**------------------------------------------------------------------------------
+*/
+static ABCC_ErrorCodeType link_CheckMsgSize( ABP_MsgType* psWriteMsg )
 {
-   ABP_MsgType* psSentMsg;
+   const UINT16 iDataSize = ABCC_GetMsgDataSize( psWriteMsg );
 
-   psSentMsg = pnABCC_DrvRunDriverRx();
-   /*
-   ** If a write message was sent, free the buffer.
-   */
-   if( psSentMsg )
+   if( iDataSize > link_iMaxMsgSize )
    {
-      ABCC_LOG_DEBUG_HEXDUMP_MSG_TX( psSentMsg );
-      ABCC_LOG_DEBUG_MSG_CONTENT( psSentMsg, "Msg sent\n" );
-      link_CheckNotification( psSentMsg );
-      ABCC_LinkFree( &psSentMsg );
+      ABCC_LOG_WARNING( ABCC_EC_WRMSG_SIZE_ERR, iDataSize,
+                        "Message size exceeds max size: %" PRIu16 "\n",
+                        iDataSize );
+      return( ABCC_EC_WRMSG_SIZE_ERR );
+   }
+
+   if( iDataSize > ABCC_MemGetBufferSize( psWriteMsg ) )
+   {
+      ABCC_LOG_WARNING( ABCC_EC_WRMSG_SIZE_ERR, iDataSize,
+                        "Message size exceeds buffer size: %" PRIu16 "\n",
+                        iDataSize );
+      return( ABCC_EC_WRMSG_SIZE_ERR );
    }
+
+   return( ABCC_EC_NO_ERROR );
 }
 
+/*------------------------------------------------------------------------------
+** Removes the response handlers of a batch of commands.
+**------------------------------------------------------------------------------
+** Arguments:
+**    pasCmds         - Commands.
+**    bNumMsgs        - Number of commands to remove the handlers for.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void link_UnmapMsgHandlers( const ABCC_CmdMsgBatchEntryType* pasCmds, UINT8 bNumMsgs )
+{
+   UINT8 bMsg;
+   ABCC_PORT_MSG_HANDLER_UseCritical();
 
-UINT16 ABCC_LinkGetNumCmdQueueEntries( void )
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   for( bMsg = 0; bMsg < bNumMsgs; bMsg++ )
+   {
+      (void)link_UnmapMsgHandler( ABCC_GetMsgSourceId( pasCmds[ bMsg ].psCmdMsg ) );
+   }
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
+}
+
+/*------------------------------------------------------------------------------
+** Maps the response handlers of a batch of commands. If one of the mappings
+** fails the ones already made are removed again.
+**------------------------------------------------------------------------------
+** Arguments:
+**    pasCmds         - Commands and their response handlers.
+**    bNumMsgs        - Number of commands.
+**
+** Returns:
+**    FALSE if not all handlers could be mapped.
+**------------------------------------------------------------------------------
+*/
+static BOOL link_MapMsgHandlers( const ABCC_CmdMsgBatchEntryType* pasCmds, UINT8 bNumMsgs )
 {
-   UINT16 iQEntries;
-   iQEntries =  LINK_MAX_NUM_CMDS_IN_Q - link_bNumberOfOutstandingCommands;
-   return( iQEntries );
+   UINT8 bNumMapped;
+   ABCC_PORT_MSG_HANDLER_UseCritical();
+
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   for( bNumMapped = 0; bNumMapped < bNumMsgs; bNumMapped++ )
+   {
+      if( !link_MapMsgHandler( ABCC_GetMsgSourceId( pasCmds[ bNumMapped ].psCmdMsg ),
+                               pasCmds[ bNumMapped ].pnMsgHandler ) )
+      {
+         break;
+      }
+   }
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
+
+   if( bNumMapped < bNumMsgs )
+   {
+      link_UnmapMsgHandlers( pasCmds, bNumMapped );
+      return( FALSE );
+   }
+
+   return( TRUE );
 }
 
+/*------------------------------------------------------------------------------
+** Checks a command of a batch before anything is mapped or queued.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psCmd           - Batch entry.
+**    bMsg            - Index of the entry, for the log.
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+static ABCC_ErrorCodeType link_CheckBatchEntry( const ABCC_CmdMsgBatchEntryType* psCmd, UINT8 bMsg )
+{
+   (void)bMsg;
+
+   if( ( psCmd->psCmdMsg == NULL ) ||
+       ( psCmd->pnMsgHandler == NULL ) ||
+       !ABCC_IsCmdMsg( psCmd->psCmdMsg ) ||
+       ( psCmd->bPriority >= ABCC_CFG_NUM_CMD_PRIO )
+#if !ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+       || ( psCmd->lTimeoutMs > 0 )
+#endif
+     )
+   {
+      ABCC_LOG_WARNING( ABCC_EC_PARAMETER_NOT_VALID, (UINT32)bMsg,
+                        "Batch entry %" PRIu8 " is not a valid command\n",
+                        bMsg );
+      return( ABCC_EC_PARAMETER_NOT_VALID );
+   }
+
+   return( link_CheckMsgSize( psCmd->psCmdMsg ) );
+}
 
-ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg )
+/*------------------------------------------------------------------------------
+** Sends a message immediately if possible, otherwise the message is queued.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psWriteMsg      - Message to send.
+**    bPriority       - Priority class if the message is a command.
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+static ABCC_ErrorCodeType link_WriteMessage( ABP_MsgType* psWriteMsg, UINT8 bPriority )
 {
    BOOL fSendMsg;
    BOOL fMsgWritten;
    ABCC_ErrorCodeType eErrorCode;
+   UINT32 lNowMs = 0;
 #if ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_WARNING_ENABLED
    UINT32 lAddErrorInfo;
 #endif
 
-   ABCC_PORT_UseCritical();
+   ABCC_PORT_LINK_UseCritical();
+
+   (void)lNowMs;
 
-   eErrorCode = ABCC_EC_NO_ERROR;
 #if ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_WARNING_ENABLED
    lAddErrorInfo = 0;
 #endif
    fSendMsg = FALSE;
 
-   if( ABCC_GetMsgDataSize( psWriteMsg ) > link_iMaxMsgSize )
+   eErrorCode = link_CheckMsgSize( psWriteMsg );
+   if( eErrorCode != ABCC_EC_NO_ERROR )
    {
-      eErrorCode = ABCC_EC_WRMSG_SIZE_ERR;
-      ABCC_LOG_WARNING( eErrorCode, iLeTOi( psWriteMsg->sHeader.iDataSize ),
-                        "Message size exceeds max size: %" PRIu16 "\n",
-                        iLeTOi( psWriteMsg->sHeader.iDataSize ) );
       return( eErrorCode );
    }
 
-   ABCC_PORT_EnterCritical();
+#if ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+   lNowMs = (UINT32)ABCC_TimerGetUptimeMs();
+#endif
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+   link_LatencyStamp( psWriteMsg, LINK_LATENCY_QUEUED );
+#endif
+
+   ABCC_PORT_LINK_EnterCritical();
 
    /*
    ** Check if it is possible to message immediately or if it has to be queued.
    */
    if( !ABCC_IsCmdMsg( psWriteMsg ) )
    {
-      if( !link_fDrvWriteMsgLock && ( link_sRespQueue.bNumInQueue == 0 ) && pnABCC_DrvISReadyForWriteMessage() )
+      if( !link_fDrvWriteMsgLock && ( link_sRespQueue.iNumInQueue == 0 ) && pnABCC_DrvISReadyForWriteMessage() )
       {
          /*
          ** At this point it is sure that we will send a message. Lock the
@@ -367,16 +1409,16 @@ ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg )
       else if( link_EnQueue( &link_sRespQueue, psWriteMsg ) )
       {
          ABCC_LOG_DEBUG_MSG_EVENT( psWriteMsg, "Response msg queued: " );
-         ABCC_LOG_DEBUG_MSG_GENERAL( "RespQ status: %" PRIu8 "(%" PRIu8 ")\n",
-               link_sRespQueue.bNumInQueue,
-               link_sRespQueue.bQueueSize );
+         ABCC_LOG_DEBUG_MSG_GENERAL( "RespQ status: %" PRIu16 "(%" PRIu16 ")\n",
+               link_sRespQueue.iNumInQueue,
+               link_sRespQueue.iQueueSize );
       }
       else
       {
          ABCC_LOG_DEBUG_MSG_EVENT( psWriteMsg, "Response queue full: " );
-         ABCC_LOG_DEBUG_MSG_GENERAL( "RespQ status: %" PRIu8 "(%" PRIu8 ")\n",
-               link_sRespQueue.bNumInQueue,
-               link_sRespQueue.bQueueSize );
+         ABCC_LOG_DEBUG_MSG_GENERAL( "RespQ status: %" PRIu16 "(%" PRIu16 ")\n",
+               link_sRespQueue.iNumInQueue,
+               link_sRespQueue.iQueueSize );
          eErrorCode = ABCC_EC_LINK_RESP_QUEUE_FULL;
 #if ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_WARNING_ENABLED
          lAddErrorInfo = (UINT32)psWriteMsg;
@@ -385,9 +1427,22 @@ ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg )
    }
    else
    {
-      if( !link_fDrvWriteMsgLock &&
-          ( ( link_sCmdQueue.bNumInQueue + link_sRespQueue.bNumInQueue ) == 0 ) &&
-          pnABCC_DrvISReadyForCmd() )
+      /*
+      ** A command may overtake queued commands of lower priority. Commands
+      ** that have timed out after being sent hold their command resource until
+      ** they are answered or their grace period ends.
+      */
+      if( link_iNumberOfOutstandingCommands >= LINK_MAX_NUM_CMDS_IN_Q )
+      {
+         ABCC_LOG_DEBUG_MSG_EVENT( psWriteMsg, "No command resource: " );
+         ABCC_LOG_DEBUG_MSG_GENERAL( "Outstanding commands: %" PRIu16 "\n",
+            link_iNumberOfOutstandingCommands );
+         eErrorCode = ABCC_EC_LINK_CMD_QUEUE_FULL;
+      }
+      else if( !link_fDrvWriteMsgLock &&
+               ( link_sRespQueue.iNumInQueue == 0 ) &&
+               !link_IsCmdQueued( bPriority ) &&
+               pnABCC_DrvISReadyForCmd() )
       {
          /*
          ** At this point it is sure that we will send a message. Lock the
@@ -396,29 +1451,39 @@ ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg )
          */
          fSendMsg = TRUE;
          link_fDrvWriteMsgLock = TRUE;
-         link_bNumberOfOutstandingCommands++;
+         link_iNumberOfOutstandingCommands++;
+#if ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+         link_AddCmdQueueDelay( bPriority, 0 );
+#endif
       }
-      else if( link_EnQueue( &link_sCmdQueue, psWriteMsg ) )
+      else if( link_EnQueueCmd( bPriority, psWriteMsg, lNowMs ) )
       {
          ABCC_LOG_DEBUG_MSG_EVENT( psWriteMsg, "Command queued: " );
-         ABCC_LOG_DEBUG_MSG_GENERAL( "CmdQ status: %" PRIu8 "(%" PRIu8 ")\n",
-            link_sCmdQueue.bNumInQueue,
-            link_sCmdQueue.bQueueSize );
+         ABCC_LOG_DEBUG_MSG_GENERAL( "CmdQ status: %" PRIu16 "(%" PRIu16 ")\n",
+            link_iNumCmdsInQueue,
+            LINK_MAX_NUM_CMDS_IN_Q );
 
-         link_bNumberOfOutstandingCommands++;
-         ABCC_LOG_DEBUG_MSG_GENERAL( "Outstanding commands: %" PRIu8 "\n",
-            link_bNumberOfOutstandingCommands );
+         link_iNumberOfOutstandingCommands++;
+         ABCC_LOG_DEBUG_MSG_GENERAL( "Outstanding commands: %" PRIu16 "\n",
+            link_iNumberOfOutstandingCommands );
       }
       else
       {
          ABCC_LOG_DEBUG_MSG_EVENT( psWriteMsg, "Command queue full: " );
-         ABCC_LOG_DEBUG_MSG_GENERAL( "CmdQ status: %" PRIu8 "(%" PRIu8 ")\n",
-            link_sCmdQueue.bNumInQueue,
-            link_sCmdQueue.bQueueSize );
+         ABCC_LOG_DEBUG_MSG_GENERAL( "CmdQ status: %" PRIu16 "(%" PRIu16 ")\n",
+            link_iNumCmdsInQueue,
+            LINK_MAX_NUM_CMDS_IN_Q );
          eErrorCode = ABCC_EC_LINK_CMD_QUEUE_FULL;
       }
+
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+      if( eErrorCode == ABCC_EC_NO_ERROR )
+      {
+         link_SetSrcIdOutstanding( ABCC_GetMsgSourceId( psWriteMsg ) );
+      }
+#endif
    }
-   ABCC_PORT_ExitCritical();
+   ABCC_PORT_LINK_ExitCritical();
 
    if( eErrorCode == ABCC_EC_NO_ERROR )
    {
@@ -435,17 +1500,18 @@ ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg )
    */
    if( fSendMsg )
    {
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+      link_LatencyStamp( psWriteMsg, LINK_LATENCY_HAND_OFF );
+#endif
+
       /*
       ** Only call ABCC_DrvPrepareWriteMessage if it's implemented by the
       ** driver. Note that this function will not deliver the message to the
       ** ABCC just copy the message data to the memory.
       */
-      if( pnABCC_DrvPrepareWriteMessage != NULL )
-      {
-         pnABCC_DrvPrepareWriteMessage( psWriteMsg );
-      }
+      ABCC_DrvPrepareWriteMessage( psWriteMsg );
 
-      ABCC_PORT_EnterCritical();
+      ABCC_PORT_LINK_EnterCritical();
       /*
       ** Do the actual write of the message and unlock the driver to enable
       ** use from other contexts. Both these actions need to be done within the
@@ -453,13 +1519,16 @@ ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg )
       */
       fMsgWritten = pnABCC_DrvWriteMessage( psWriteMsg );
       link_fDrvWriteMsgLock = FALSE;
-      ABCC_PORT_ExitCritical();
+      ABCC_PORT_LINK_ExitCritical();
 
       if( fMsgWritten )
       {
          /*
          ** The message was successfully written and can be deallocated now.
          */
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+         link_LatencyStamp( psWriteMsg, LINK_LATENCY_SENT );
+#endif
          ABCC_LOG_DEBUG_HEXDUMP_MSG_TX( psWriteMsg );
          ABCC_LOG_DEBUG_MSG_CONTENT( psWriteMsg, "Msg sent\n" );
          link_CheckNotification( psWriteMsg );
@@ -479,6 +1548,246 @@ ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg )
    return( eErrorCode );
 }
 
+ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg )
+{
+   return( link_WriteMessage( psWriteMsg, 0 ) );
+}
+
+ABCC_ErrorCodeType ABCC_LinkWriteCmdMessage( ABP_MsgType* psWriteMsg,
+                                             UINT8 bPriority )
+{
+   return( link_WriteMessage( psWriteMsg, bPriority ) );
+}
+
+ABCC_ErrorCodeType ABCC_LinkWriteCmdMessages( const ABCC_CmdMsgBatchEntryType* pasCmds,
+                                              UINT8 bNumMsgs )
+{
+   ABCC_ErrorCodeType eErrorCode = ABCC_EC_NO_ERROR;
+   ABP_MsgType* psCmdMsg;
+   UINT32 lNowMs = 0;
+   UINT8 bMsg;
+   ABCC_PORT_LINK_UseCritical();
+
+   (void)lNowMs;
+
+   if( bNumMsgs == 0 )
+   {
+      return( ABCC_EC_NO_ERROR );
+   }
+
+   if( pasCmds == NULL )
+   {
+      ABCC_LOG_WARNING( ABCC_EC_PARAMETER_NOT_VALID, 0, "No command batch\n" );
+      return( ABCC_EC_PARAMETER_NOT_VALID );
+   }
+
+   for( bMsg = 0; bMsg < bNumMsgs; bMsg++ )
+   {
+      eErrorCode = link_CheckBatchEntry( &pasCmds[ bMsg ], bMsg );
+      if( eErrorCode != ABCC_EC_NO_ERROR )
+      {
+         return( eErrorCode );
+      }
+   }
+
+#if ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+   lNowMs = (UINT32)ABCC_TimerGetUptimeMs();
+#endif
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+   for( bMsg = 0; bMsg < bNumMsgs; bMsg++ )
+   {
+      link_LatencyStamp( pasCmds[ bMsg ].psCmdMsg, LINK_LATENCY_QUEUED );
+   }
+#endif
+
+   /*
+   ** Reserve the command resources of the whole batch before any handler is
+   ** mapped or timer started, so that nothing has to be undone if they are
+   ** not available. A queued command holds one resource, so the queue has
+   ** room for the batch once the resources are reserved.
+   */
+   ABCC_PORT_LINK_EnterCritical();
+   if( ( link_iNumberOfOutstandingCommands + bNumMsgs ) > LINK_MAX_NUM_CMDS_IN_Q )
+   {
+      eErrorCode = ABCC_EC_LINK_CMD_QUEUE_FULL;
+   }
+   else
+   {
+      link_iNumberOfOutstandingCommands += bNumMsgs;
+   }
+   ABCC_PORT_LINK_ExitCritical();
+
+   if( eErrorCode != ABCC_EC_NO_ERROR )
+   {
+      /*
+      ** As for a single command the buffers are freed if the queue is full.
+      */
+      for( bMsg = 0; bMsg < bNumMsgs; bMsg++ )
+      {
+         psCmdMsg = pasCmds[ bMsg ].psCmdMsg;
+         ABCC_LinkFree( &psCmdMsg );
+      }
+
+      ABCC_LOG_WARNING( eErrorCode,
+         (UINT32)bNumMsgs,
+         "Failed to send command batch (Error code: %d, commands: %" PRIu8 ")\n",
+         eErrorCode,
+         bNumMsgs );
+      return( eErrorCode );
+   }
+
+   if( !link_MapMsgHandlers( pasCmds, bNumMsgs ) )
+   {
+      ABCC_PORT_LINK_EnterCritical();
+      link_iNumberOfOutstandingCommands -= bNumMsgs;
+      ABCC_PORT_LINK_ExitCritical();
+
+      ABCC_LOG_WARNING( ABCC_EC_NO_RESOURCES,
+         (UINT32)bNumMsgs,
+         "No resources available to map the response handlers of %" PRIu8 " commands\n",
+         bNumMsgs );
+      return( ABCC_EC_NO_RESOURCES );
+   }
+
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+   for( bMsg = 0; bMsg < bNumMsgs; bMsg++ )
+   {
+      if( pasCmds[ bMsg ].lTimeoutMs > 0 )
+      {
+         ABCC_LinkStartRespTimer( pasCmds[ bMsg ].psCmdMsg, pasCmds[ bMsg ].lTimeoutMs );
+      }
+   }
+#endif
+
+   ABCC_PORT_LINK_EnterCritical();
+   for( bMsg = 0; bMsg < bNumMsgs; bMsg++ )
+   {
+      (void)link_EnQueueCmd( pasCmds[ bMsg ].bPriority, pasCmds[ bMsg ].psCmdMsg, lNowMs );
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+      link_SetSrcIdOutstanding( ABCC_GetMsgSourceId( pasCmds[ bMsg ].psCmdMsg ) );
+#endif
+      ABCC_LOG_DEBUG_MSG_EVENT( pasCmds[ bMsg ].psCmdMsg, "Command queued: " );
+   }
+   ABCC_LOG_DEBUG_MSG_GENERAL( "CmdQ status: %" PRIu16 "(%" PRIu16 ")\n",
+      link_iNumCmdsInQueue,
+      LINK_MAX_NUM_CMDS_IN_Q );
+   ABCC_PORT_LINK_ExitCritical();
+
+   for( bMsg = 0; bMsg < bNumMsgs; bMsg++ )
+   {
+      ABCC_MemSetBufferStatus( pasCmds[ bMsg ].psCmdMsg, ABCC_MEM_BUFSTAT_SENT );
+   }
+
+   /*
+   ** Start the transmission of the first queued message, the rest are sent on
+   ** the following ABCC write message events.
+   */
+   ABCC_LinkCheckSendMessage();
+
+   return( ABCC_EC_NO_ERROR );
+}
+
+#if ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+BOOL ABCC_LinkGetCmdQueueStats( UINT8 bPriority,
+                                ABCC_CmdQueueStatsType* psStats )
+{
+   ABCC_PORT_LINK_UseCritical();
+
+   if( bPriority >= ABCC_CFG_NUM_CMD_PRIO )
+   {
+      return( FALSE );
+   }
+
+   ABCC_PORT_LINK_EnterCritical();
+   *psStats = link_asCmdQueueStats[ bPriority ];
+   ABCC_PORT_LINK_ExitCritical();
+
+   return( TRUE );
+}
+#endif
+
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+void ABCC_LinkLatencyRespReceived( const ABP_MsgType* psRespMsg )
+{
+   const ABP_MsgHeaderType16* psHeader = (const ABP_MsgHeaderType16*)psRespMsg;
+   const UINT32* plStamp;
+   ABCC_LatencyStatsType* psStats;
+   UINT32 alLatency[ ABCC_LATENCY_NUM_PHASES ];
+   UINT32 lLatency;
+   UINT32 lNow;
+   UINT8 bPhase;
+   UINT8 bBucket;
+   ABCC_PORT_LINK_UseCritical();
+
+   lNow = link_LatencyNow();
+   plStamp = link_alLatencyStamp[ ABCC_GetLowAddrOct( psHeader->iSourceIdDestObj ) ];
+
+   for( bPhase = 0; bPhase < ABCC_LATENCY_NUM_PHASES; bPhase++ )
+   {
+      if( bPhase < ( ABCC_LATENCY_NUM_PHASES - 1 ) )
+      {
+         alLatency[ bPhase ] = plStamp[ bPhase + 1 ] - plStamp[ bPhase ];
+      }
+      else
+      {
+         alLatency[ bPhase ] = lNow - plStamp[ bPhase ];
+      }
+   }
+
+   ABCC_PORT_LINK_EnterCritical();
+   psStats = link_GetLatencyStats( ABCC_GetHighAddrOct( psHeader->iSourceIdDestObj ), TRUE );
+   if( psStats != NULL )
+   {
+      psStats->lNumCmds++;
+
+      for( bPhase = 0; bPhase < ABCC_LATENCY_NUM_PHASES; bPhase++ )
+      {
+         /*
+         ** Bucket n holds latencies from 2^(n-1) up to 2^n time units.
+         */
+         lLatency = alLatency[ bPhase ];
+         bBucket = 0;
+         while( ( lLatency > 0 ) && ( bBucket < ( ABCC_LATENCY_NUM_BUCKETS - 1 ) ) )
+         {
+            lLatency >>= 1;
+            bBucket++;
+         }
+
+         psStats->aalHistogram[ bPhase ][ bBucket ]++;
+
+         if( alLatency[ bPhase ] > psStats->alMax[ bPhase ] )
+         {
+            psStats->alMax[ bPhase ] = alLatency[ bPhase ];
+         }
+      }
+   }
+   ABCC_PORT_LINK_ExitCritical();
+}
+
+BOOL ABCC_LinkGetLatencyStats( UINT8 bObject,
+                               ABCC_LatencyStatsType* psStats,
+                               BOOL fReset )
+{
+   ABCC_LatencyStatsType* psObjStats;
+   ABCC_PORT_LINK_UseCritical();
+
+   ABCC_PORT_LINK_EnterCritical();
+   psObjStats = link_GetLatencyStats( bObject, FALSE );
+   if( psObjStats != NULL )
+   {
+      *psStats = *psObjStats;
+
+      if( fReset )
+      {
+         link_ClearLatencyStats( psObjStats );
+      }
+   }
+   ABCC_PORT_LINK_ExitCritical();
+
+   return( psObjStats != NULL );
+}
+#endif
+
 ABCC_ErrorCodeType ABCC_LinkWrMsgWithNotification( ABP_MsgType* psWriteMsg,
                                                    ABCC_LinkNotifyIndType pnHandler )
 {
@@ -517,63 +1826,180 @@ void ABCC_LinkFree( ABP_MsgType** ppsBuffer )
 
 ABCC_ErrorCodeType ABCC_LinkMapMsgHandler( UINT8 bSrcId, ABCC_MsgHandlerFuncType  pnMSgHandler )
 {
-   UINT16 iIndex;
    ABCC_ErrorCodeType eResult = ABCC_EC_NO_RESOURCES;
-   ABCC_PORT_UseCritical();
+   ABCC_PORT_MSG_HANDLER_UseCritical();
 
-   /*
-   ** Find free spot.
-   */
-   ABCC_PORT_EnterCritical();
-   for( iIndex = 0; iIndex < LINK_MAX_NUM_MSG_HDL; iIndex++ )
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   if( link_MapMsgHandler( bSrcId, pnMSgHandler ) )
    {
-      if( link_pnMsgHandler[ iIndex ] == 0 )
-      {
-         link_pnMsgHandler[ iIndex ] = pnMSgHandler;
-         link_bMsgSrcId[ iIndex ] = bSrcId;
-         eResult = ABCC_EC_NO_ERROR;
-         break;
-      }
+      eResult = ABCC_EC_NO_ERROR;
    }
-   ABCC_PORT_ExitCritical();
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
    return( eResult );
 }
 
 ABCC_MsgHandlerFuncType ABCC_LinkGetMsgHandler( UINT8 bSrcId )
 {
-   UINT16 iIndex;
-   ABCC_MsgHandlerFuncType pnHandler = NULL;
-   ABCC_PORT_UseCritical();
+   ABCC_MsgHandlerFuncType pnHandler;
+   ABCC_PORT_MSG_HANDLER_UseCritical();
 
    /*
    ** Find message handler. If not found return NULL.
    */
-   ABCC_PORT_EnterCritical();
-   for( iIndex = 0; iIndex < LINK_MAX_NUM_MSG_HDL; iIndex++ )
-   {
-      if( ( link_pnMsgHandler[ iIndex ] != NULL ) && ( link_bMsgSrcId[ iIndex ] == bSrcId ) )
-      {
-         pnHandler = link_pnMsgHandler[ iIndex ];
-         link_pnMsgHandler[ iIndex ] = NULL;
-         break;
-      }
-   }
-   ABCC_PORT_ExitCritical();
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   pnHandler = link_UnmapMsgHandler( bSrcId );
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
    return( pnHandler );
 }
 
 BOOL ABCC_LinkIsSrcIdUsed( UINT8 bSrcId )
 {
-   BOOL fFound = FALSE;
-   UINT16 iIndex;
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+   return( LINK_IS_SRC_ID_USED( bSrcId ) || LINK_IS_SRC_ID_OUTSTANDING( bSrcId ) );
+#else
+   return( LINK_IS_SRC_ID_USED( bSrcId ) );
+#endif
+}
+
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+void ABCC_LinkStartRespTimer( const ABP_MsgType* psCmdMsg, UINT32 lTimeoutMs )
+{
+   BOOL fStartTimer;
+   ABCC_PORT_MSG_HANDLER_UseCritical();
+
+   /*
+   ** Each mapped response handler and each grace period has at most one
+   ** timeout, so a free entry is always available.
+   */
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   fStartTimer = link_AddRespTmo( (const ABP_MsgHeaderType16*)psCmdMsg, lTimeoutMs, FALSE );
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
+
+   if( fStartTimer )
+   {
+      ABCC_TimerStart( link_xRespTmoHandle, lTimeoutMs );
+   }
+}
+
+void ABCC_LinkCheckRespTimeouts( void )
+{
+   ABP_MsgHeaderType16 sCmdHeader;
+   UINT32 lNowMs;
+   INT32 lTimeLeftMs;
+   INT32 lNextTmoMs = 0;
+   BOOL fExpired;
+   BOOL fReclaimed;
+   BOOL fStartTimer = FALSE;
+   BOOL fRetry = FALSE;
+   UINT16 iNumReclaimed = 0;
+   UINT8 bSrcId;
+   UINT8 bIndex;
+   ABCC_PORT_LINK_UseCritical();
+   ABCC_PORT_MSG_HANDLER_UseCritical();
+
+   if( !link_SwapRespTmoExpired( FALSE ) )
+   {
+      return;
+   }
+
+   /*
+   ** The timer has expired. All timeouts are checked below and the timer is
+   ** restarted for the earliest remaining deadline.
+   */
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   link_fRespTmoTimerActive = FALSE;
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
+
+   lNowMs = (UINT32)ABCC_TimerGetUptimeMs();
 
-   for( iIndex = 0; iIndex < LINK_MAX_NUM_MSG_HDL; iIndex++ )
+   for( bIndex = 0; bIndex < LINK_MAX_NUM_MSG_HDL; bIndex++ )
    {
-      if( ( link_pnMsgHandler[ iIndex ] != NULL ) && ( link_bMsgSrcId[ iIndex ] == bSrcId ) )
+      fExpired = FALSE;
+      fReclaimed = FALSE;
+
+      ABCC_PORT_MSG_HANDLER_EnterCritical();
+      if( link_asRespTmo[ bIndex ].fActive )
       {
-         fFound = TRUE;
-         break;
+         lTimeLeftMs = (INT32)( link_asRespTmo[ bIndex ].lDeadlineMs - lNowMs );
+
+         if( ( lTimeLeftMs <= 0 ) && link_asRespTmo[ bIndex ].fGrace )
+         {
+            /*
+            ** The grace period has ended without a response. The source id is
+            ** released here, together with the entry, so that a response
+            ** racing with this cannot release the count of a later command.
+            */
+            bSrcId = ABCC_GetLowAddrOct( link_asRespTmo[ bIndex ].sCmdHeader.iSourceIdDestObj );
+            link_alSrcIdOutstanding[ LINK_SRC_ID_WORD( bSrcId ) ] &= ~LINK_SRC_ID_MASK( bSrcId );
+            link_StopGraceTmo( bSrcId );
+            fReclaimed = TRUE;
+         }
+         else if( lTimeLeftMs <= 0 )
+         {
+            sCmdHeader = link_asRespTmo[ bIndex ].sCmdHeader;
+            fExpired = TRUE;
+         }
+         else if( !fStartTimer || ( lTimeLeftMs < lNextTmoMs ) )
+         {
+            lNextTmoMs = lTimeLeftMs;
+            fStartTimer = TRUE;
+         }
+      }
+      ABCC_PORT_MSG_HANDLER_ExitCritical();
+
+      if( fReclaimed )
+      {
+         iNumReclaimed++;
+         ABCC_LOG_WARNING( ABCC_EC_RESP_TIMEOUT,
+            (UINT32)bSrcId,
+            "Command resource of source id %" PRIu8 " released without response\n",
+            bSrcId );
+      }
+
+      if( fExpired && !link_HandleRespTimeout( &sCmdHeader ) )
+      {
+         fRetry = TRUE;
+      }
+   }
+
+   if( iNumReclaimed > 0 )
+   {
+      ABCC_PORT_LINK_EnterCritical();
+      link_iNumberOfOutstandingCommands -= iNumReclaimed;
+      ABCC_PORT_LINK_ExitCritical();
+   }
+
+   if( fRetry )
+   {
+      /*
+      ** No buffer for the timeout response, try again on the next call.
+      */
+      (void)link_SwapRespTmoExpired( TRUE );
+   }
+
+   if( fStartTimer )
+   {
+      ABCC_PORT_MSG_HANDLER_EnterCritical();
+      if( link_fRespTmoTimerActive &&
+          ( (INT32)( link_lRespTmoTimerDeadlineMs - ( lNowMs + (UINT32)lNextTmoMs ) ) <= 0 ) )
+      {
+         /*
+         ** A command sent during the check has already started the timer for
+         ** an earlier deadline.
+         */
+         fStartTimer = FALSE;
+      }
+      else
+      {
+         link_fRespTmoTimerActive = TRUE;
+         link_lRespTmoTimerDeadlineMs = lNowMs + (UINT32)lNextTmoMs;
+      }
+      ABCC_PORT_MSG_HANDLER_ExitCritical();
+
+      if( fStartTimer )
+      {
+         ABCC_TimerStart( link_xRespTmoHandle, (UINT32)lNextTmoMs );
       }
    }
-   return( fFound );
 }
+#endif
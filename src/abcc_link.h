@@ -50,6 +50,88 @@ EXTFUNC void ABCC_LinkRunDriverRx( void );
 */
 EXTFUNC ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg );
 
+/*------------------------------------------------------------------------------
+** Write command message to the driver. Same as ABCC_LinkWriteMessage() but if
+** the command has to be queued it is placed in the queue of the given priority
+** class.
+**------------------------------------------------------------------------------
+** Arguments:
+**          psWriteMsg:    Pointer to command message.
+**          bPriority:     Priority class, 0 to ABCC_CFG_NUM_CMD_PRIO - 1.
+**
+** Returns:
+**          ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_LinkWriteCmdMessage( ABP_MsgType* psWriteMsg,
+                                                     UINT8 bPriority );
+
+/*------------------------------------------------------------------------------
+** Maps the response handlers of a number of commands, starts their response
+** timeouts and queues the commands in one critical section, then starts the
+** transmission of the first queued message. Either all commands are queued or
+** none of them.
+**------------------------------------------------------------------------------
+** Arguments:
+**          pasCmds:        Array of commands.
+**          bNumMsgs:       Number of commands.
+**
+** Returns:
+**          ABCC_ErrorCodeType. If ABCC_EC_LINK_CMD_QUEUE_FULL is returned the
+**          buffers have been freed, for any other error they are still owned
+**          by the caller.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_LinkWriteCmdMessages( const ABCC_CmdMsgBatchEntryType* pasCmds,
+                                                      UINT8 bNumMsgs );
+
+#if ABCC_CFG_LATENCY_STATS_ENABLED
+/*------------------------------------------------------------------------------
+** Adds the latencies of a command to the statistics of its destination object.
+** Called when the response is routed to the response handler.
+**------------------------------------------------------------------------------
+** Arguments:
+**          psRespMsg:     Pointer to the response message.
+**
+** Returns:
+**          None
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_LinkLatencyRespReceived( const ABP_MsgType* psRespMsg );
+
+/*------------------------------------------------------------------------------
+** Get latency statistics of a destination object.
+**------------------------------------------------------------------------------
+** Arguments:
+**          bObject:       Destination object.
+**          psStats:       Pointer to the statistics to fill in.
+**          fReset:        TRUE to clear the statistics after reading.
+**
+** Returns:
+**          TRUE if statistics are kept for the object.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_LinkGetLatencyStats( UINT8 bObject,
+                                       ABCC_LatencyStatsType* psStats,
+                                       BOOL fReset );
+#endif
+
+#if ABCC_CFG_CMD_QUEUE_STATS_ENABLED
+/*------------------------------------------------------------------------------
+** Get command queueing delay statistics of a priority class.
+**------------------------------------------------------------------------------
+** Arguments:
+**          bPriority:     Priority class.
+**          psStats:       Statistics to fill in.
+**
+** Returns:
+**          TRUE if the priority class exists.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_LinkGetCmdQueueStats( UINT8 bPriority,
+                                        ABCC_CmdQueueStatsType* psStats );
+#endif
+
 /*------------------------------------------------------------------------------
 ** Provides number of queue entries left  in the command queue.
 **------------------------------------------------------------------------------
@@ -62,6 +144,18 @@ EXTFUNC ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg );
 */
 EXTFUNC UINT16 ABCC_LinkGetNumCmdQueueEntries( void );
 
+/*------------------------------------------------------------------------------
+** Checks if any message is queued, waiting to be sent.
+**------------------------------------------------------------------------------
+** Arguments:
+**          -
+**
+** Returns:
+**          TRUE if a message is queued.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_LinkIsSendPending( void );
+
 /*------------------------------------------------------------------------------
 ** Write message to the driver.  ABCC_MsgCmdStatus is returned.
 ** Note that if the message was sent successfully before returning from the function
@@ -101,7 +195,8 @@ EXTFUNC void ABCC_LinkFree( ABP_MsgType** ppsBuffer );
 **                         source id.
 **
 ** Returns:
-**          ABCC_ErrorCodeType
+**          ABCC_ErrorCodeType. ABCC_EC_NO_RESOURCES if the maximum number of
+**          handlers are mapped or if the source id is already mapped.
 **------------------------------------------------------------------------------
 */
 EXTFUNC ABCC_ErrorCodeType ABCC_LinkMapMsgHandler( UINT8 bSrcId, ABCC_MsgHandlerFuncType  pnMSgHandler );
@@ -131,6 +226,38 @@ EXTFUNC ABCC_MsgHandlerFuncType ABCC_LinkGetMsgHandler( UINT8 bSrcId );
 */
 EXTFUNC BOOL ABCC_LinkIsSrcIdUsed( UINT8 bSrcId );
 
+#if ABCC_CFG_CMD_RESP_TIMEOUT_ENABLED
+/*------------------------------------------------------------------------------
+** Starts the response timeout of a command. Must be called after the response
+** handler has been mapped ( ABCC_LinkMapMsgHandler() ) and before the command
+** is written. The timeout is stopped when the response handler is fetched
+** ( ABCC_LinkGetMsgHandler() ).
+**------------------------------------------------------------------------------
+** Arguments:
+**          psCmdMsg:      Command message.
+**          lTimeoutMs:    Timeout in ms.
+**
+** Returns:
+**          None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_LinkStartRespTimer( const ABP_MsgType* psCmdMsg, UINT32 lTimeoutMs );
+
+/*------------------------------------------------------------------------------
+** Handles commands whose response timeout has expired. The response handler
+** is called with an error response and the command resource is released.
+** Called from ABCC_RunDriver().
+**------------------------------------------------------------------------------
+** Arguments:
+**          None.
+**
+** Returns:
+**          None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_LinkCheckRespTimeouts( void );
+#endif
+
 /*------------------------------------------------------------------------------
 ** Receive read message if available
 **------------------------------------------------------------------------------
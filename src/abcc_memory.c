@@ -15,48 +15,137 @@
 #include "abcc_port.h"
 #include "abcc_log.h"
 
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+#if !defined( __STDC_VERSION__ ) || ( __STDC_VERSION__ < 201112L ) || defined( __STDC_NO_ATOMICS__ )
+#error "ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED requires a C11 compiler with <stdatomic.h>"
+#endif
+#include <stdatomic.h>
+#include <stddef.h>
+#endif
+
+#if ( ABCC_CFG_MEM_NUM_SMALL_MSG > 0 ) && ( ABCC_CFG_MEM_SMALL_MSG_SIZE >= ABCC_CFG_MAX_MSG_SIZE )
+#error "ABCC_CFG_MEM_SMALL_MSG_SIZE must be less than ABCC_CFG_MAX_MSG_SIZE"
+#endif
+
+#if ( ABCC_CFG_MEM_NUM_MEDIUM_MSG > 0 ) && ( ABCC_CFG_MEM_MEDIUM_MSG_SIZE >= ABCC_CFG_MAX_MSG_SIZE )
+#error "ABCC_CFG_MEM_MEDIUM_MSG_SIZE must be less than ABCC_CFG_MAX_MSG_SIZE"
+#endif
+
+#if ( ABCC_CFG_MEM_NUM_SMALL_MSG > 0 ) && ( ABCC_CFG_MEM_NUM_MEDIUM_MSG > 0 ) && \
+    ( ABCC_CFG_MEM_SMALL_MSG_SIZE >= ABCC_CFG_MEM_MEDIUM_MSG_SIZE )
+#error "ABCC_CFG_MEM_SMALL_MSG_SIZE must be less than ABCC_CFG_MEM_MEDIUM_MSG_SIZE"
+#endif
+
 /*
-** Set default value for maximum number of resources
+** Number of buffer size classes. The classes are ordered by increasing buffer
+** size and the last class always holds buffers of ABCC_CFG_MAX_MSG_SIZE.
 */
-#ifndef ABCC_CFG_MAX_NUM_MSG_RESOURCES
-#define ABCC_CFG_MAX_NUM_MSG_RESOURCES          ( ABCC_CFG_MAX_NUM_APPL_CMDS + ABCC_CFG_MAX_NUM_ABCC_CMDS )
-#endif
+#define ABCC_MEM_NUM_CLASSES ( 1 + ( ABCC_CFG_MEM_NUM_SMALL_MSG > 0 ) + ( ABCC_CFG_MEM_NUM_MEDIUM_MSG > 0 ) )
 
 /*
 ** Magic cookie
 */
 #define ABCC_MEM_MAGIC_COOKIE  0x5CC5
 
+/*
+** Management information of a buffer in a given size class.
+*/
+#define ABCC_MEM_TRAILER( psPool, pxBuf ) \
+   ( (ABCC_MemTrailerType*)( (UINT8*)(pxBuf) + (psPool)->iStride - sizeof( ABCC_MemTrailerType ) ) )
+
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+#if ( ABCC_CFG_MAX_NUM_MSG_RESOURCES >= 0xFFFF ) || \
+    ( ABCC_CFG_MEM_NUM_SMALL_MSG >= 0xFFFF ) ||     \
+    ( ABCC_CFG_MEM_NUM_MEDIUM_MSG >= 0xFFFF )
+#error "The number of buffers in each size class must be less than 0xFFFF in lock-free pool mode"
+#endif
+
+/*
+** Free list head helpers. The head is a 32 bit word with the index of the
+** first free buffer in the low 16 bits and a modification tag in the high 16
+** bits.
+*/
+#define ABCC_MEM_FREE_LIST_END                  0xFFFF
+#define ABCC_MEM_HEAD_INDEX( lHead )            ( (UINT16)( (lHead) & 0xFFFF ) )
+#define ABCC_MEM_HEAD_TAG( lHead )              ( (UINT16)( (lHead) >> 16 ) )
+#define ABCC_MEM_HEAD( iTag, iIndex )           ( ( (UINT32)(UINT16)(iTag) << 16 ) | (UINT32)(iIndex) )
+
+/*
+** Buffer status of a trailer, for relaxed atomic accesses. The address is
+** computed from the offset since the trailer is a packed struct.
+*/
+#define ABCC_MEM_STATUS( psTrailer ) \
+   ( (_Atomic UINT16*)( (UINT8*)(psTrailer) + offsetof( ABCC_MemTrailerType, iBufferStatus ) ) )
+#endif
+
 /*------------------------------------------------------------------------------
-** Structure for defining size of memory message allocation
+** Management information placed directly after the data area of each buffer.
 **
 ** The magic cookie field is used to evaluate if the buffer status field
 ** is broken. The buffer status could be broken if the user writes outside the
 ** bounds of the message data area.
+**
+** With leak tracking enabled the trailer also holds the call site and uptime
+** of the allocation.
+**
+** The buffer status is atomic in lock-free mode, since ABCC_MemFree() then
+** writes it without a lock, see ABCC_MemGetBufferStatus().
 **------------------------------------------------------------------------------
 */
 typedef struct
 {
-   ABP_MsgHeaderType16 sHeader;
-   UINT32   alData[ ( ABCC_CFG_MAX_MSG_SIZE + 3 ) >> 2 ];
    UINT16   iMagicCookie;
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+   _Atomic UINT16 iBufferStatus;
+#else
    UINT16   iBufferStatus;
+#endif
+#if ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED
+   const char* pcAllocFile;
+   UINT32   lAllocLine;
+   UINT64   lAllocTimeMs;
+#endif
 }
-PACKED_STRUCT ABCC_MemAllocType;
+PACKED_STRUCT ABCC_MemTrailerType;
 
 /*------------------------------------------------------------------------------
-** Union used for casting between memory ABCC_MemAllocType and ABP_MsgType.
+** Structures for defining size of memory message allocation, one per size
+** class.
 **------------------------------------------------------------------------------
 */
-typedef union
+typedef struct
+{
+   ABP_MsgHeaderType16 sHeader;
+   UINT32   alData[ ( ABCC_CFG_MAX_MSG_SIZE + 3 ) >> 2 ];
+   ABCC_MemTrailerType sTrailer;
+}
+PACKED_STRUCT ABCC_MemAllocType;
+
+#if ABCC_CFG_MEM_NUM_SMALL_MSG > 0
+typedef struct
 {
-   ABCC_MemAllocType* psAllocMsg;
-   ABP_MsgType* psMsg;
+   ABP_MsgHeaderType16 sHeader;
+   UINT32   alData[ ( ABCC_CFG_MEM_SMALL_MSG_SIZE + 3 ) >> 2 ];
+   ABCC_MemTrailerType sTrailer;
 }
-ABCC_MemAllocUnion;
+PACKED_STRUCT ABCC_MemAllocSmallType;
+#endif
+
+#if ABCC_CFG_MEM_NUM_MEDIUM_MSG > 0
+typedef struct
+{
+   ABP_MsgHeaderType16 sHeader;
+   UINT32   alData[ ( ABCC_CFG_MEM_MEDIUM_MSG_SIZE + 3 ) >> 2 ];
+   ABCC_MemTrailerType sTrailer;
+}
+PACKED_STRUCT ABCC_MemAllocMediumType;
+#endif
 
 /*------------------------------------------------------------------------------
-** Memory pool structure
+** Memory pool structure, one per size class.
+**
+** In the default mode each class keeps a stack of pointers to its free
+** buffers:
 **
 ** ------------------
 ** iNumFreeMsg = 3  |
@@ -73,105 +162,587 @@ ABCC_MemAllocUnion;
 ** ------------------         |
 ** Msg 2            |<--------|
 ** ------------------
+**
+** In lock-free mode the free buffers are instead linked through
+** paiFreeListNext[], indexed by the position of the buffer in the class.
+** lFreeListHead holds the index of the first free buffer together with a tag
+** that is incremented on every successful update of the head. The tag makes a
+** compare-and-swap based on a stale head fail even if the same buffer has been
+** allocated and returned in between (the ABA problem).
 **------------------------------------------------------------------------------
 */
-static UINT16 abcc_iNumFreeMsg;
-static ABCC_MemAllocUnion abcc_uFreeMsgStack[ ABCC_CFG_MAX_NUM_MSG_RESOURCES ];
+typedef struct
+{
+   UINT8*         pbBuffers;        /* First buffer of the class. */
+   UINT16         iBufferSize;      /* Size of the message data area in octets. */
+   UINT16         iStride;          /* Size of one buffer including header and trailer. */
+   UINT16         iNumBuffers;      /* Number of buffers in the class. */
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+   _Atomic UINT32 lFreeListHead;
+   _Atomic UINT16* paiFreeListNext;
+   _Atomic UINT16 iNumUsed;
+   _Atomic UINT16 iMaxNumUsed;
+   _Atomic UINT32 lNumAllocFailures;
+#else
+   UINT16         iNumFreeMsg;
+   ABP_MsgType**  ppsFreeMsgStack;
+   UINT16         iMaxNumUsed;
+   UINT32         lNumAllocFailures;
+#endif
+}
+abcc_MemPoolType;
+
 static ABCC_MemAllocType  abcc_asMsgPool[ ABCC_CFG_MAX_NUM_MSG_RESOURCES ];
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+static _Atomic UINT16     abcc_aiFreeListNext[ ABCC_CFG_MAX_NUM_MSG_RESOURCES ];
+#else
+static ABP_MsgType*       abcc_apsFreeMsgStack[ ABCC_CFG_MAX_NUM_MSG_RESOURCES ];
+#endif
 
-void ABCC_MemCreatePool( void )
+#if ABCC_CFG_MEM_NUM_SMALL_MSG > 0
+static ABCC_MemAllocSmallType abcc_asSmallMsgPool[ ABCC_CFG_MEM_NUM_SMALL_MSG ];
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+static _Atomic UINT16     abcc_aiSmallFreeListNext[ ABCC_CFG_MEM_NUM_SMALL_MSG ];
+#else
+static ABP_MsgType*       abcc_apsSmallFreeMsgStack[ ABCC_CFG_MEM_NUM_SMALL_MSG ];
+#endif
+#endif
+
+#if ABCC_CFG_MEM_NUM_MEDIUM_MSG > 0
+static ABCC_MemAllocMediumType abcc_asMediumMsgPool[ ABCC_CFG_MEM_NUM_MEDIUM_MSG ];
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+static _Atomic UINT16     abcc_aiMediumFreeListNext[ ABCC_CFG_MEM_NUM_MEDIUM_MSG ];
+#else
+static ABP_MsgType*       abcc_apsMediumFreeMsgStack[ ABCC_CFG_MEM_NUM_MEDIUM_MSG ];
+#endif
+#endif
+
+static abcc_MemPoolType abcc_asPool[ ABCC_MEM_NUM_CLASSES ];
+
+/*------------------------------------------------------------------------------
+** Initializes one size class of the pool.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psPool          - Pool to initialize.
+**    pbBuffers       - First buffer of the class.
+**    iBufferSize     - Size of the message data area in octets.
+**    iStride         - Size of one buffer including header and trailer.
+**    iNumBuffers     - Number of buffers in the class.
+**    pxFreeList      - Free stack (default mode) or free list (lock-free mode)
+**                      storage with room for iNumBuffers entries.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void InitPool( abcc_MemPoolType* psPool,
+                      UINT8* pbBuffers,
+                      UINT16 iBufferSize,
+                      UINT16 iStride,
+                      UINT16 iNumBuffers,
+                      void* pxFreeList )
 {
+   ABCC_MemTrailerType* psTrailer;
    UINT16 i;
 
-   abcc_iNumFreeMsg = ABCC_CFG_MAX_NUM_MSG_RESOURCES;
+   psPool->pbBuffers = pbBuffers;
+   psPool->iBufferSize = iBufferSize;
+   psPool->iStride = iStride;
+   psPool->iNumBuffers = iNumBuffers;
+
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+   psPool->paiFreeListNext = (_Atomic UINT16*)pxFreeList;
+#else
+   psPool->ppsFreeMsgStack = (ABP_MsgType**)pxFreeList;
+   psPool->iNumFreeMsg = iNumBuffers;
+#endif
 
-   for( i = 0; i < ABCC_CFG_MAX_NUM_MSG_RESOURCES; i++ )
+   for( i = 0; i < iNumBuffers; i++ )
    {
-      abcc_uFreeMsgStack[ i ].psAllocMsg = &abcc_asMsgPool[ i ];
-      abcc_asMsgPool[ i ].iMagicCookie = ABCC_MEM_MAGIC_COOKIE;
-      abcc_asMsgPool[ i ].iBufferStatus = ABCC_MEM_BUFSTAT_FREE;
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+      atomic_store_explicit( &psPool->paiFreeListNext[ i ],
+                             ( i + 1 < iNumBuffers ) ? (UINT16)( i + 1 ) : ABCC_MEM_FREE_LIST_END,
+                             memory_order_relaxed );
+#else
+      psPool->ppsFreeMsgStack[ i ] = (ABP_MsgType*)( pbBuffers + (UINT32)i * iStride );
+#endif
+      psTrailer = ABCC_MEM_TRAILER( psPool, pbBuffers + (UINT32)i * iStride );
+      psTrailer->iMagicCookie = ABCC_MEM_MAGIC_COOKIE;
+      psTrailer->iBufferStatus = ABCC_MEM_BUFSTAT_FREE;
    }
+
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+   atomic_store_explicit( &psPool->iNumUsed, 0, memory_order_relaxed );
+   atomic_store_explicit( &psPool->iMaxNumUsed, 0, memory_order_relaxed );
+   atomic_store_explicit( &psPool->lNumAllocFailures, 0, memory_order_relaxed );
+   atomic_store( &psPool->lFreeListHead, ABCC_MEM_HEAD( 0, 0 ) );
+#else
+   psPool->iMaxNumUsed = 0;
+   psPool->lNumAllocFailures = 0;
+#endif
 }
 
-ABP_MsgType* ABCC_MemAlloc( void )
+/*------------------------------------------------------------------------------
+** Finds the size class a buffer belongs to.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psMsg           - Message buffer.
+**
+** Returns:
+**    Pool of the size class. Buffers outside the smaller classes are assumed to
+**    belong to the ABCC_CFG_MAX_MSG_SIZE class.
+**------------------------------------------------------------------------------
+*/
+static abcc_MemPoolType* GetPool( const ABP_MsgType* psMsg )
+{
+#if ( ABCC_MEM_NUM_CLASSES > 1 )
+   const UINT8* pbMsg = (const UINT8*)psMsg;
+   UINT16 i;
+
+   for( i = 0; i < ABCC_MEM_NUM_CLASSES - 1; i++ )
+   {
+      if( ( pbMsg >= abcc_asPool[ i ].pbBuffers ) &&
+          ( pbMsg < abcc_asPool[ i ].pbBuffers + (UINT32)abcc_asPool[ i ].iNumBuffers * abcc_asPool[ i ].iStride ) )
+      {
+         return( &abcc_asPool[ i ] );
+      }
+   }
+#else
+   (void)psMsg;
+#endif
+
+   return( &abcc_asPool[ ABCC_MEM_NUM_CLASSES - 1 ] );
+}
+
+/*------------------------------------------------------------------------------
+** Returns the management information of a buffer and checks that it has not
+** been overwritten.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psMsg           - Message buffer.
+**
+** Returns:
+**    Trailer of the message buffer.
+**------------------------------------------------------------------------------
+*/
+static ABCC_MemTrailerType* GetTrailer( const ABP_MsgType* psMsg )
+{
+   const abcc_MemPoolType* psPool = GetPool( psMsg );
+   ABCC_MemTrailerType* psTrailer;
+
+   psTrailer = ABCC_MEM_TRAILER( psPool, psMsg );
+
+   if( psTrailer->iMagicCookie != ABCC_MEM_MAGIC_COOKIE )
+   {
+      ABCC_LOG_FATAL( ABCC_EC_MSG_BUFFER_CORRUPTED,
+         (UINT32)psMsg,
+         "Message buffer corrupted: 0x%p\n",
+         (void*)psMsg );
+   }
+
+   return( psTrailer );
+}
+
+/*------------------------------------------------------------------------------
+** Allocates a buffer from one size class.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psPool          - Pool to allocate from.
+**
+** Returns:
+**    Pointer to allocated buffer. NULL if the class is empty.
+**------------------------------------------------------------------------------
+*/
+static ABP_MsgType* AllocFromPool( abcc_MemPoolType* psPool )
 {
    ABP_MsgType* pxItem = NULL;
-   ABCC_PORT_UseCritical();
-   ABCC_PORT_EnterCritical();
-   if( abcc_iNumFreeMsg > 0 )
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+   UINT32 lHead;
+   UINT32 lNewHead;
+   UINT16 iIndex;
+   UINT16 iNumUsed;
+   UINT16 iMaxNumUsed;
+
+   lHead = atomic_load_explicit( &psPool->lFreeListHead, memory_order_acquire );
+
+   do
    {
-      abcc_iNumFreeMsg--;
-      pxItem = abcc_uFreeMsgStack[ abcc_iNumFreeMsg ].psMsg;
-      ( (ABCC_MemAllocType*)pxItem )->iBufferStatus = ABCC_MEM_BUFSTAT_ALLOCATED;
+      iIndex = ABCC_MEM_HEAD_INDEX( lHead );
+
+      if( iIndex == ABCC_MEM_FREE_LIST_END )
+      {
+         break;
+      }
+
+      /*
+      ** The next index may be stale if another context has taken the buffer
+      ** in the meantime. The tag in the head guarantees that the exchange
+      ** below fails in that case.
+      */
+      lNewHead = ABCC_MEM_HEAD( ABCC_MEM_HEAD_TAG( lHead ) + 1,
+                                atomic_load_explicit( &psPool->paiFreeListNext[ iIndex ],
+                                                      memory_order_relaxed ) );
    }
+   while( !atomic_compare_exchange_weak_explicit( &psPool->lFreeListHead,
+                                                  &lHead,
+                                                  lNewHead,
+                                                  memory_order_acquire,
+                                                  memory_order_acquire ) );
 
-   ABCC_PORT_ExitCritical();
+   if( iIndex != ABCC_MEM_FREE_LIST_END )
+   {
+      pxItem = (ABP_MsgType*)( psPool->pbBuffers + (UINT32)iIndex * psPool->iStride );
+      atomic_store_explicit( ABCC_MEM_STATUS( ABCC_MEM_TRAILER( psPool, pxItem ) ),
+                             ABCC_MEM_BUFSTAT_ALLOCATED,
+                             memory_order_relaxed );
 
-   ABCC_LOG_DEBUG_MEM( "Mem: Buffer allocated: 0x%p\n", (void*)pxItem );
+      /*
+      ** The counter is incremented after the buffer has left the free list
+      ** and decremented in ABCC_MemFree() before it is put back, so it never
+      ** exceeds the number of buffers off the free list.
+      */
+      iNumUsed = atomic_fetch_add_explicit( &psPool->iNumUsed, 1, memory_order_relaxed ) + 1;
+      iMaxNumUsed = atomic_load_explicit( &psPool->iMaxNumUsed, memory_order_relaxed );
+
+      while( ( iNumUsed > iMaxNumUsed ) &&
+             !atomic_compare_exchange_weak_explicit( &psPool->iMaxNumUsed,
+                                                     &iMaxNumUsed,
+                                                     iNumUsed,
+                                                     memory_order_relaxed,
+                                                     memory_order_relaxed ) )
+      {
+      }
+   }
+   else
+   {
+      atomic_fetch_add_explicit( &psPool->lNumAllocFailures, 1, memory_order_relaxed );
+   }
+#else
+   ABCC_PORT_MEM_UseCritical();
+   ABCC_PORT_MEM_EnterCritical();
+   if( psPool->iNumFreeMsg > 0 )
+   {
+      psPool->iNumFreeMsg--;
+      pxItem = psPool->ppsFreeMsgStack[ psPool->iNumFreeMsg ];
+      ABCC_MEM_TRAILER( psPool, pxItem )->iBufferStatus = ABCC_MEM_BUFSTAT_ALLOCATED;
+
+      if( psPool->iNumBuffers - psPool->iNumFreeMsg > psPool->iMaxNumUsed )
+      {
+         psPool->iMaxNumUsed = psPool->iNumBuffers - psPool->iNumFreeMsg;
+      }
+   }
+   else
+   {
+      psPool->lNumAllocFailures++;
+   }
+
+   ABCC_PORT_MEM_ExitCritical();
+#endif
 
    return( pxItem );
 }
 
-void ABCC_MemFree( ABP_MsgType** pxItem )
+void ABCC_MemCreatePool( void )
 {
-   ABCC_MemAllocType* const psBuf = (ABCC_MemAllocType*)(*pxItem);
-   ABCC_PORT_UseCritical();
+   UINT16 iClass = 0;
 
-   ABCC_LOG_DEBUG_MEM( "Mem: Buffer returned:  0x%p\n", (void*)*pxItem );
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+#if ABCC_CFG_MEM_NUM_SMALL_MSG > 0
+   InitPool( &abcc_asPool[ iClass++ ], (UINT8*)abcc_asSmallMsgPool, ABCC_CFG_MEM_SMALL_MSG_SIZE,
+             sizeof( ABCC_MemAllocSmallType ), ABCC_CFG_MEM_NUM_SMALL_MSG, abcc_aiSmallFreeListNext );
+#endif
+#if ABCC_CFG_MEM_NUM_MEDIUM_MSG > 0
+   InitPool( &abcc_asPool[ iClass++ ], (UINT8*)abcc_asMediumMsgPool, ABCC_CFG_MEM_MEDIUM_MSG_SIZE,
+             sizeof( ABCC_MemAllocMediumType ), ABCC_CFG_MEM_NUM_MEDIUM_MSG, abcc_aiMediumFreeListNext );
+#endif
+   InitPool( &abcc_asPool[ iClass ], (UINT8*)abcc_asMsgPool, ABCC_CFG_MAX_MSG_SIZE,
+             sizeof( ABCC_MemAllocType ), ABCC_CFG_MAX_NUM_MSG_RESOURCES, abcc_aiFreeListNext );
+#else
+#if ABCC_CFG_MEM_NUM_SMALL_MSG > 0
+   InitPool( &abcc_asPool[ iClass++ ], (UINT8*)abcc_asSmallMsgPool, ABCC_CFG_MEM_SMALL_MSG_SIZE,
+             sizeof( ABCC_MemAllocSmallType ), ABCC_CFG_MEM_NUM_SMALL_MSG, abcc_apsSmallFreeMsgStack );
+#endif
+#if ABCC_CFG_MEM_NUM_MEDIUM_MSG > 0
+   InitPool( &abcc_asPool[ iClass++ ], (UINT8*)abcc_asMediumMsgPool, ABCC_CFG_MEM_MEDIUM_MSG_SIZE,
+             sizeof( ABCC_MemAllocMediumType ), ABCC_CFG_MEM_NUM_MEDIUM_MSG, abcc_apsMediumFreeMsgStack );
+#endif
+   InitPool( &abcc_asPool[ iClass ], (UINT8*)abcc_asMsgPool, ABCC_CFG_MAX_MSG_SIZE,
+             sizeof( ABCC_MemAllocType ), ABCC_CFG_MAX_NUM_MSG_RESOURCES, abcc_apsFreeMsgStack );
+#endif
+}
 
-   if( psBuf->iMagicCookie != ABCC_MEM_MAGIC_COOKIE )
+#if ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED
+ABP_MsgType* ABCC_MemAllocTracked( UINT16 iDataSize,
+                                   const char* pcFile,
+                                   int xLine )
+#else
+ABP_MsgType* ABCC_MemAlloc( UINT16 iDataSize )
+#endif
+{
+   ABP_MsgType* pxItem = NULL;
+   UINT16 i;
+
+   /*
+   ** Take the smallest buffer that fits. If that class is empty a buffer from
+   ** a larger class is used instead.
+   */
+   for( i = 0; i < ABCC_MEM_NUM_CLASSES; i++ )
    {
-      ABCC_LOG_FATAL( ABCC_EC_MSG_BUFFER_CORRUPTED,
-         (UINT32)psBuf,
-         "Message buffer corrupted: 0x%p\n",
-         (void*)psBuf );
+      if( abcc_asPool[ i ].iBufferSize >= iDataSize )
+      {
+         pxItem = AllocFromPool( &abcc_asPool[ i ] );
+
+         if( pxItem != NULL )
+         {
+            break;
+         }
+      }
+   }
+
+#if ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED
+   if( pxItem != NULL )
+   {
+      ABCC_MemTrailerType* const psTrailer = ABCC_MEM_TRAILER( GetPool( pxItem ), pxItem );
+
+      psTrailer->pcAllocFile = pcFile;
+      psTrailer->lAllocLine = (UINT32)xLine;
+      psTrailer->lAllocTimeMs = ABCC_GetUptimeMs();
+   }
+#endif
+
+   ABCC_LOG_DEBUG_MEM( "Mem: Buffer allocated: 0x%p\n", (void*)pxItem );
+
+   return( pxItem );
+}
+
+#if ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED
+ABP_MsgType* ABCC_MemAllocRxMsgTracked( BOOL fCmd,
+                                        UINT16 iDataSize,
+                                        const char* pcFile,
+                                        int xLine )
+#else
+ABP_MsgType* ABCC_MemAllocRxMsg( BOOL fCmd, UINT16 iDataSize )
+#endif
+{
+   /*
+   ** The response to a received command is built in the command buffer, and
+   ** its size is not known until the application has handled the command.
+   */
+   if( fCmd || ( iDataSize > ABCC_CFG_MAX_MSG_SIZE ) )
+   {
+      iDataSize = ABCC_CFG_MAX_MSG_SIZE;
    }
 
-   if( psBuf->iBufferStatus == ABCC_MEM_BUFSTAT_FREE )
+#if ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED
+   return( ABCC_MemAllocTracked( iDataSize, pcFile, xLine ) );
+#else
+   return( ABCC_MemAlloc( iDataSize ) );
+#endif
+}
+
+void ABCC_MemFree( ABP_MsgType** pxItem )
+{
+   abcc_MemPoolType* const psPool = GetPool( *pxItem );
+   ABCC_MemTrailerType* const psTrailer = GetTrailer( *pxItem );
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+   UINT32 lHead;
+   UINT32 lNewHead;
+   UINT16 iIndex;
+#else
+   ABCC_PORT_MEM_UseCritical();
+#endif
+
+   ABCC_LOG_DEBUG_MEM( "Mem: Buffer returned:  0x%p\n", (void*)*pxItem );
+
+   if( psTrailer->iBufferStatus == ABCC_MEM_BUFSTAT_FREE )
    {
       ABCC_LOG_FATAL( ABCC_EC_MSG_BUFFER_ALREADY_FREED,
-         (UINT32)psBuf,
+         (UINT32)*pxItem,
          "Message buffer already freed: 0x%p\n",
-         (void*)psBuf );
+         (void*)*pxItem );
    }
 
-   ABCC_PORT_EnterCritical();
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+   iIndex = (UINT16)( ( (UINT8*)*pxItem - psPool->pbBuffers ) / psPool->iStride );
+   atomic_store_explicit( ABCC_MEM_STATUS( psTrailer ),
+                          ABCC_MEM_BUFSTAT_FREE,
+                          memory_order_relaxed );
+   *pxItem = NULL;
+
+   atomic_fetch_sub_explicit( &psPool->iNumUsed, 1, memory_order_relaxed );
+
+   lHead = atomic_load_explicit( &psPool->lFreeListHead, memory_order_relaxed );
+
+   do
+   {
+      atomic_store_explicit( &psPool->paiFreeListNext[ iIndex ],
+                             ABCC_MEM_HEAD_INDEX( lHead ),
+                             memory_order_relaxed );
+      lNewHead = ABCC_MEM_HEAD( ABCC_MEM_HEAD_TAG( lHead ) + 1, iIndex );
+   }
+   while( !atomic_compare_exchange_weak_explicit( &psPool->lFreeListHead,
+                                                  &lHead,
+                                                  lNewHead,
+                                                  memory_order_release,
+                                                  memory_order_relaxed ) );
+#else
+   ABCC_PORT_MEM_EnterCritical();
 
-   abcc_uFreeMsgStack[ abcc_iNumFreeMsg ].psAllocMsg = psBuf;
-   abcc_iNumFreeMsg++;
-   psBuf->iBufferStatus = ABCC_MEM_BUFSTAT_FREE;
+   psPool->ppsFreeMsgStack[ psPool->iNumFreeMsg ] = *pxItem;
+   psPool->iNumFreeMsg++;
+   psTrailer->iBufferStatus = ABCC_MEM_BUFSTAT_FREE;
    *pxItem = NULL;
 
-   ABCC_PORT_ExitCritical();
+   ABCC_PORT_MEM_ExitCritical();
+#endif
 }
 
+UINT16 ABCC_MemGetBufferSize( ABP_MsgType* psMsg )
+{
+   return( GetPool( psMsg )->iBufferSize );
+}
+
+/*
+** The status is read by the driver after a response handler has returned, when
+** the handler may already have passed the buffer on to an application thread
+** that frees it. The status is therefore accessed in the same lock domain as
+** ABCC_MemFree() writes it, or atomically in lock-free mode.
+*/
 ABCC_MemBufferStatusType ABCC_MemGetBufferStatus( ABP_MsgType* psMsg )
 {
-   const ABCC_MemAllocType* const psBuf = (ABCC_MemAllocType*)psMsg;
+   ABCC_MemBufferStatusType eStatus;
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+   eStatus = (ABCC_MemBufferStatusType)atomic_load_explicit( ABCC_MEM_STATUS( GetTrailer( psMsg ) ),
+                                                             memory_order_relaxed );
+#else
+   ABCC_PORT_MEM_UseCritical();
 
-   if( psBuf->iMagicCookie != ABCC_MEM_MAGIC_COOKIE )
-   {
-      ABCC_LOG_FATAL( ABCC_EC_MSG_BUFFER_CORRUPTED,
-         (UINT32)psBuf,
-         "Message buffer corrupted: 0x%p\n",
-         (void*)psBuf );
-   }
+   ABCC_PORT_MEM_EnterCritical();
+   eStatus = (ABCC_MemBufferStatusType)GetTrailer( psMsg )->iBufferStatus;
+   ABCC_PORT_MEM_ExitCritical();
+#endif
 
-   return( (ABCC_MemBufferStatusType)psBuf->iBufferStatus );
+   return( eStatus );
 }
 
 void ABCC_MemSetBufferStatus( ABP_MsgType* psMsg,
                               ABCC_MemBufferStatusType eStatus )
 {
-   ABCC_MemAllocType* const psBuf = (ABCC_MemAllocType*)psMsg;
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+   atomic_store_explicit( ABCC_MEM_STATUS( GetTrailer( psMsg ) ),
+                          (UINT16)eStatus,
+                          memory_order_relaxed );
+#else
+   ABCC_PORT_MEM_UseCritical();
+
+   ABCC_PORT_MEM_EnterCritical();
+   GetTrailer( psMsg )->iBufferStatus = eStatus;
+   ABCC_PORT_MEM_ExitCritical();
+#endif
+}
+
+BOOL ABCC_MemGetStats( UINT8 bSizeClass, ABCC_MemStatsType* psStats )
+{
+   const abcc_MemPoolType* psPool;
+   UINT16 i;
+#if !ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+   ABCC_PORT_MEM_UseCritical();
+#endif
 
-   if( psBuf->iMagicCookie != ABCC_MEM_MAGIC_COOKIE )
+   if( bSizeClass >= ABCC_MEM_NUM_CLASSES )
    {
-      ABCC_LOG_FATAL( ABCC_EC_MSG_BUFFER_CORRUPTED,
-         (UINT32)psBuf,
-         "Message buffer corrupted: 0x%p\n",
-         (void*)psBuf );
+      return( FALSE );
+   }
+
+   psPool = &abcc_asPool[ bSizeClass ];
+
+   psStats->iBufferSize = psPool->iBufferSize;
+   psStats->iNumBuffers = psPool->iNumBuffers;
+
+#if ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED
+   psStats->iNumFree = psPool->iNumBuffers -
+                       atomic_load_explicit( &psPool->iNumUsed, memory_order_relaxed );
+   psStats->iMaxNumUsed = atomic_load_explicit( &psPool->iMaxNumUsed, memory_order_relaxed );
+   psStats->lNumAllocFailures = atomic_load_explicit( &psPool->lNumAllocFailures, memory_order_relaxed );
+#else
+   ABCC_PORT_MEM_EnterCritical();
+   psStats->iNumFree = psPool->iNumFreeMsg;
+   psStats->iMaxNumUsed = psPool->iMaxNumUsed;
+   psStats->lNumAllocFailures = psPool->lNumAllocFailures;
+   ABCC_PORT_MEM_ExitCritical();
+#endif
+
+   psStats->iNumAllocated = 0;
+   psStats->iNumInApplHandler = 0;
+   psStats->iNumSent = 0;
+   psStats->iNumOwned = 0;
+
+   for( i = 0; i < psPool->iNumBuffers; i++ )
+   {
+      switch( ABCC_MEM_TRAILER( psPool, psPool->pbBuffers + (UINT32)i * psPool->iStride )->iBufferStatus )
+      {
+      case ABCC_MEM_BUFSTAT_ALLOCATED:
+         psStats->iNumAllocated++;
+         break;
+
+      case ABCC_MEM_BUFSTAT_IN_APPL_HANDLER:
+         psStats->iNumInApplHandler++;
+         break;
+
+      case ABCC_MEM_BUFSTAT_SENT:
+         psStats->iNumSent++;
+         break;
+
+      case ABCC_MEM_BUFSTAT_OWNED:
+         psStats->iNumOwned++;
+         break;
+
+      default:
+         break;
+      }
    }
 
-   psBuf->iBufferStatus = eStatus;
+   return( TRUE );
 }
+
+#if ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED
+UINT16 ABCC_MemDumpLeaks( UINT32 lThresholdMs )
+{
+   const abcc_MemPoolType* psPool;
+   const ABCC_MemTrailerType* psTrailer;
+   const UINT8* pbBuffer;
+   UINT64 lNowMs;
+   UINT16 iNumLeaks = 0;
+   UINT16 iClass;
+   UINT16 i;
+
+   lNowMs = ABCC_GetUptimeMs();
+
+   for( iClass = 0; iClass < ABCC_MEM_NUM_CLASSES; iClass++ )
+   {
+      psPool = &abcc_asPool[ iClass ];
+
+      for( i = 0; i < psPool->iNumBuffers; i++ )
+      {
+         pbBuffer = psPool->pbBuffers + (UINT32)i * psPool->iStride;
+         psTrailer = ABCC_MEM_TRAILER( psPool, pbBuffer );
+
+         if( ( psTrailer->iBufferStatus != ABCC_MEM_BUFSTAT_FREE ) &&
+             ( lNowMs - psTrailer->lAllocTimeMs >= lThresholdMs ) )
+         {
+            ABCC_LOG_WARNING( ABCC_EC_MSG_BUFFER_LEAK,
+               (UINT32)pbBuffer,
+               "Message buffer 0x%p held for %" PRIu32 " ms, status %" PRIu16 ", allocated at %s:%" PRIu32 "\n",
+               (void*)pbBuffer,
+               (UINT32)( lNowMs - psTrailer->lAllocTimeMs ),
+               psTrailer->iBufferStatus,
+               psTrailer->pcAllocFile,
+               psTrailer->lAllocLine );
+            iNumLeaks++;
+         }
+      }
+   }
+
+   return( iNumLeaks );
+}
+#endif
@@ -42,17 +42,56 @@ ABCC_MemBufferStatusType;
 void ABCC_MemCreatePool( void );
 
 /*------------------------------------------------------------------------------
-** Allocates and return pointer to memory of predefined size
-** (ABCC_MemCreatePool)
+** Allocates and return pointer to a message buffer with room for at least
+** iDataSize octets of message data. The smallest size class that fits is used.
+** If that class is empty a buffer from a larger class is returned.
 **------------------------------------------------------------------------------
 ** Arguments:
-**    None
+**    iDataSize    - Required size of the message data area in octets.
+**
+** Returns:
+**    Pointer to allocated memory. NULL if no buffer of sufficient size is
+**    available.
+**
+** If ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED is set this is a macro that
+** records the calling file and line in the buffer.
+**------------------------------------------------------------------------------
+*/
+#if ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED
+EXTFUNC ABP_MsgType* ABCC_MemAllocTracked( UINT16 iDataSize,
+                                           const char* pcFile,
+                                           int xLine );
+#define ABCC_MemAlloc( iDataSize ) \
+   ABCC_MemAllocTracked( iDataSize, ABCC_FILE_IDENTIFIER, __LINE__ )
+#else
+EXTFUNC ABP_MsgType* ABCC_MemAlloc( UINT16 iDataSize );
+#endif
+
+/*------------------------------------------------------------------------------
+** Allocates a buffer for a message received from the ABCC. Used by the
+** operating mode drivers once the message header is known.
+** Received commands always get a buffer of ABCC_CFG_MAX_MSG_SIZE since the
+** response is built in the same buffer. Received responses get the smallest
+** buffer that fits the message data.
+**------------------------------------------------------------------------------
+** Arguments:
+**    fCmd         - TRUE if the received message is a command.
+**    iDataSize    - Data size of the received message in octets.
 **
 ** Returns:
-**    Pointer to allocated memory. NULL if pool is empty.
+**    Pointer to allocated memory. NULL if no buffer is available.
 **------------------------------------------------------------------------------
 */
-EXTFUNC ABP_MsgType* ABCC_MemAlloc( void );
+#if ABCC_CFG_DEBUG_MEM_LEAK_TRACKING_ENABLED
+EXTFUNC ABP_MsgType* ABCC_MemAllocRxMsgTracked( BOOL fCmd,
+                                                UINT16 iDataSize,
+                                                const char* pcFile,
+                                                int xLine );
+#define ABCC_MemAllocRxMsg( fCmd, iDataSize ) \
+   ABCC_MemAllocRxMsgTracked( fCmd, iDataSize, ABCC_FILE_IDENTIFIER, __LINE__ )
+#else
+EXTFUNC ABP_MsgType* ABCC_MemAllocRxMsg( BOOL fCmd, UINT16 iDataSize );
+#endif
 
 /*------------------------------------------------------------------------------
 ** Return memory to the pool. Note that it is important that the returned memory
@@ -67,6 +106,18 @@ EXTFUNC ABP_MsgType* ABCC_MemAlloc( void );
 */
 EXTFUNC void ABCC_MemFree( ABP_MsgType** pxItem );
 
+/*------------------------------------------------------------------------------
+** Get the size of the message data area of a buffer
+**------------------------------------------------------------------------------
+** Arguments:
+**    psMsg - Message buffer
+**
+** Returns:
+**    Size of the message data area in octets
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT16 ABCC_MemGetBufferSize( ABP_MsgType* psMsg );
+
 /*------------------------------------------------------------------------------
 ** Get the currently status of the memory buffer
 **------------------------------------------------------------------------------
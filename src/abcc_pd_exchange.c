@@ -0,0 +1,211 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Triple-buffered process data exchange.
+**
+** Each direction uses three image buffers. The producer owns one buffer which
+** it fills, the consumer owns one buffer which it reads and the third buffer
+** holds the latest complete image. Ownership is handed over by atomically
+** exchanging the index of the producer's or consumer's buffer with the index
+** of the latest buffer. Neither side ever waits for the other and the consumer
+** always sees a complete image.
+********************************************************************************
+*/
+
+#include "abcc_config.h"
+
+#if ABCC_CFG_PD_TRIPLE_BUFFER_ENABLED
+
+#if !defined( __STDC_VERSION__ ) || ( __STDC_VERSION__ < 201112L ) || defined( __STDC_NO_ATOMICS__ )
+#error "ABCC_CFG_PD_TRIPLE_BUFFER_ENABLED requires a C11 compiler with <stdatomic.h>"
+#endif
+#include <stdatomic.h>
+
+#include "abcc_types.h"
+#include "abcc.h"
+#include "abcc_pd_exchange.h"
+#include "abcc_port.h"
+
+/*
+** The index of the latest buffer is stored together with a flag telling that
+** the producer has published it after the consumer's last exchange.
+*/
+#define PD_EXCH_INDEX_MASK     ( 0x03 )
+#define PD_EXCH_NEW_IMAGE      ( 0x04 )
+
+/*
+** Image buffers are kept as 32 bit words to give the application a suitably
+** aligned image to map its process data structure onto.
+*/
+#define PD_EXCH_NUM_WORDS      ( ( ABCC_CFG_MAX_PROCESS_DATA_SIZE + 3 ) / 4 )
+
+/*------------------------------------------------------------------------------
+** Triple buffer of one process data direction.
+**
+** alImage:        Image buffers.
+** aiSize:         Size of the image in each buffer (in bytes).
+** bLatest:        Index of the latest buffer and PD_EXCH_NEW_IMAGE.
+** bProducer:      Index of the buffer owned by the producer.
+** bConsumer:      Index of the buffer owned by the consumer.
+**------------------------------------------------------------------------------
+*/
+typedef struct pd_exch_TripleBuffer
+{
+   UINT32        alImage[ 3 ][ PD_EXCH_NUM_WORDS ];
+   UINT16        aiSize[ 3 ];
+   _Atomic UINT8 bLatest;
+   UINT8         bProducer;
+   UINT8         bConsumer;
+}
+pd_exch_TripleBufferType;
+
+/*
+** Read process data, produced by the driver and consumed by the application.
+*/
+static pd_exch_TripleBufferType pd_exch_sReadPd;
+
+/*
+** Write process data, produced by the application and consumed by the driver.
+*/
+static pd_exch_TripleBufferType pd_exch_sWritePd;
+
+/*
+** Current process data sizes.
+*/
+static UINT16 pd_exch_iReadPdSize;
+static UINT16 pd_exch_iWritePdSize;
+
+static void pd_exch_Reset( pd_exch_TripleBufferType* psTb )
+{
+   psTb->aiSize[ 0 ] = 0;
+   psTb->aiSize[ 1 ] = 0;
+   psTb->aiSize[ 2 ] = 0;
+   psTb->bProducer = 0;
+   psTb->bConsumer = 1;
+   atomic_store( &psTb->bLatest, 2 );
+}
+
+/*------------------------------------------------------------------------------
+** Publishes the producer's buffer as the latest image and takes over the
+** previous latest buffer.
+**------------------------------------------------------------------------------
+*/
+static void pd_exch_Publish( pd_exch_TripleBufferType* psTb )
+{
+   UINT8 bOld;
+
+   bOld = atomic_exchange_explicit( &psTb->bLatest,
+                                    (UINT8)( psTb->bProducer | PD_EXCH_NEW_IMAGE ),
+                                    memory_order_acq_rel );
+   psTb->bProducer = bOld & PD_EXCH_INDEX_MASK;
+}
+
+/*------------------------------------------------------------------------------
+** Takes over the latest image if one has been published since the last call.
+**------------------------------------------------------------------------------
+** Returns:
+**    TRUE if the consumer's buffer now holds a new image.
+**------------------------------------------------------------------------------
+*/
+static BOOL pd_exch_Acquire( pd_exch_TripleBufferType* psTb )
+{
+   UINT8 bOld;
+
+   if( !( atomic_load_explicit( &psTb->bLatest, memory_order_relaxed ) & PD_EXCH_NEW_IMAGE ) )
+   {
+      return( FALSE );
+   }
+
+   bOld = atomic_exchange_explicit( &psTb->bLatest,
+                                    psTb->bConsumer,
+                                    memory_order_acq_rel );
+   psTb->bConsumer = bOld & PD_EXCH_INDEX_MASK;
+
+   return( TRUE );
+}
+
+void ABCC_PdExchangeInit( void )
+{
+   pd_exch_iReadPdSize = 0;
+   pd_exch_iWritePdSize = 0;
+   pd_exch_Reset( &pd_exch_sReadPd );
+   pd_exch_Reset( &pd_exch_sWritePd );
+}
+
+void ABCC_PdExchangeSetSize( UINT16 iReadPdSize, UINT16 iWritePdSize )
+{
+   if( iReadPdSize > ABCC_CFG_MAX_PROCESS_DATA_SIZE )
+   {
+      iReadPdSize = ABCC_CFG_MAX_PROCESS_DATA_SIZE;
+   }
+
+   if( iWritePdSize > ABCC_CFG_MAX_PROCESS_DATA_SIZE )
+   {
+      iWritePdSize = ABCC_CFG_MAX_PROCESS_DATA_SIZE;
+   }
+
+   pd_exch_iReadPdSize = iReadPdSize;
+   pd_exch_iWritePdSize = iWritePdSize;
+}
+
+void ABCC_PdExchangeNewReadPd( const void* pxReadPd )
+{
+   UINT8 bIndex;
+
+   bIndex = pd_exch_sReadPd.bProducer;
+   ABCC_PORT_MemCpy( pd_exch_sReadPd.alImage[ bIndex ], pxReadPd, pd_exch_iReadPdSize );
+   pd_exch_sReadPd.aiSize[ bIndex ] = pd_exch_iReadPdSize;
+   pd_exch_Publish( &pd_exch_sReadPd );
+}
+
+BOOL ABCC_PdExchangeUpdateWritePd( void* pxWritePd )
+{
+   if( !pd_exch_Acquire( &pd_exch_sWritePd ) )
+   {
+      return( FALSE );
+   }
+
+   ABCC_PORT_MemCpy( pxWritePd,
+                     pd_exch_sWritePd.alImage[ pd_exch_sWritePd.bConsumer ],
+                     pd_exch_iWritePdSize );
+
+   return( TRUE );
+}
+
+BOOL ABCC_PdGetLatestReadPd( const void** ppxReadPd, UINT16* piSize )
+{
+   BOOL fNew;
+
+   fNew = pd_exch_Acquire( &pd_exch_sReadPd );
+
+   *ppxReadPd = pd_exch_sReadPd.alImage[ pd_exch_sReadPd.bConsumer ];
+   *piSize = pd_exch_sReadPd.aiSize[ pd_exch_sReadPd.bConsumer ];
+
+   return( fNew );
+}
+
+void* ABCC_PdGetWriteBuffer( void )
+{
+   return( pd_exch_sWritePd.alImage[ pd_exch_sWritePd.bProducer ] );
+}
+
+void ABCC_PdPublishWritePd( void )
+{
+   UINT8 bPublished;
+
+   bPublished = pd_exch_sWritePd.bProducer;
+   pd_exch_Publish( &pd_exch_sWritePd );
+
+   /*
+   ** Carry the published image over to the new write buffer so that the
+   ** application only has to update the fields that change. The published
+   ** buffer is only read by the driver, never written.
+   */
+   ABCC_PORT_MemCpy( pd_exch_sWritePd.alImage[ pd_exch_sWritePd.bProducer ],
+                     pd_exch_sWritePd.alImage[ bPublished ],
+                     ABCC_CFG_MAX_PROCESS_DATA_SIZE );
+}
+
+#endif
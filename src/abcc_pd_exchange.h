@@ -0,0 +1,76 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Triple-buffered process data exchange between the driver and application
+** threads. See ABCC_CFG_PD_TRIPLE_BUFFER_ENABLED.
+********************************************************************************
+*/
+
+#ifndef ABCC_PD_EXCHANGE_H_
+#define ABCC_PD_EXCHANGE_H_
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+
+#if ABCC_CFG_PD_TRIPLE_BUFFER_ENABLED
+
+/*------------------------------------------------------------------------------
+** Init internal variables. Discards all read and write process data images.
+**------------------------------------------------------------------------------
+** Arguments:
+**       None.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_PdExchangeInit( void );
+
+/*------------------------------------------------------------------------------
+** Sets the process data sizes used when copying images to and from the
+** operating mode driver.
+**------------------------------------------------------------------------------
+** Arguments:
+**       iReadPdSize       - Size of the read process data (in bytes).
+**       iWritePdSize      - Size of the write process data (in bytes).
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_PdExchangeSetSize( UINT16 iReadPdSize, UINT16 iWritePdSize );
+
+/*------------------------------------------------------------------------------
+** Copies new read process data from the operating mode driver and publishes
+** it as the latest read process data image. Replaces the call to
+** ABCC_CbfNewReadPd().
+**------------------------------------------------------------------------------
+** Arguments:
+**       pxReadPd          - Pointer to the received process data.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_PdExchangeNewReadPd( const void* pxReadPd );
+
+/*------------------------------------------------------------------------------
+** Copies the latest write process data image published by the application to
+** the operating mode driver. Replaces the call to
+** ABCC_CbfUpdateWriteProcessData().
+**------------------------------------------------------------------------------
+** Arguments:
+**       pxWritePd         - Pointer to the process data to be sent.
+**
+** Returns:
+**       TRUE  - A new image has been copied to pxWritePd.
+**       FALSE - No image has been published since the last call.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_PdExchangeUpdateWritePd( void* pxWritePd );
+
+#endif
+
+#endif  /* inclusion lock */
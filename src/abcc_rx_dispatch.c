@@ -0,0 +1,190 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Handoff of received frames from the transfer context to the dispatch
+** context.
+**
+** The transfer context (ABCC_RunDriverTx()) is the only producer and the
+** dispatch context (ABCC_RunDriverRx()) the only consumer of a ring of
+** received frames. Each side only writes its own index, so the handoff needs
+** no lock. An entry holds the received message, a copy of the read process
+** data and the Anybus state, since the operating mode driver reuses its frame
+** buffer for the next transfer.
+********************************************************************************
+*/
+
+#include "abcc_config.h"
+
+#if ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED
+
+#if !defined( __STDC_VERSION__ ) || ( __STDC_VERSION__ < 201112L ) || defined( __STDC_NO_ATOMICS__ )
+#error "ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED requires a C11 compiler with <stdatomic.h>"
+#endif
+#include <stdatomic.h>
+
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc.h"
+#include "abcc_port.h"
+#include "abcc_hardware_abstraction.h"
+#include "abcc_driver_interface.h"
+#include "abcc_handler.h"
+#include "abcc_link.h"
+#include "abcc_rx_dispatch.h"
+
+#define RX_DISP_INDEX_MASK     ( ABCC_CFG_DRV_SPLIT_TX_RX_QUEUE_SIZE - 1 )
+
+/*
+** Process data copies are kept as 32 bit words to give the application a
+** suitably aligned image, as the driver frame buffers do.
+*/
+#define RX_DISP_PD_NUM_WORDS   ( ( ABCC_CFG_MAX_PROCESS_DATA_SIZE + 3 ) / 4 )
+
+/*------------------------------------------------------------------------------
+** Received frame.
+**
+** psMsg:          Received message, NULL if none.
+** fNewRdPd:       TRUE if alRdPd holds new read process data.
+** bAnbState:      Anybus state.
+** alRdPd:         Copy of the read process data.
+**------------------------------------------------------------------------------
+*/
+typedef struct rx_disp_Frame
+{
+   ABP_MsgType* psMsg;
+   BOOL         fNewRdPd;
+   UINT8        bAnbState;
+   UINT32       alRdPd[ RX_DISP_PD_NUM_WORDS ];
+}
+rx_disp_FrameType;
+
+static rx_disp_FrameType rx_disp_asFrame[ ABCC_CFG_DRV_SPLIT_TX_RX_QUEUE_SIZE ];
+
+/*
+** Free running indexes, written by the producer and consumer respectively.
+*/
+static _Atomic UINT16 rx_disp_iWriteIndex;
+static _Atomic UINT16 rx_disp_iReadIndex;
+
+/*
+** Anybus state of the last queued frame, used by the producer to skip frames
+** without any news.
+*/
+static UINT8 rx_disp_bAnbState;
+
+/*
+** Current read process data size.
+*/
+static UINT16 rx_disp_iReadPdSize;
+
+void ABCC_RxDispatchInit( void )
+{
+   rx_disp_iReadPdSize = 0;
+   rx_disp_bAnbState = 0xFF;
+   atomic_store( &rx_disp_iWriteIndex, 0 );
+   atomic_store( &rx_disp_iReadIndex, 0 );
+}
+
+void ABCC_RxDispatchSetPdSize( UINT16 iReadPdSize )
+{
+   if( iReadPdSize > ABCC_CFG_MAX_PROCESS_DATA_SIZE )
+   {
+      iReadPdSize = ABCC_CFG_MAX_PROCESS_DATA_SIZE;
+   }
+
+   rx_disp_iReadPdSize = iReadPdSize;
+}
+
+BOOL ABCC_RxDispatchIsFull( void )
+{
+   UINT16 iWriteIndex;
+   UINT16 iReadIndex;
+
+   iWriteIndex = atomic_load_explicit( &rx_disp_iWriteIndex, memory_order_relaxed );
+   iReadIndex = atomic_load_explicit( &rx_disp_iReadIndex, memory_order_acquire );
+
+   return( (UINT16)( iWriteIndex - iReadIndex ) >= ABCC_CFG_DRV_SPLIT_TX_RX_QUEUE_SIZE );
+}
+
+void ABCC_RxDispatchCapture( void )
+{
+   rx_disp_FrameType* psFrame;
+   void* pxRdPd;
+   UINT16 iWriteIndex;
+
+   if( ABCC_RxDispatchIsFull() )
+   {
+      /*
+      ** Not expected since no transfer is started while the queue is full.
+      ** The frame stays in the driver until the next call.
+      */
+      return;
+   }
+
+   iWriteIndex = atomic_load_explicit( &rx_disp_iWriteIndex, memory_order_relaxed );
+   psFrame = &rx_disp_asFrame[ iWriteIndex & RX_DISP_INDEX_MASK ];
+
+   psFrame->bAnbState = pnABCC_DrvGetAnybusState();
+   psFrame->fNewRdPd = FALSE;
+
+   pxRdPd = pnABCC_DrvReadProcessData();
+
+   if( ( pxRdPd != NULL ) &&
+       ( psFrame->bAnbState == ABP_ANB_STATE_PROCESS_ACTIVE ) )
+   {
+      ABCC_PORT_MemCpy( psFrame->alRdPd, pxRdPd, rx_disp_iReadPdSize );
+      psFrame->fNewRdPd = TRUE;
+   }
+
+   psFrame->psMsg = ABCC_LinkReadMessage();
+
+   if( ( psFrame->psMsg == NULL ) &&
+       !psFrame->fNewRdPd &&
+       ( psFrame->bAnbState == rx_disp_bAnbState ) )
+   {
+      return;
+   }
+
+   rx_disp_bAnbState = psFrame->bAnbState;
+   atomic_store_explicit( &rx_disp_iWriteIndex,
+                          (UINT16)( iWriteIndex + 1 ),
+                          memory_order_release );
+}
+
+void ABCC_RxDispatchExec( void )
+{
+   rx_disp_FrameType* psFrame;
+   UINT16 iReadIndex;
+
+   iReadIndex = atomic_load_explicit( &rx_disp_iReadIndex, memory_order_relaxed );
+
+   while( iReadIndex != atomic_load_explicit( &rx_disp_iWriteIndex, memory_order_acquire ) )
+   {
+      psFrame = &rx_disp_asFrame[ iReadIndex & RX_DISP_INDEX_MASK ];
+
+      if( psFrame->fNewRdPd )
+      {
+#if ABCC_CFG_SYNC_MEASUREMENT_OP_ENABLED
+         ABCC_HAL_GpioSet();
+#endif
+         ABCC_HandleNewReadPd( psFrame->alRdPd );
+#if ABCC_CFG_SYNC_MEASUREMENT_OP_ENABLED
+         ABCC_HAL_GpioReset();
+#endif
+      }
+
+      ABCC_HandleAnbState( psFrame->bAnbState );
+
+      if( psFrame->psMsg != NULL )
+      {
+         ABCC_HandleReceivedMessage( psFrame->psMsg );
+      }
+
+      iReadIndex++;
+      atomic_store_explicit( &rx_disp_iReadIndex, iReadIndex, memory_order_release );
+   }
+}
+
+#endif
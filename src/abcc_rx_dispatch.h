@@ -0,0 +1,87 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Handoff of received frames from the transfer context to the dispatch
+** context. See ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED.
+********************************************************************************
+*/
+
+#ifndef ABCC_RX_DISPATCH_H_
+#define ABCC_RX_DISPATCH_H_
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+
+#if ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED
+
+/*------------------------------------------------------------------------------
+** Init internal variables. Discards all queued frames.
+**------------------------------------------------------------------------------
+** Arguments:
+**       None.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_RxDispatchInit( void );
+
+/*------------------------------------------------------------------------------
+** Sets the size of the read process data copied for the dispatch context.
+**------------------------------------------------------------------------------
+** Arguments:
+**       iReadPdSize       - Size of the read process data (in bytes).
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_RxDispatchSetPdSize( UINT16 iReadPdSize );
+
+/*------------------------------------------------------------------------------
+** Checks if the queue has room for another received frame. Called from the
+** transfer context before a new transfer is started.
+**------------------------------------------------------------------------------
+** Arguments:
+**       None.
+**
+** Returns:
+**       TRUE  - The dispatch context is behind, no transfer shall be started.
+**       FALSE - A received frame can be queued.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_RxDispatchIsFull( void );
+
+/*------------------------------------------------------------------------------
+** Reads the received message, read process data and Anybus state from the
+** operating mode driver and queues them for the dispatch context. Replaces
+** the calls to ABCC_TriggerRdPdUpdate(), ABCC_TriggerAnbStatusUpdate() and
+** ABCC_TriggerReceiveMessage() in the transfer context.
+**------------------------------------------------------------------------------
+** Arguments:
+**       None.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_RxDispatchCapture( void );
+
+/*------------------------------------------------------------------------------
+** Dispatches all queued frames to the application. Called from the dispatch
+** context.
+**------------------------------------------------------------------------------
+** Arguments:
+**       None.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_RxDispatchExec( void );
+
+#endif
+
+#endif  /* inclusion lock */
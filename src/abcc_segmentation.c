@@ -14,13 +14,15 @@
 #include "abcc_log.h"
 #include "abcc_port.h"
 #include "abcc_segmentation.h"
-
-#ifndef ABCC_NUM_SEGMENTATION_SESSIONS
-#define ABCC_NUM_SEGMENTATION_SESSIONS 1
-#endif
+#include "abcc_timer.h"
 
 #define ABCC_MSG_HEADER_TYPE_SIZEOF 12
 
+/*
+** Marks the end of a hash chain or the free list.
+*/
+#define SEG_NO_SESSION 0xff
+
 /*------------------------------------------------------------------------------
 ** To determine if a command belongs to an existing segmentation session the
 ** the members of this struct must match the command that started the session.
@@ -41,27 +43,60 @@ typedef struct abcc_SegSessionIdentifiers
 abcc_SegSessionIdentifiersType;
 
 /*------------------------------------------------------------------------------
-** Segmentations session type
+** Source of the payload of a segmented message. The payload is either a
+** sequence of blocks, fetched with pnNext or taken from pasFragments, or read
+** at an offset with pnRead.
 **------------------------------------------------------------------------------
-**   pxData        - Pointer to abcc message payload
-**   pnDone        - Function to be called when segmentation session is done
-**   pxObject      - User defined object. Supplied as parameter in pnDone function.
-**   lBytesLeft    - Number of bytes left to be sent.
-**   lTotalMsgSize - Size of entire payload to be sent
-**   bRspCmdExt0   - Command extension 0 value to use in response segments.
-**   sIdentifiers  - Used to match commands with existing sessions.
-**   fInUse        - Indicates if the session is in use.
+**   pxData         - Current block of the payload.
+**   pxObject       - User defined object. Supplied as parameter in pnNext and
+**                    pnRead.
+**   pnNext         - Function to be called to fetch the next block, or NULL.
+**   pasFragments   - Fragments following the current block, or NULL.
+**   iFragmentsLeft - Number of entries left in pasFragments.
+**   pnRead         - Function to be called to read the payload, or NULL.
+**   lBytesLeft     - Number of bytes left of the current block. For pnRead
+**                    the number of bytes left of the entire payload.
+**   lDataBlockSize - Size of the current block. For pnRead the size of the
+**                    entire payload.
 **------------------------------------------------------------------------------
 */
-typedef struct abcc_SegSession
+typedef struct abcc_SegSource
 {
    const void* pxData;
    const void* pxObject;
-   ABCC_SegMsgHandlerDoneFuncType pnDone;
    ABCC_SegMsgHandlerNextBlockFuncType pnNext;
+   const ABCC_SegDataFragmentType* pasFragments;
+   UINT16 iFragmentsLeft;
+   ABCC_SegMsgHandlerReadFuncType pnRead;
    UINT32 lBytesLeft;
    UINT32 lDataBlockSize;
+}
+abcc_SegSourceType;
+
+/*------------------------------------------------------------------------------
+** Segmentations session type
+**------------------------------------------------------------------------------
+**   sSource         - Payload to be sent. sSource.pxObject is also supplied as
+**                     parameter in pnDone function.
+**   pnDone          - Function to be called when segmentation session is done
+**   lIdleDeadlineMs - Uptime when the session is closed if no further segment
+**                     command has been received.
+**   bRspCmdExt0     - Command extension 0 value to use in response segments.
+**   bNext           - Next session in the same hash chain, or in the free list
+**                     if the session is not in use.
+**   sIdentifiers    - Used to match commands with existing sessions.
+**   fInUse          - Indicates if the session is in use.
+**------------------------------------------------------------------------------
+*/
+typedef struct abcc_SegSession
+{
+   abcc_SegSourceType sSource;
+   ABCC_SegMsgHandlerDoneFuncType pnDone;
+#if ABCC_CFG_SEG_IDLE_TIMEOUT_MS > 0
+   UINT32 lIdleDeadlineMs;
+#endif
    UINT8 bRspCmdExt0;
+   UINT8 bNext;
    abcc_SegSessionIdentifiersType sIdentifiers;
    BOOL  fInUse;
 }
@@ -77,34 +112,183 @@ static UINT8 abcc_bSegNumUsedInst;
 ** Place holder for segmentation sessions
 **------------------------------------------------------------------------------
 */
-static abcc_SegSessionType abcc_sSegSession[ ABCC_NUM_SEGMENTATION_SESSIONS ];
+static abcc_SegSessionType abcc_sSegSession[ ABCC_CFG_NUM_SEGMENTATION_SESSIONS ];
+
+/*------------------------------------------------------------------------------
+** First session of each hash chain and of the list of free sessions.
+**------------------------------------------------------------------------------
+*/
+static UINT8 abcc_abSegHashHead[ ABCC_CFG_SEG_HASH_SIZE ];
+static UINT8 abcc_bSegFreeHead;
+
+/*------------------------------------------------------------------------------
+** Calculates the hash chain of a set of session identifiers.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psIdentifiers - Session identifiers.
+**
+** Returns:
+**    Index in abcc_abSegHashHead.
+**------------------------------------------------------------------------------
+*/
+static UINT16 SegSessionHash( const abcc_SegSessionIdentifiersType* psIdentifiers )
+{
+   UINT32 lHash;
+
+   lHash = (UINT32)psIdentifiers->bDestObj;
+   lHash = ( lHash * 31 ) ^ (UINT32)psIdentifiers->iInstance;
+   lHash = ( lHash * 31 ) ^ (UINT32)psIdentifiers->bCmd;
+   lHash = ( lHash * 31 ) ^ (UINT32)psIdentifiers->bCmdExt0;
+   lHash ^= lHash >> 8;
+
+   return( (UINT16)( lHash & ( ABCC_CFG_SEG_HASH_SIZE - 1 ) ) );
+}
+
+/*------------------------------------------------------------------------------
+** Reads the session identifiers of a message.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psMsg         - Pointer to ABCC message.
+**    psIdentifiers - Filled in with the identifiers.
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void GetSegSessionIdentifiers( const ABP_MsgType* psMsg,
+                                      abcc_SegSessionIdentifiersType* psIdentifiers )
+{
+   psIdentifiers->bDestObj = ABCC_GetMsgDestObj( psMsg );
+   psIdentifiers->iInstance = ABCC_GetMsgInstance( psMsg );
+   psIdentifiers->bCmd = ABCC_GetMsgCmdBits( psMsg );
+   psIdentifiers->bCmdExt0 = ABCC_GetMsgCmdExt0( psMsg );
+}
+
+/*------------------------------------------------------------------------------
+** Removes a session from its hash chain and returns it to the free list.
+** Must be called within a critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    bSession - Index of the session.
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void UnlinkSegmentationSession( UINT8 bSession )
+{
+   UINT8* pbLink;
+
+   pbLink = &abcc_abSegHashHead[ SegSessionHash( &abcc_sSegSession[ bSession ].sIdentifiers ) ];
+   while( *pbLink != bSession )
+   {
+      pbLink = &abcc_sSegSession[ *pbLink ].bNext;
+   }
+   *pbLink = abcc_sSegSession[ bSession ].bNext;
+
+   abcc_sSegSession[ bSession ].fInUse = FALSE;
+   abcc_sSegSession[ bSession ].bNext = abcc_bSegFreeHead;
+   abcc_bSegFreeHead = bSession;
+   abcc_bSegNumUsedInst--;
+}
 
+#if ABCC_CFG_SEG_IDLE_TIMEOUT_MS > 0
 /*------------------------------------------------------------------------------
-** Allocate segmentations instance
+** Closes all sessions that have been idle for ABCC_CFG_SEG_IDLE_TIMEOUT_MS and
+** calls their done callbacks.
 **------------------------------------------------------------------------------
 ** Arguments:
 **    None
 ** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void ExpireIdleSegmentationSessions( void )
+{
+   UINT16 iSession;
+   UINT32 lNowMs;
+   BOOL fExpired;
+#if ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_WARNING_ENABLED
+   UINT8 bDestObj = 0;
+#endif
+   ABCC_SegMsgHandlerDoneFuncType pnDone = NULL;
+   const void* pxObject = NULL;
+   ABCC_PORT_UseCritical();
+
+   lNowMs = (UINT32)ABCC_TimerGetUptimeMs();
+
+   for( iSession = 0; iSession < ABCC_CFG_NUM_SEGMENTATION_SESSIONS; iSession++ )
+   {
+      fExpired = FALSE;
+
+      ABCC_PORT_EnterCritical();
+      if( abcc_sSegSession[ iSession ].fInUse &&
+          ( (INT32)( lNowMs - abcc_sSegSession[ iSession ].lIdleDeadlineMs ) >= 0 ) )
+      {
+         fExpired = TRUE;
+#if ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_WARNING_ENABLED
+         bDestObj = abcc_sSegSession[ iSession ].sIdentifiers.bDestObj;
+#endif
+         pnDone = abcc_sSegSession[ iSession ].pnDone;
+         pxObject = abcc_sSegSession[ iSession ].sSource.pxObject;
+         UnlinkSegmentationSession( (UINT8)iSession );
+      }
+      ABCC_PORT_ExitCritical();
+
+      if( fExpired )
+      {
+         ABCC_LOG_WARNING( ABCC_EC_ERROR_RESP_SEGMENTATION,
+               bDestObj,
+               "Idle segmentation session closed (object: %" PRIu8 ")\n",
+               bDestObj );
+
+         if( pnDone != NULL )
+         {
+            pnDone( (void*)pxObject );
+         }
+      }
+   }
+}
+#endif
+
+/*------------------------------------------------------------------------------
+** Allocate segmentations instance and make it findable with the identifiers.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psIdentifiers - Identifiers of the request starting the session.
+** Returns:
 **    Pointer to abcc_SegInstanceType. NULL if no free resource is found
 **------------------------------------------------------------------------------
 */
-static abcc_SegSessionType* AllocSegmentationSession( void )
+static abcc_SegSessionType* AllocSegmentationSession( const abcc_SegSessionIdentifiersType* psIdentifiers )
 {
    UINT8 bSession;
+   UINT16 iHash;
    abcc_SegSessionType* psSegSession = NULL;
    ABCC_PORT_UseCritical();
 
+#if ABCC_CFG_SEG_IDLE_TIMEOUT_MS > 0
+   ExpireIdleSegmentationSessions();
+#endif
+
+   iHash = SegSessionHash( psIdentifiers );
+
    ABCC_PORT_EnterCritical();
 
-   for( bSession = 0; bSession < ABCC_NUM_SEGMENTATION_SESSIONS; bSession++ )
+   bSession = abcc_bSegFreeHead;
+   if( bSession != SEG_NO_SESSION )
    {
-      if( !abcc_sSegSession[ bSession ].fInUse )
-      {
-         abcc_bSegNumUsedInst++;
-         psSegSession = &abcc_sSegSession[ bSession ];
-         psSegSession->fInUse = TRUE;
-         break;
-      }
+      abcc_bSegNumUsedInst++;
+      psSegSession = &abcc_sSegSession[ bSession ];
+      abcc_bSegFreeHead = psSegSession->bNext;
+
+      psSegSession->sIdentifiers = *psIdentifiers;
+#if ABCC_CFG_SEG_IDLE_TIMEOUT_MS > 0
+      psSegSession->lIdleDeadlineMs = (UINT32)ABCC_TimerGetUptimeMs() + ABCC_CFG_SEG_IDLE_TIMEOUT_MS;
+#endif
+      psSegSession->bNext = abcc_abSegHashHead[ iHash ];
+      abcc_abSegHashHead[ iHash ] = bSession;
+      psSegSession->fInUse = TRUE;
    }
 
    ABCC_PORT_ExitCritical();
@@ -113,7 +297,8 @@ static abcc_SegSessionType* AllocSegmentationSession( void )
 }
 
 /*------------------------------------------------------------------------------
-** Find segmentation session with matching source id.
+** Find segmentation session with matching identifiers. The idle timeout of the
+** session is restarted.
 **------------------------------------------------------------------------------
 ** Arguments:
 **    psMsg - Pointer to ABCC message.
@@ -125,20 +310,38 @@ static abcc_SegSessionType* AllocSegmentationSession( void )
 static abcc_SegSessionType* FindSegmentationSession( const ABP_MsgType* psMsg )
 {
    UINT8 bSession;
+   abcc_SegSessionIdentifiersType sIdentifiers;
+   const abcc_SegSessionIdentifiersType* psSessionIds;
    abcc_SegSessionType* psSegSession = NULL;
+   UINT16 iHash;
+#if ABCC_CFG_SEG_IDLE_TIMEOUT_MS > 0
+   UINT32 lNowMs;
+#endif
    ABCC_PORT_UseCritical();
 
+   GetSegSessionIdentifiers( psMsg, &sIdentifiers );
+   iHash = SegSessionHash( &sIdentifiers );
+#if ABCC_CFG_SEG_IDLE_TIMEOUT_MS > 0
+   lNowMs = (UINT32)ABCC_TimerGetUptimeMs();
+#endif
+
    ABCC_PORT_EnterCritical();
 
-   for( bSession = 0; bSession < ABCC_NUM_SEGMENTATION_SESSIONS; bSession++ )
+   for( bSession = abcc_abSegHashHead[ iHash ];
+        bSession != SEG_NO_SESSION;
+        bSession = abcc_sSegSession[ bSession ].bNext )
    {
-      if( abcc_sSegSession[ bSession ].fInUse &&
-         ( abcc_sSegSession[ bSession ].sIdentifiers.bDestObj == ABCC_GetMsgDestObj( psMsg ) ) &&
-         ( abcc_sSegSession[ bSession ].sIdentifiers.iInstance == ABCC_GetMsgInstance( psMsg ) ) &&
-         ( abcc_sSegSession[ bSession ].sIdentifiers.bCmd == ABCC_GetMsgCmdBits( psMsg ) ) &&
-         ( abcc_sSegSession[ bSession ].sIdentifiers.bCmdExt0 == ABCC_GetMsgCmdExt0( psMsg ) ) )
+      psSessionIds = &abcc_sSegSession[ bSession ].sIdentifiers;
+
+      if( ( psSessionIds->bDestObj == sIdentifiers.bDestObj ) &&
+          ( psSessionIds->iInstance == sIdentifiers.iInstance ) &&
+          ( psSessionIds->bCmd == sIdentifiers.bCmd ) &&
+          ( psSessionIds->bCmdExt0 == sIdentifiers.bCmdExt0 ) )
       {
          psSegSession = &abcc_sSegSession[ bSession ];
+#if ABCC_CFG_SEG_IDLE_TIMEOUT_MS > 0
+         psSegSession->lIdleDeadlineMs = lNowMs + ABCC_CFG_SEG_IDLE_TIMEOUT_MS;
+#endif
          break;
       }
    }
@@ -163,114 +366,262 @@ static void FreeSegmentationSession( abcc_SegSessionType* psSegSession )
 
    ABCC_PORT_EnterCritical();
 
-   psSegSession->fInUse = FALSE;
-   abcc_bSegNumUsedInst--;
+   /*
+   ** The session may already have been closed by the idle timeout.
+   */
+   if( psSegSession->fInUse )
+   {
+      UnlinkSegmentationSession( (UINT8)( psSegSession - abcc_sSegSession ) );
+   }
 
    ABCC_PORT_ExitCritical();
 }
 
 /*------------------------------------------------------------------------------
-** Get next data block from callback if available
+** Init a payload source with a first block and an optional next block callback.
 **------------------------------------------------------------------------------
 ** Arguments:
-**    psSegSession - Pointer to segmentation instance
+**    psSource - Pointer to payload source
+**    pxData   - First block, or NULL.
+**    lSize    - Size of the first block.
+**    pnNext   - Callback to fetch the next block, or NULL.
+**    pxObject - User defined object.
 **
 ** Returns:
 **    None.
 **------------------------------------------------------------------------------
 */
-static void GetNextDataBlock( abcc_SegSessionType* psSegSession )
+static void InitSegSource( abcc_SegSourceType* psSource,
+                           const void* pxData,
+                           UINT32 lSize,
+                           ABCC_SegMsgHandlerNextBlockFuncType pnNext,
+                           const void* pxObject )
 {
-   if( psSegSession->pnNext != NULL )
+   psSource->lBytesLeft = lSize;
+   psSource->lDataBlockSize = lSize;
+   psSource->pxData = pxData;
+   psSource->pnNext = pnNext;
+   psSource->pasFragments = NULL;
+   psSource->iFragmentsLeft = 0;
+   psSource->pnRead = NULL;
+   psSource->pxObject = pxObject;
+}
+
+/*------------------------------------------------------------------------------
+** Get next data block from callback or fragment array if available
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSource - Pointer to payload source
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void GetNextDataBlock( abcc_SegSourceType* psSource )
+{
+   if( psSource->pnNext != NULL )
+   {
+      psSource->pxData = psSource->pnNext( (void*)psSource->pxObject,
+                                           &psSource->lDataBlockSize );
+
+      if( psSource->pxData == NULL )
+      {
+         psSource->lDataBlockSize = 0;
+      }
+
+      psSource->lBytesLeft = psSource->lDataBlockSize;
+   }
+   else if( psSource->pasFragments != NULL )
    {
-      psSegSession->pxData = psSegSession->pnNext( (void*)psSegSession->pxObject,
-                                                   &psSegSession->lDataBlockSize );
+      /*
+      ** Empty fragments are skipped since an empty block ends the payload.
+      */
+      psSource->pxData = NULL;
+      psSource->lDataBlockSize = 0;
 
-      if( psSegSession->pxData == NULL )
+      while( ( psSource->iFragmentsLeft > 0 ) && ( psSource->lDataBlockSize == 0 ) )
       {
-         psSegSession->lDataBlockSize = 0;
+         psSource->pxData = psSource->pasFragments->pxData;
+         psSource->lDataBlockSize = psSource->pasFragments->lSize;
+         psSource->pasFragments++;
+         psSource->iFragmentsLeft--;
       }
 
-      psSegSession->lBytesLeft = psSegSession->lDataBlockSize;
+      if( psSource->pxData == NULL )
+      {
+         psSource->lDataBlockSize = 0;
+      }
+
+      psSource->lBytesLeft = psSource->lDataBlockSize;
    }
 }
 
 /*------------------------------------------------------------------------------
-** Copy next segment to the abcc message and set the required segmentation bits.
+** Stops a payload source, the next segment will be empty and the last one.
 **------------------------------------------------------------------------------
 ** Arguments:
-**    psSegSession - Pointer to segmentation instance
+**    psSource - Pointer to payload source
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void StopSegSource( abcc_SegSourceType* psSource )
+{
+   psSource->lBytesLeft = 0;
+   psSource->pnNext = NULL;
+   psSource->pasFragments = NULL;
+   psSource->pnRead = NULL;
+}
+
+/*------------------------------------------------------------------------------
+** Let the read callback of a payload source fill the next segment directly in
+** the message.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSource     - Pointer to payload source
+**    psMsg        - Pointer to abcc message
+**
+** Returns:
+**    Size of the segment.
+**------------------------------------------------------------------------------
+*/
+static UINT16 ReadSegment( abcc_SegSourceType* psSource, ABP_MsgType* psMsg )
+{
+   UINT16 iSize;
+   UINT16 iRead;
+
+   iSize = ABCC_GetMaxMessageSize();
+   if( psSource->lBytesLeft < iSize )
+   {
+      iSize = (UINT16)psSource->lBytesLeft;
+   }
+
+   iRead = psSource->pnRead( (void*)psSource->pxObject,
+                             psSource->lDataBlockSize - psSource->lBytesLeft,
+                             ABCC_GetMsgDataPtr( psMsg ),
+                             iSize );
+
+   /*
+   ** A short read ends the payload.
+   */
+   if( iRead < iSize )
+   {
+      psSource->lBytesLeft = 0;
+   }
+   else
+   {
+      iRead = iSize;
+      psSource->lBytesLeft -= iSize;
+   }
+
+   return( iRead );
+}
+
+/*------------------------------------------------------------------------------
+** Copy the next segment from the payload source to the message data. When the
+** function returns with psSource->lBytesLeft equal to 0 the segment is the last
+** one.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSource     - Pointer to payload source
 **    psMsg        - Pointer to abcc message
 **    fFirstSeg    - Indicates first segment
 **
 ** Returns:
-**    None.
+**    Size of the segment.
 **------------------------------------------------------------------------------
 */
-static void PrepareAndSendSegmentationRespMsg( abcc_SegSessionType* psSegSession, ABP_MsgType* psMsg, BOOL fFirstSeg )
+static UINT16 FillSegment( abcc_SegSourceType* psSource, ABP_MsgType* psMsg, BOOL fFirstSeg )
 {
-   UINT8  bCmdExt1 = 0;
    UINT16 iDataSize = 0;
    UINT16 iPayloadOffset;
    UINT16 iNumOctetsToCopy;
 
-   if( fFirstSeg )
+   if( psSource->pnRead != NULL )
    {
-      bCmdExt1 = ABP_MSG_CMDEXT1_SEG_FIRST;
+      return( ReadSegment( psSource, psMsg ) );
+   }
 
-      /*
-      ** If no payload pointer is provided, check if the user has implemented the callback
-      */
-      if( psSegSession->pxData == NULL )
-      {
-         GetNextDataBlock( psSegSession );
-      }
+   /*
+   ** If no payload pointer is provided, check if the user has implemented the callback
+   */
+   if( fFirstSeg && ( psSource->pxData == NULL ) )
+   {
+      GetNextDataBlock( psSource );
    }
 
    /*
    ** Fill the payload until the segment is full or until no more data is
    ** provided by the user.
    */
-   while( ( iDataSize != ABCC_GetMaxMessageSize() ) && ( psSegSession->pxData ) &&
-      ( psSegSession->lBytesLeft != 0 ) )
+   while( ( iDataSize != ABCC_GetMaxMessageSize() ) && ( psSource->pxData ) &&
+      ( psSource->lBytesLeft != 0 ) )
    {
       /*
       ** Store current payload offset
       */
       iPayloadOffset = iDataSize;
 
-      if( ( iDataSize + psSegSession->lBytesLeft ) > ABCC_GetMaxMessageSize() )
+      if( ( iDataSize + psSource->lBytesLeft ) > ABCC_GetMaxMessageSize() )
       {
          iDataSize = ABCC_GetMaxMessageSize();
       }
       else
       {
-         iDataSize += (UINT16)psSegSession->lBytesLeft;
+         iDataSize += (UINT16)psSource->lBytesLeft;
       }
 
       iNumOctetsToCopy = iDataSize - iPayloadOffset;
 
       /*
-      ** Copy payload from user buffer to response message buffer
+      ** Copy payload from user buffer to message buffer
       */
       ABCC_PORT_CopyOctets( ABCC_GetMsgDataPtr( psMsg ),
                             iPayloadOffset,
-                            psSegSession->pxData,
-                            psSegSession->lDataBlockSize - psSegSession->lBytesLeft,
+                            psSource->pxData,
+                            psSource->lDataBlockSize - psSource->lBytesLeft,
                             iNumOctetsToCopy );
 
-      psSegSession->lBytesLeft -= iNumOctetsToCopy;
+      psSource->lBytesLeft -= iNumOctetsToCopy;
 
       /*
       ** If the whole block is copied, check if the user has more data to send.
       */
-      if( psSegSession->lBytesLeft == 0 )
+      if( psSource->lBytesLeft == 0 )
       {
-         GetNextDataBlock( psSegSession );
+         GetNextDataBlock( psSource );
       }
    }
 
-   if( psSegSession->lBytesLeft == 0 )
+   return( iDataSize );
+}
+
+/*------------------------------------------------------------------------------
+** Copy next segment to the abcc message and set the required segmentation bits.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSegSession - Pointer to segmentation instance
+**    psMsg        - Pointer to abcc message
+**    fFirstSeg    - Indicates first segment
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void PrepareAndSendSegmentationRespMsg( abcc_SegSessionType* psSegSession, ABP_MsgType* psMsg, BOOL fFirstSeg )
+{
+   UINT8  bCmdExt1 = 0;
+   UINT16 iDataSize;
+
+   if( fFirstSeg )
+   {
+      bCmdExt1 = ABP_MSG_CMDEXT1_SEG_FIRST;
+   }
+
+   iDataSize = FillSegment( &psSegSession->sSource, psMsg, fFirstSeg );
+
+   if( psSegSession->sSource.lBytesLeft == 0 )
    {
       bCmdExt1 |= ABP_MSG_CMDEXT1_SEG_LAST;
    }
@@ -291,11 +642,11 @@ static void PrepareAndSendSegmentationRespMsg( abcc_SegSessionType* psSegSession
    /*
    ** Check if last segment has been sent
    */
-   if( psSegSession->lBytesLeft == 0 )
+   if( psSegSession->sSource.lBytesLeft == 0 )
    {
       if( psSegSession->pnDone )
       {
-         psSegSession->pnDone( (void*)psSegSession->pxObject );
+         psSegSession->pnDone( (void*)psSegSession->sSource.pxObject );
       }
       FreeSegmentationSession( psSegSession );
    }
@@ -303,32 +654,47 @@ static void PrepareAndSendSegmentationRespMsg( abcc_SegSessionType* psSegSession
 
 void ABCC_SegmentationInit( void )
 {
-   UINT8 bSession;
+   UINT16 iIndex;
 
    abcc_bSegNumUsedInst = 0;
-   for( bSession = 0; bSession < ABCC_NUM_SEGMENTATION_SESSIONS; bSession++ )
+   for( iIndex = 0; iIndex < ABCC_CFG_NUM_SEGMENTATION_SESSIONS; iIndex++ )
    {
-      abcc_sSegSession[ bSession ].fInUse = FALSE;
+      abcc_sSegSession[ iIndex ].fInUse = FALSE;
+      abcc_sSegSession[ iIndex ].bNext = (UINT8)( iIndex + 1 );
+   }
+   abcc_sSegSession[ ABCC_CFG_NUM_SEGMENTATION_SESSIONS - 1 ].bNext = SEG_NO_SESSION;
+   abcc_bSegFreeHead = 0;
+
+   for( iIndex = 0; iIndex < ABCC_CFG_SEG_HASH_SIZE; iIndex++ )
+   {
+      abcc_abSegHashHead[ iIndex ] = SEG_NO_SESSION;
    }
 }
 
-EXTFUNC ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSession( const ABP_MsgHeaderType* psReqMsgHeader,
-                                                                    UINT8 bRspCmdExt0,
-                                                                    const void* pxData,
-                                                                    UINT32 lSize,
-                                                                    ABCC_SegMsgHandlerNextBlockFuncType pnNext,
-                                                                    ABCC_SegMsgHandlerDoneFuncType pnDone,
-                                                                    const void* pxObject )
+/*------------------------------------------------------------------------------
+** Starts a server response segmentation session and sends the first segment.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psReqMsgHeader - Pointer to request message header.
+**    bRspCmdExt0    - Value of command extension 0 to use in response segments.
+**    psSource       - Payload of the response, copied to the session.
+**    pnDone         - Callback to indicate that the entire message is sent.
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+static ABCC_ErrorCodeType StartServerRespSession( const ABP_MsgHeaderType* psReqMsgHeader,
+                                                  UINT8 bRspCmdExt0,
+                                                  const abcc_SegSourceType* psSource,
+                                                  ABCC_SegMsgHandlerDoneFuncType pnDone )
 {
    ABP_MsgType* psMsg;
    abcc_SegSessionType* psSegSession;
+   abcc_SegSessionIdentifiersType sIdentifiers;
 
-   if( ( pxData == NULL ) && ( pnNext == NULL ) )
-   {
-      return( ABCC_EC_UNEXPECTED_NULL_PTR );
-   }
-
-   psSegSession = AllocSegmentationSession();
+   GetSegSessionIdentifiers( (const ABP_MsgType*)psReqMsgHeader, &sIdentifiers );
+   psSegSession = AllocSegmentationSession( &sIdentifiers );
 
    if( psSegSession == NULL )
    {
@@ -337,17 +703,9 @@ EXTFUNC ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSession( const ABP_Ms
       return( ABCC_EC_NO_RESOURCES );
    }
 
-   psSegSession->lBytesLeft = lSize;
-   psSegSession->lDataBlockSize = lSize;
-   psSegSession->pxData = pxData;
+   psSegSession->sSource = *psSource;
    psSegSession->pnDone = pnDone;
-   psSegSession->pnNext = pnNext;
-   psSegSession->pxObject = pxObject;
    psSegSession->bRspCmdExt0 = bRspCmdExt0;
-   psSegSession->sIdentifiers.bDestObj = ABCC_GetMsgDestObj( psReqMsgHeader );
-   psSegSession->sIdentifiers.iInstance = ABCC_GetMsgInstance( psReqMsgHeader );
-   psSegSession->sIdentifiers.bCmd = ABCC_GetMsgCmdBits( psReqMsgHeader );
-   psSegSession->sIdentifiers.bCmdExt0 = ABCC_GetMsgCmdExt0( psReqMsgHeader );
 
    /*
    ** Get message buffer. Will be converted to response later.
@@ -375,6 +733,67 @@ EXTFUNC ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSession( const ABP_Ms
    return( ABCC_EC_NO_ERROR );
 }
 
+EXTFUNC ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSession( const ABP_MsgHeaderType* psReqMsgHeader,
+                                                                    UINT8 bRspCmdExt0,
+                                                                    const void* pxData,
+                                                                    UINT32 lSize,
+                                                                    ABCC_SegMsgHandlerNextBlockFuncType pnNext,
+                                                                    ABCC_SegMsgHandlerDoneFuncType pnDone,
+                                                                    const void* pxObject )
+{
+   abcc_SegSourceType sSource;
+
+   if( ( pxData == NULL ) && ( pnNext == NULL ) )
+   {
+      return( ABCC_EC_UNEXPECTED_NULL_PTR );
+   }
+
+   InitSegSource( &sSource, pxData, lSize, pnNext, pxObject );
+
+   return( StartServerRespSession( psReqMsgHeader, bRspCmdExt0, &sSource, pnDone ) );
+}
+
+ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSessionFragments( const ABP_MsgHeaderType* psReqMsgHeader,
+                                                                     UINT8 bRspCmdExt0,
+                                                                     const ABCC_SegDataFragmentType* pasFragments,
+                                                                     UINT16 iNumFragments,
+                                                                     ABCC_SegMsgHandlerDoneFuncType pnDone,
+                                                                     const void* pxObject )
+{
+   abcc_SegSourceType sSource;
+
+   if( pasFragments == NULL )
+   {
+      return( ABCC_EC_UNEXPECTED_NULL_PTR );
+   }
+
+   InitSegSource( &sSource, NULL, 0, NULL, pxObject );
+   sSource.pasFragments = pasFragments;
+   sSource.iFragmentsLeft = iNumFragments;
+
+   return( StartServerRespSession( psReqMsgHeader, bRspCmdExt0, &sSource, pnDone ) );
+}
+
+ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSessionRead( const ABP_MsgHeaderType* psReqMsgHeader,
+                                                                UINT8 bRspCmdExt0,
+                                                                UINT32 lSize,
+                                                                ABCC_SegMsgHandlerReadFuncType pnRead,
+                                                                ABCC_SegMsgHandlerDoneFuncType pnDone,
+                                                                const void* pxObject )
+{
+   abcc_SegSourceType sSource;
+
+   if( pnRead == NULL )
+   {
+      return( ABCC_EC_UNEXPECTED_NULL_PTR );
+   }
+
+   InitSegSource( &sSource, NULL, lSize, NULL, pxObject );
+   sSource.pnRead = pnRead;
+
+   return( StartServerRespSession( psReqMsgHeader, bRspCmdExt0, &sSource, pnDone ) );
+}
+
 BOOL ABCC_HandleSegmentAck( ABP_MsgType* psMsg )
 {
    abcc_SegSessionType* psSegSession;
@@ -400,11 +819,503 @@ BOOL ABCC_HandleSegmentAck( ABP_MsgType* psMsg )
       /*
       ** Abort segmentation by clearing number of bytes left and clear callback pointer
       */
-      psSegSession->lBytesLeft = 0;
-      psSegSession->pnNext = NULL;
+      StopSegSource( &psSegSession->sSource );
    }
 
    PrepareAndSendSegmentationRespMsg( psSegSession, psMsg, FALSE );
 
    return( TRUE );
 }
+
+#if ABCC_CFG_SEG_CLIENT_ENABLED
+/*
+** Client segmentation session states.
+*/
+#define SEG_CLIENT_FREE       ( 0 )
+#define SEG_CLIENT_WAITING    ( 1 )
+#define SEG_CLIENT_STARTING   ( 2 )
+#define SEG_CLIENT_CMD        ( 3 )
+#define SEG_CLIENT_RESP       ( 4 )
+
+/*------------------------------------------------------------------------------
+** Client segmentation session type
+**------------------------------------------------------------------------------
+**   sSource         - Command payload to be sent. sSource.pxObject is also
+**                     supplied as parameter in the pnRespData and pnDone
+**                     functions.
+**   pbRespBuffer    - Buffer the response is reassembled in, or NULL.
+**   lRespBufferSize - Size of pbRespBuffer.
+**   pnRespData      - Function to be called with each response segment, or
+**                     NULL.
+**   pnDone          - Function to be called when the session is done.
+**   lRespSize       - Number of response bytes received.
+**   sIdentifiers    - Header of the command.
+**   bSourceId       - Source id of the outstanding segment.
+**   bState          - SEG_CLIENT_FREE, SEG_CLIENT_WAITING (for a command
+**                     queue entry), SEG_CLIENT_STARTING (the first segment is
+**                     being sent), SEG_CLIENT_CMD (command segments left) or
+**                     SEG_CLIENT_RESP (waiting for response segments).
+**   fSegmentedResp  - The response is segmented.
+**------------------------------------------------------------------------------
+*/
+typedef struct abcc_SegClientSession
+{
+   abcc_SegSourceType sSource;
+   UINT8* pbRespBuffer;
+   UINT32 lRespBufferSize;
+   ABCC_SegClientRespDataFuncType pnRespData;
+   ABCC_SegClientDoneFuncType pnDone;
+   UINT32 lRespSize;
+   abcc_SegSessionIdentifiersType sIdentifiers;
+   UINT8 bSourceId;
+   UINT8 bState;
+   BOOL  fSegmentedResp;
+}
+abcc_SegClientSessionType;
+
+/*------------------------------------------------------------------------------
+** Place holder for client segmentation sessions and the number of sessions
+** waiting for a command queue entry.
+**------------------------------------------------------------------------------
+*/
+static abcc_SegClientSessionType abcc_sSegClientSession[ ABCC_CFG_SEG_CLIENT_NUM_SESSIONS ];
+static UINT8 abcc_bSegClientNumWaiting;
+
+static void SegClientRespHandler( ABP_MsgType* psMsg );
+
+/*------------------------------------------------------------------------------
+** Response handler of an abort request, the response carries no information.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psMsg - Pointer to the response.
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void SegClientAbortRespHandler( ABP_MsgType* psMsg )
+{
+   (void)psMsg;
+}
+
+/*------------------------------------------------------------------------------
+** Builds and sends the next command of a client session. Depending on the
+** session state this is the next command segment or a request for the next
+** response segment.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSession - Pointer to client session.
+**    psMsg     - Message buffer to use.
+**    fFirstSeg - Indicates first segment
+**
+** Returns:
+**    ABCC_ErrorCodeType. Buffer ownership follows ABCC_SendCmdMsg(): on
+**    ABCC_EC_LINK_CMD_QUEUE_FULL the driver has freed the buffer, on any
+**    other error it is still owned by the caller. The command payload has
+**    been consumed in both cases and the session can not be resumed.
+**------------------------------------------------------------------------------
+*/
+static ABCC_ErrorCodeType SendClientSegment( abcc_SegClientSessionType* psSession,
+                                             ABP_MsgType* psMsg,
+                                             BOOL fFirstSeg )
+{
+   UINT8 bCmdExt1 = 0;
+   UINT16 iDataSize = 0;
+
+   psSession->bSourceId = ABCC_GetNewSourceId();
+   ABCC_SetMsgHeader( psMsg,
+                      psSession->sIdentifiers.bDestObj,
+                      psSession->sIdentifiers.iInstance,
+                      psSession->sIdentifiers.bCmdExt0,
+                      (ABP_MsgCmdType)psSession->sIdentifiers.bCmd,
+                      0,
+                      psSession->bSourceId );
+
+   if( psSession->bState != SEG_CLIENT_RESP )
+   {
+      iDataSize = FillSegment( &psSession->sSource, psMsg, fFirstSeg );
+
+      /*
+      ** A command that fits in one message is sent without segmentation bits.
+      */
+      if( !( fFirstSeg && ( psSession->sSource.lBytesLeft == 0 ) ) )
+      {
+         if( fFirstSeg )
+         {
+            bCmdExt1 = ABP_MSG_CMDEXT1_SEG_FIRST;
+         }
+         if( psSession->sSource.lBytesLeft == 0 )
+         {
+            bCmdExt1 |= ABP_MSG_CMDEXT1_SEG_LAST;
+         }
+      }
+   }
+
+   ABCC_SetMsgDataSize( psMsg, iDataSize );
+   ABCC_SetMsgCmdExt1( psMsg, bCmdExt1 );
+
+   /*
+   ** The state is updated before sending since the response may be handled in
+   ** another context. The response to the last command segment carries the
+   ** response data.
+   */
+   if( psSession->sSource.lBytesLeft == 0 )
+   {
+      psSession->bState = SEG_CLIENT_RESP;
+   }
+   else
+   {
+      psSession->bState = SEG_CLIENT_CMD;
+   }
+
+   return( ABCC_SendCmdMsg( psMsg, SegClientRespHandler ) );
+}
+
+/*------------------------------------------------------------------------------
+** Ends a client session and calls its done callback.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSession - Pointer to client session.
+**    eResult   - Result of the session.
+**    psMsg     - Last response, NULL if not available.
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void EndClientSession( abcc_SegClientSessionType* psSession,
+                              ABCC_ErrorCodeType eResult,
+                              const ABP_MsgType* psMsg )
+{
+   ABCC_SegClientDoneFuncType pnDone;
+   const void* pxObject;
+   UINT32 lRespSize;
+   ABCC_PORT_UseCritical();
+
+   pnDone = psSession->pnDone;
+   pxObject = psSession->sSource.pxObject;
+   lRespSize = psSession->lRespSize;
+
+   /*
+   ** The session is released first so the callback may start a new one.
+   */
+   ABCC_PORT_EnterCritical();
+   psSession->bState = SEG_CLIENT_FREE;
+   ABCC_PORT_ExitCritical();
+
+   if( pnDone != NULL )
+   {
+      pnDone( (void*)pxObject, eResult, psMsg, lRespSize );
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Stores a response segment.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSession - Pointer to client session.
+**    psMsg     - Response segment.
+**
+** Returns:
+**    FALSE if the data does not fit in the response buffer or if the data
+**    callback asks to abort the session.
+**------------------------------------------------------------------------------
+*/
+static BOOL StoreClientRespSegment( abcc_SegClientSessionType* psSession, ABP_MsgType* psMsg )
+{
+   UINT16 iSize;
+
+   iSize = ABCC_GetMsgDataSize( psMsg );
+
+   if( psSession->pnRespData != NULL )
+   {
+      if( !psSession->pnRespData( (void*)psSession->sSource.pxObject,
+                                  ABCC_GetMsgDataPtr( psMsg ),
+                                  iSize,
+                                  psSession->lRespSize ) )
+      {
+         return( FALSE );
+      }
+   }
+   else if( psSession->pbRespBuffer != NULL )
+   {
+      if( ( psSession->lRespBufferSize - psSession->lRespSize ) < iSize )
+      {
+         return( FALSE );
+      }
+
+      ABCC_PORT_CopyOctets( psSession->pbRespBuffer,
+                            psSession->lRespSize,
+                            ABCC_GetMsgDataPtr( psMsg ),
+                            0,
+                            iSize );
+   }
+
+   psSession->lRespSize += iSize;
+
+   return( TRUE );
+}
+
+/*------------------------------------------------------------------------------
+** Starts the client sessions waiting for a command queue entry as long as
+** entries and message buffers are available.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void StartWaitingClientSessions( void )
+{
+   UINT8 bSession;
+   BOOL fClaimed;
+   ABP_MsgType* psMsg;
+   abcc_SegClientSessionType* psSession;
+   ABCC_ErrorCodeType eResult;
+   ABCC_PORT_UseCritical();
+
+   for( bSession = 0; ( bSession < ABCC_CFG_SEG_CLIENT_NUM_SESSIONS ) &&
+                      ( abcc_bSegClientNumWaiting > 0 ); bSession++ )
+   {
+      if( ABCC_GetCmdQueueSize() == 0 )
+      {
+         return;
+      }
+
+      /*
+      ** Claim the session so it is not started from two contexts.
+      */
+      psSession = &abcc_sSegClientSession[ bSession ];
+      fClaimed = FALSE;
+      ABCC_PORT_EnterCritical();
+      if( psSession->bState == SEG_CLIENT_WAITING )
+      {
+         psSession->bState = SEG_CLIENT_STARTING;
+         abcc_bSegClientNumWaiting--;
+         fClaimed = TRUE;
+      }
+      ABCC_PORT_ExitCritical();
+
+      if( !fClaimed )
+      {
+         continue;
+      }
+
+      psMsg = ABCC_GetCmdMsgBuffer();
+      if( psMsg == NULL )
+      {
+         ABCC_PORT_EnterCritical();
+         psSession->bState = SEG_CLIENT_WAITING;
+         abcc_bSegClientNumWaiting++;
+         ABCC_PORT_ExitCritical();
+         return;
+      }
+
+      eResult = SendClientSegment( psSession, psMsg, TRUE );
+      if( eResult != ABCC_EC_NO_ERROR )
+      {
+         if( eResult != ABCC_EC_LINK_CMD_QUEUE_FULL )
+         {
+            ABCC_ReturnMsgBuffer( &psMsg );
+         }
+         EndClientSession( psSession, eResult, NULL );
+      }
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Response handler of all client session commands.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psMsg - Pointer to the response.
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void SegClientRespHandler( ABP_MsgType* psMsg )
+{
+   UINT8 bSession;
+   UINT8 bCmdExt1;
+   abcc_SegClientSessionType* psSession = NULL;
+   ABCC_ErrorCodeType eResult;
+
+   for( bSession = 0; bSession < ABCC_CFG_SEG_CLIENT_NUM_SESSIONS; bSession++ )
+   {
+      if( ( abcc_sSegClientSession[ bSession ].bState >= SEG_CLIENT_CMD ) &&
+          ( abcc_sSegClientSession[ bSession ].bSourceId == ABCC_GetMsgSourceId( psMsg ) ) )
+      {
+         psSession = &abcc_sSegClientSession[ bSession ];
+         break;
+      }
+   }
+
+   if( psSession == NULL )
+   {
+      return;
+   }
+
+   bCmdExt1 = ABCC_GetMsgCmdExt1( psMsg );
+
+   if( ABCC_VerifyMessage( psMsg ) != ABCC_EC_NO_ERROR )
+   {
+      EndClientSession( psSession, ABCC_EC_RESP_MSG_E_BIT_SET, psMsg );
+   }
+   else if( bCmdExt1 & ABP_MSG_CMDEXT1_SEG_ABORT )
+   {
+      ABCC_LOG_WARNING( ABCC_EC_ERROR_RESP_SEGMENTATION,
+            psSession->sIdentifiers.bDestObj,
+            "Client segmentation session aborted by ABCC (object: %" PRIu8 ")\n",
+            psSession->sIdentifiers.bDestObj );
+
+      EndClientSession( psSession, ABCC_EC_ERROR_RESP_SEGMENTATION, psMsg );
+   }
+   else if( psSession->bState == SEG_CLIENT_CMD )
+   {
+      /*
+      ** Acknowledge of a command segment, send the next one in the same
+      ** buffer. If the send fails the driver frees the buffer when this
+      ** handler returns, unless the link already did so on a full queue.
+      */
+      eResult = SendClientSegment( psSession, psMsg, FALSE );
+      if( eResult != ABCC_EC_NO_ERROR )
+      {
+         EndClientSession( psSession, eResult, NULL );
+      }
+   }
+   else
+   {
+      if( bCmdExt1 & ABP_MSG_CMDEXT1_SEG_FIRST )
+      {
+         psSession->fSegmentedResp = TRUE;
+      }
+
+      if( !StoreClientRespSegment( psSession, psMsg ) )
+      {
+         ABCC_LOG_WARNING( ABCC_EC_ERROR_RESP_SEGMENTATION,
+               psSession->lRespSize,
+               "Client segmentation response rejected after %" PRIu32 " bytes\n",
+               psSession->lRespSize );
+
+         /*
+         ** Tell the ABCC to stop sending segments.
+         */
+         if( psSession->fSegmentedResp && !( bCmdExt1 & ABP_MSG_CMDEXT1_SEG_LAST ) )
+         {
+            ABCC_SetMsgHeader( psMsg,
+                               psSession->sIdentifiers.bDestObj,
+                               psSession->sIdentifiers.iInstance,
+                               psSession->sIdentifiers.bCmdExt0,
+                               (ABP_MsgCmdType)psSession->sIdentifiers.bCmd,
+                               0,
+                               ABCC_GetNewSourceId() );
+            ABCC_SetMsgCmdExt1( psMsg, ABP_MSG_CMDEXT1_SEG_ABORT );
+            (void)ABCC_SendCmdMsg( psMsg, SegClientAbortRespHandler );
+         }
+         EndClientSession( psSession, ABCC_EC_ERROR_RESP_SEGMENTATION, NULL );
+      }
+      else if( psSession->fSegmentedResp && !( bCmdExt1 & ABP_MSG_CMDEXT1_SEG_LAST ) )
+      {
+         /*
+         ** Request the next response segment.
+         */
+         eResult = SendClientSegment( psSession, psMsg, FALSE );
+         if( eResult != ABCC_EC_NO_ERROR )
+         {
+            EndClientSession( psSession, eResult, NULL );
+         }
+      }
+      else
+      {
+         EndClientSession( psSession, ABCC_EC_NO_ERROR, psMsg );
+      }
+   }
+
+   /*
+   ** A command queue entry may have been released.
+   */
+   StartWaitingClientSessions();
+}
+
+void ABCC_SegClientInit( void )
+{
+   UINT8 bSession;
+
+   abcc_bSegClientNumWaiting = 0;
+   for( bSession = 0; bSession < ABCC_CFG_SEG_CLIENT_NUM_SESSIONS; bSession++ )
+   {
+      abcc_sSegClientSession[ bSession ].bState = SEG_CLIENT_FREE;
+   }
+}
+
+void ABCC_SegClientExec( void )
+{
+   if( abcc_bSegClientNumWaiting > 0 )
+   {
+      StartWaitingClientSessions();
+   }
+}
+
+ABCC_ErrorCodeType ABCC_StartClientSegmentationSession( UINT8 bObject,
+                                                        UINT16 iInstance,
+                                                        ABP_MsgCmdType eCmd,
+                                                        UINT8 bCmdExt0,
+                                                        const void* pxData,
+                                                        UINT32 lSize,
+                                                        ABCC_SegMsgHandlerNextBlockFuncType pnNext,
+                                                        void* pxRespBuffer,
+                                                        UINT32 lRespBufferSize,
+                                                        ABCC_SegClientRespDataFuncType pnRespData,
+                                                        ABCC_SegClientDoneFuncType pnDone,
+                                                        const void* pxObject )
+{
+   UINT8 bSession;
+   abcc_SegClientSessionType* psSession = NULL;
+   ABCC_PORT_UseCritical();
+
+   ABCC_PORT_EnterCritical();
+   for( bSession = 0; bSession < ABCC_CFG_SEG_CLIENT_NUM_SESSIONS; bSession++ )
+   {
+      if( abcc_sSegClientSession[ bSession ].bState == SEG_CLIENT_FREE )
+      {
+         psSession = &abcc_sSegClientSession[ bSession ];
+         psSession->bState = SEG_CLIENT_STARTING;
+         break;
+      }
+   }
+   ABCC_PORT_ExitCritical();
+
+   if( psSession == NULL )
+   {
+      ABCC_LOG_WARNING( ABCC_EC_NO_RESOURCES, 0, "No client segmentation session resources available\n" );
+
+      return( ABCC_EC_NO_RESOURCES );
+   }
+
+   InitSegSource( &psSession->sSource, pxData, lSize, pnNext, pxObject );
+   psSession->pbRespBuffer = (UINT8*)pxRespBuffer;
+   psSession->lRespBufferSize = lRespBufferSize;
+   psSession->pnRespData = pnRespData;
+   psSession->pnDone = pnDone;
+   psSession->lRespSize = 0;
+   psSession->fSegmentedResp = FALSE;
+   psSession->sIdentifiers.bDestObj = bObject;
+   psSession->sIdentifiers.iInstance = iInstance;
+   psSession->sIdentifiers.bCmd = (UINT8)eCmd;
+   psSession->sIdentifiers.bCmdExt0 = bCmdExt0;
+
+   /*
+   ** The first segment is sent when a command queue entry is available.
+   */
+   ABCC_PORT_EnterCritical();
+   psSession->bState = SEG_CLIENT_WAITING;
+   abcc_bSegClientNumWaiting++;
+   ABCC_PORT_ExitCritical();
+
+   StartWaitingClientSessions();
+
+   return( ABCC_EC_NO_ERROR );
+}
+#endif
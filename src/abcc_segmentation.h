@@ -43,4 +43,31 @@ EXTFUNC void ABCC_SegmentationInit( void );
 */
 EXTFUNC BOOL ABCC_HandleSegmentAck( ABP_MsgType* psMsg );
 
+#if ABCC_CFG_SEG_CLIENT_ENABLED
+/*------------------------------------------------------------------------------
+** Init the client segmentation sessions.
+**------------------------------------------------------------------------------
+** Arguments:
+**       None.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_SegClientInit( void );
+
+/*------------------------------------------------------------------------------
+** Starts client segmentation sessions that are waiting for a command queue
+** entry. Called from ABCC_RunDriver().
+**------------------------------------------------------------------------------
+** Arguments:
+**       None.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_SegClientExec( void );
+#endif
+
 #endif  /* inclusion lock */
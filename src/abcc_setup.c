@@ -929,7 +929,7 @@ static ABCC_CmdSeqRespStatusType SetupCompleteResp( ABP_MsgType* psMsg, void* px
       return( ABCC_CMDSEQ_RESP_ABORT );
    }
 
-   pnABCC_DrvSetPdSize( abcc_iPdReadSize, abcc_iPdWriteSize );
+   ABCC_SetPdSize( abcc_iPdReadSize, abcc_iPdWriteSize );
    ABCC_LOG_INFO( "RSP MSG_SETUP_COMPLETE\n" );
    return( ABCC_CMDSEQ_RESP_EXEC_NEXT );
 }
@@ -4,6 +4,11 @@
 ********************************************************************************
 ** File Description:
 ** Timer implementation.
+**
+** Running timers are kept in a binary min-heap ordered by their absolute
+** deadline in uptime ms. A tick only has to look at the root of the heap, so
+** its cost does not grow with the number of running timers unless timers
+** expire. Starting and stopping a timer is O(log n).
 ********************************************************************************
 */
 
@@ -11,34 +16,159 @@
 #include "abcc_log.h"
 #include "abcc.h"
 #include "abcc_port.h"
+#if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED
+#include "abcc_hardware_abstraction.h"
+#endif
+
+#define TIMER_NOT_RUNNING     ( 0xffff )
+#define TIMER_NS_PER_MS       ( 1000000 )
 
 /*
 ** Timer resource structure
 */
 typedef struct ABCC_TimerTimeoutType
 {
-   BOOL  fActive;
-   BOOL  fTmoOccured;
-   INT32 lTimeLeft;
+   BOOL   fTmoOccured;
+   UINT16 iHeapIndex;
+   UINT64 llDeadline;
    ABCC_TimerTimeoutCallbackType pnHandleTimeout;
 }
 ABCC_TimerTimeoutType;
-#define MAX_NUM_TIMERS 3
-static ABCC_TimerTimeoutType sTimer[ MAX_NUM_TIMERS ];
+
+static ABCC_TimerTimeoutType sTimer[ ABCC_CFG_MAX_NUM_TIMERS ];
+
+/*
+** Min-heap of the running timers, aiHeap[ 0 ] expires first.
+*/
+static ABCC_TimerHandle aiHeap[ ABCC_CFG_MAX_NUM_TIMERS ];
+static UINT16 iHeapSize = 0;
+
 static BOOL fTimerEnabled = FALSE;
 static UINT64 llTotalTicks = 0;
 
+#if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED
+/*
+** HAL timestamp up to which the elapsed time has been ticked, see
+** ABCC_TimerTickFromHal().
+*/
+static UINT64 llLastTickNs = 0;
+#endif
+
+/*------------------------------------------------------------------------------
+** Places a timer at a heap position.
+** Must be called within the timer critical section.
+**------------------------------------------------------------------------------
+*/
+static void timer_HeapSet( UINT16 iIndex, ABCC_TimerHandle xHandle )
+{
+   aiHeap[ iIndex ] = xHandle;
+   sTimer[ xHandle ].iHeapIndex = iIndex;
+}
+
+/*------------------------------------------------------------------------------
+** Moves a timer towards the root until its parent does not expire later.
+** Must be called within the timer critical section.
+**------------------------------------------------------------------------------
+*/
+static void timer_HeapUp( UINT16 iIndex )
+{
+   ABCC_TimerHandle xHandle = aiHeap[ iIndex ];
+   UINT16 iParent;
+
+   while( iIndex > 0 )
+   {
+      iParent = ( iIndex - 1 ) >> 1;
+
+      if( sTimer[ aiHeap[ iParent ] ].llDeadline <= sTimer[ xHandle ].llDeadline )
+      {
+         break;
+      }
+
+      timer_HeapSet( iIndex, aiHeap[ iParent ] );
+      iIndex = iParent;
+   }
+
+   timer_HeapSet( iIndex, xHandle );
+}
+
+/*------------------------------------------------------------------------------
+** Moves a timer away from the root until no child expires earlier.
+** Must be called within the timer critical section.
+**------------------------------------------------------------------------------
+*/
+static void timer_HeapDown( UINT16 iIndex )
+{
+   ABCC_TimerHandle xHandle = aiHeap[ iIndex ];
+   UINT32 lChild;
+
+   while( ( lChild = ( (UINT32)iIndex << 1 ) + 1 ) < iHeapSize )
+   {
+      if( ( ( lChild + 1 ) < iHeapSize ) &&
+          ( sTimer[ aiHeap[ lChild + 1 ] ].llDeadline < sTimer[ aiHeap[ lChild ] ].llDeadline ) )
+      {
+         lChild++;
+      }
+
+      if( sTimer[ xHandle ].llDeadline <= sTimer[ aiHeap[ lChild ] ].llDeadline )
+      {
+         break;
+      }
+
+      timer_HeapSet( iIndex, aiHeap[ lChild ] );
+      iIndex = (UINT16)lChild;
+   }
+
+   timer_HeapSet( iIndex, xHandle );
+}
+
+/*------------------------------------------------------------------------------
+** Removes a running timer from the heap.
+** Must be called within the timer critical section.
+**------------------------------------------------------------------------------
+*/
+static void timer_HeapRemove( ABCC_TimerHandle xHandle )
+{
+   UINT16 iIndex = sTimer[ xHandle ].iHeapIndex;
+
+   sTimer[ xHandle ].iHeapIndex = TIMER_NOT_RUNNING;
+   iHeapSize--;
+
+   if( iIndex < iHeapSize )
+   {
+      /*
+      ** Fill the hole with the last timer and restore the heap order in
+      ** whichever direction is needed.
+      */
+      timer_HeapSet( iIndex, aiHeap[ iHeapSize ] );
+
+      if( ( iIndex > 0 ) &&
+          ( sTimer[ aiHeap[ ( iIndex - 1 ) >> 1 ] ].llDeadline > sTimer[ aiHeap[ iIndex ] ].llDeadline ) )
+      {
+         timer_HeapUp( iIndex );
+      }
+      else
+      {
+         timer_HeapDown( iIndex );
+      }
+   }
+}
+
 void ABCC_TimerInit( void )
 {
    ABCC_TimerHandle xHandle;
 
-   for( xHandle = 0; xHandle < MAX_NUM_TIMERS; xHandle++ )
+   for( xHandle = 0; xHandle < ABCC_CFG_MAX_NUM_TIMERS; xHandle++ )
    {
       sTimer[ xHandle ].pnHandleTimeout = NULL;
+      sTimer[ xHandle ].iHeapIndex = TIMER_NOT_RUNNING;
    }
+   iHeapSize = 0;
    fTimerEnabled = TRUE;
 
    llTotalTicks = 0;
+#if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED
+   llLastTickNs = ABCC_HAL_GetTimestampNs();
+#endif
 }
 
 ABCC_TimerHandle ABCC_TimerCreate( ABCC_TimerTimeoutCallbackType pnHandleTimeout )
@@ -48,11 +178,11 @@ ABCC_TimerHandle ABCC_TimerCreate( ABCC_TimerTimeoutCallbackType pnHandleTimeout
 
    ABCC_PORT_TIMER_EnterCritical();
 
-   for( xHandle = 0; xHandle < MAX_NUM_TIMERS; xHandle++ )
+   for( xHandle = 0; xHandle < ABCC_CFG_MAX_NUM_TIMERS; xHandle++ )
    {
       if( sTimer[ xHandle ].pnHandleTimeout == NULL )
       {
-         sTimer[ xHandle ].fActive = FALSE;
+         sTimer[ xHandle ].iHeapIndex = TIMER_NOT_RUNNING;
          sTimer[ xHandle ].fTmoOccured = FALSE;
          sTimer[ xHandle ].pnHandleTimeout = pnHandleTimeout;
          break;
@@ -60,7 +190,7 @@ ABCC_TimerHandle ABCC_TimerCreate( ABCC_TimerTimeoutCallbackType pnHandleTimeout
    }
    ABCC_PORT_TIMER_ExitCritical();
 
-   if( xHandle >=  MAX_NUM_TIMERS )
+   if( xHandle >=  ABCC_CFG_MAX_NUM_TIMERS )
    {
       xHandle = ABCC_TIMER_NO_HANDLE;
    }
@@ -83,9 +213,22 @@ BOOL ABCC_TimerStart( ABCC_TimerHandle xHandle,
 
    ABCC_PORT_TIMER_EnterCritical();
    fTmo = sTimer[ xHandle ].fTmoOccured;
-   sTimer[ xHandle ].lTimeLeft = (INT32)lTimeoutMs;
+   sTimer[ xHandle ].llDeadline = llTotalTicks + lTimeoutMs;
    sTimer[ xHandle ].fTmoOccured = FALSE;
-   sTimer[ xHandle ].fActive = TRUE;
+
+   if( sTimer[ xHandle ].iHeapIndex == TIMER_NOT_RUNNING )
+   {
+      timer_HeapSet( iHeapSize++, xHandle );
+      timer_HeapUp( sTimer[ xHandle ].iHeapIndex );
+   }
+   else
+   {
+      /*
+      ** Restarted while running, the deadline may have moved either way.
+      */
+      timer_HeapUp( sTimer[ xHandle ].iHeapIndex );
+      timer_HeapDown( sTimer[ xHandle ].iHeapIndex );
+   }
 
    ABCC_PORT_TIMER_ExitCritical();
    return( fTmo );
@@ -99,7 +242,10 @@ BOOL ABCC_TimerStop( ABCC_TimerHandle xHandle )
    ABCC_PORT_TIMER_EnterCritical();
    fTmo = sTimer[ xHandle ].fTmoOccured;
 
-   sTimer[ xHandle ].fActive = FALSE;
+   if( sTimer[ xHandle ].iHeapIndex != TIMER_NOT_RUNNING )
+   {
+      timer_HeapRemove( xHandle );
+   }
    sTimer[ xHandle ].fTmoOccured = FALSE;
 
    ABCC_PORT_TIMER_ExitCritical();
@@ -118,23 +264,21 @@ void ABCC_TimerTick(const INT16 iDeltaTimeMs)
 
    ABCC_PORT_TIMER_EnterCritical();
 
-   for( xHandle = 0; xHandle < MAX_NUM_TIMERS; xHandle++ )
+   llTotalTicks += iDeltaTimeMs;
+
+   while( ( iHeapSize > 0 ) &&
+          ( sTimer[ aiHeap[ 0 ] ].llDeadline <= llTotalTicks ) )
    {
-       if( ( sTimer[ xHandle ].pnHandleTimeout != NULL ) &&
-             ( sTimer[ xHandle ].fActive == TRUE ) )
-       {
-          sTimer[ xHandle ].lTimeLeft -= (INT32)iDeltaTimeMs;
-          if( sTimer[ xHandle ].lTimeLeft <= 0 )
-          {
-             sTimer[ xHandle ].fTmoOccured = TRUE;
-             sTimer[ xHandle ].fActive = FALSE;
-             sTimer[ xHandle ].pnHandleTimeout();
-          }
-       }
+      /*
+      ** The timer is removed before the callback is called, so the callback
+      ** may restart it.
+      */
+      xHandle = aiHeap[ 0 ];
+      timer_HeapRemove( xHandle );
+      sTimer[ xHandle ].fTmoOccured = TRUE;
+      sTimer[ xHandle ].pnHandleTimeout();
    }
 
-   llTotalTicks += iDeltaTimeMs;
-
    ABCC_PORT_TIMER_ExitCritical();
 }
 
@@ -143,6 +287,30 @@ void ABCC_TimerDisable( void )
    fTimerEnabled = FALSE;
 }
 
+UINT32 ABCC_TimerGetTimeToNextTmoMs( void )
+{
+   UINT32 lTimeToTmo = ABCC_TIMER_NO_TMO;
+   ABCC_PORT_TIMER_UseCritical();
+
+   ABCC_PORT_TIMER_EnterCritical();
+
+   if( iHeapSize > 0 )
+   {
+      if( sTimer[ aiHeap[ 0 ] ].llDeadline <= llTotalTicks )
+      {
+         lTimeToTmo = 0;
+      }
+      else
+      {
+         lTimeToTmo = (UINT32)( sTimer[ aiHeap[ 0 ] ].llDeadline - llTotalTicks );
+      }
+   }
+
+   ABCC_PORT_TIMER_ExitCritical();
+
+   return( lTimeToTmo );
+}
+
 UINT64 ABCC_TimerGetUptimeMs( void )
 {
    ABCC_PORT_TIMER_UseCritical();
@@ -157,3 +325,33 @@ UINT64 ABCC_TimerGetUptimeMs( void )
 
    return( llUptime );
 }
+
+#if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED
+void ABCC_TimerTickFromHal( void )
+{
+   UINT64 llElapsedMs;
+   INT16 iDeltaTimeMs;
+
+   llElapsedMs = ( ABCC_HAL_GetTimestampNs() - llLastTickNs ) / TIMER_NS_PER_MS;
+   llLastTickNs += llElapsedMs * TIMER_NS_PER_MS;
+
+   /*
+   ** ABCC_TimerTick() takes at most INT16_MAX ms per call.
+   */
+   while( llElapsedMs > 0 )
+   {
+      iDeltaTimeMs = ( llElapsedMs > 0x7fff ) ? 0x7fff : (INT16)llElapsedMs;
+      ABCC_TimerTick( iDeltaTimeMs );
+      llElapsedMs -= (UINT64)iDeltaTimeMs;
+   }
+}
+#endif
+
+UINT64 ABCC_TimerGetTimestampNs( void )
+{
+#if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED
+   return( ABCC_HAL_GetTimestampNs() );
+#else
+   return( ABCC_TimerGetUptimeMs() * TIMER_NS_PER_MS );
+#endif
+}
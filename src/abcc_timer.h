@@ -14,7 +14,8 @@
 #include "abcc_types.h"
 #include "abcc_hardware_abstraction.h"
 
-#define ABCC_TIMER_NO_HANDLE ( 0xff )
+#define ABCC_TIMER_NO_HANDLE ( 0xffff )
+#define ABCC_TIMER_NO_TMO    ( 0xFFFFFFFFUL )
 
 /*
 ** Timeout callback function type.
@@ -24,7 +25,7 @@ typedef void (*ABCC_TimerTimeoutCallbackType)( void );
 /*
 ** Type for identifying timer
 */
-typedef UINT8 ABCC_TimerHandle;
+typedef UINT16 ABCC_TimerHandle;
 
 /*------------------------------------------------------------------------------
 ** void ABCC_TimerInit( void );
@@ -114,4 +115,42 @@ EXTFUNC void ABCC_TimerDisable( void );
 */
 EXTFUNC UINT64 ABCC_TimerGetUptimeMs( void );
 
+#if ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED
+/*------------------------------------------------------------------------------
+** Ticks the timer system with the whole ms elapsed according to
+** ABCC_HAL_GetTimestampNs() since the previous call. The remainder is carried
+** over to the next call.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_TimerTickFromHal( void );
+#endif
+
+/*------------------------------------------------------------------------------
+** Get a timestamp in ns, from ABCC_HAL_GetTimestampNs() if
+** ABCC_CFG_HAL_TIMESTAMP_NS_ENABLED is set, otherwise the uptime in ns.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+** Returns:
+**    Timestamp in ns.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT64 ABCC_TimerGetTimestampNs( void );
+
+/*------------------------------------------------------------------------------
+** Get the time until the first running timer expires.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+** Returns:
+**    Time in ms, ABCC_TIMER_NO_TMO if no timer is running.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT32 ABCC_TimerGetTimeToNextTmoMs( void );
+
 #endif  /* inclusion lock */
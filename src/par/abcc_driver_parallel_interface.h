@@ -43,6 +43,52 @@ EXTFUNC void ABCC_DrvParInit( UINT8 bOpmode );
 */
 EXTFUNC UINT16  ABCC_DrvParISR( void );
 
+#if ABCC_CFG_ISR_STATS_ENABLED
+/*------------------------------------------------------------------------------
+** Returns the number of interrupt status register reads made by the last call
+** to ABCC_DrvParISR().
+**------------------------------------------------------------------------------
+** Arguments:
+**       None.
+**
+** Returns:
+**       Number of reads.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT16 ABCC_DrvParGetIsrStatusReads( void );
+#endif
+
+/*------------------------------------------------------------------------------
+** Reads the buffer control and Anybus status registers once and lets all
+** following register checks use the snapshot instead of reading the ABCC, until
+** ABCC_DrvParReleaseRegSnapshot() is called. Flags acknowledged or set by the
+** driver are updated in the snapshot.
+**
+** Remarks:
+**       Must only be used when no event is handled in interrupt context, since
+**       the ISR would otherwise see a stale snapshot.
+**------------------------------------------------------------------------------
+** Arguments:
+**       None.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_DrvParTakeRegSnapshot( void );
+
+/*------------------------------------------------------------------------------
+** Ends the use of the register snapshot taken by ABCC_DrvParTakeRegSnapshot().
+**------------------------------------------------------------------------------
+** Arguments:
+**       None.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_DrvParReleaseRegSnapshot( void );
+
 /*------------------------------------------------------------------------------
 ** Drives the internal send process.
 **------------------------------------------------------------------------------
@@ -115,6 +161,22 @@ EXTFUNC BOOL ABCC_DrvParWriteMessage( ABP_MsgType* psWriteMsg );
 */
 EXTFUNC void ABCC_DrvParWriteProcessData( void* pxProcessData );
 
+#if ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED
+/*------------------------------------------------------------------------------
+** Marks a byte range of the write process data as modified. Only the marked
+** ranges are written by the next call to ABCC_DrvParWriteProcessData().
+**------------------------------------------------------------------------------
+** Arguments:
+**       iOffset:       Offset of the first modified byte.
+**       iSize:         Number of modified bytes.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_DrvParMarkWrPdDirty( UINT16 iOffset, UINT16 iSize );
+#endif
+
 /*------------------------------------------------------------------------------
 ** Checks if the driver is in the correct state for writing process data to the anybus
 **------------------------------------------------------------------------------
@@ -22,11 +22,30 @@
 #include "../abcc_handler.h"
 #include "../abcc_timer.h"
 #include "../abcc_command_sequencer.h"
+#include "abcc_driver_parallel_interface.h"
+#include "abcc_port.h"
 
 #if ( ABCC_CFG_INT_ENABLE_MASK_PAR & ABP_INTMASK_SYNCIEN )
 #error "Use ABCC_CFG_USE_ABCC_SYNC_SIGNAL_ENABLED define in abcc_driver_config.h to choose sync interrupt source. Do not use ABP_INTMASK_SYNCIEN"
 #endif
 
+#if ( ABCC_CFG_INT_COALESCE_MASK & ~( ABP_INTSTATUS_STATUSI | ABP_INTSTATUS_WRMSGI | ABP_INTSTATUS_ANBRI ) )
+#error "ABCC_CFG_INT_COALESCE_MASK may only contain ABP_INTSTATUS_STATUSI, ABP_INTSTATUS_WRMSGI and ABP_INTSTATUS_ANBRI"
+#endif
+
+#if ABCC_CFG_INT_COALESCE_MASK
+/*
+** Interrupt events deferred to ABCC_ParRunDriver() and the uptime when the
+** first of them was deferred.
+*/
+static volatile UINT16 par_iDeferredInts = 0;
+static UINT32 par_lDeferStartMs;
+#endif
+
+#if ABCC_CFG_ISR_STATS_ENABLED
+static ABCC_IsrStatsType par_sIsrStats;
+#endif
+
 #if ABCC_CFG_INT_ENABLED
 /*------------------------------------------------------------------------------
 ** Translates the ABP Interrupt status register value to the driver's ISR Event
@@ -70,13 +89,140 @@ static UINT16 AbpIntStatusToAbccIsrEvent( UINT16 iIntStatus )
 }
 #endif /* ( ABCC_CFG_INT_ENABLED ) */
 
+#if ABCC_CFG_INT_ENABLED && ABCC_CFG_ISR_STATS_ENABLED
+/*------------------------------------------------------------------------------
+** Counts the interrupt events of one ISR invocation.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iIntStatus - ABP Interrupt status register value
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void IsrStatsCountEvents( UINT16 iIntStatus )
+{
+   UINT16 iStatusReads;
+
+   par_sIsrStats.lNumIsr++;
+   iStatusReads = ABCC_DrvParGetIsrStatusReads();
+   par_sIsrStats.lNumStatusReads += iStatusReads;
+   if( iStatusReads > par_sIsrStats.lMaxStatusReads )
+   {
+      par_sIsrStats.lMaxStatusReads = iStatusReads;
+   }
+
+   if( iIntStatus & ABP_INTSTATUS_RDPDI )
+   {
+      par_sIsrStats.lNumRdPd++;
+   }
+   if( iIntStatus & ABP_INTSTATUS_RDMSGI )
+   {
+      par_sIsrStats.lNumRdMsg++;
+   }
+   if( iIntStatus & ABP_INTSTATUS_WRMSGI )
+   {
+      par_sIsrStats.lNumWrMsg++;
+   }
+   if( iIntStatus & ABP_INTSTATUS_ANBRI )
+   {
+      par_sIsrStats.lNumAnbr++;
+   }
+   if( iIntStatus & ABP_INTSTATUS_STATUSI )
+   {
+      par_sIsrStats.lNumStatus++;
+   }
+   if( iIntStatus & ABP_INTSTATUS_SYNCI )
+   {
+      par_sIsrStats.lNumSync++;
+   }
+}
+#endif
+
+#if ABCC_CFG_INT_ENABLED && ABCC_CFG_INT_COALESCE_MASK
+/*------------------------------------------------------------------------------
+** Defers the events in ABCC_CFG_INT_COALESCE_MASK to ABCC_ParRunDriver(). If
+** ABCC_ParRunDriver() has not picked up earlier deferred events within
+** ABCC_CFG_INT_COALESCE_WINDOW_MS, they are instead all returned to be handled
+** by the ISR. The window is only checked here, i.e. on the next interrupt.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iIntStatus - ABP Interrupt status register value
+**
+** Returns:
+**    The events to handle in the ISR.
+**------------------------------------------------------------------------------
+*/
+static UINT16 CoalesceInts( UINT16 iIntStatus )
+{
+   UINT16 iDeferInts;
+   UINT32 lNowMs;
+
+   iDeferInts = iIntStatus & ABCC_CFG_INT_COALESCE_MASK;
+   if( ( iDeferInts == 0 ) && ( par_iDeferredInts == 0 ) )
+   {
+      return( iIntStatus );
+   }
+
+   lNowMs = (UINT32)ABCC_TimerGetUptimeMs();
+
+   if( par_iDeferredInts == 0 )
+   {
+      par_lDeferStartMs = lNowMs;
+   }
+   else if( ( lNowMs - par_lDeferStartMs ) >= ABCC_CFG_INT_COALESCE_WINDOW_MS )
+   {
+      iIntStatus |= par_iDeferredInts;
+      par_iDeferredInts = 0;
+#if ABCC_CFG_ISR_STATS_ENABLED
+      par_sIsrStats.lNumWindowExpired++;
+#endif
+      return( iIntStatus );
+   }
+
+   if( iDeferInts != 0 )
+   {
+      par_iDeferredInts |= iDeferInts;
+#if ABCC_CFG_ISR_STATS_ENABLED
+      par_sIsrStats.lNumDeferred++;
+#endif
+   }
+
+   return( iIntStatus & ~iDeferInts );
+}
+
+BOOL ABCC_ParIsIntDeferred( void )
+{
+   return( par_iDeferredInts != 0 );
+}
+#endif
+
+#if ABCC_CFG_ISR_STATS_ENABLED
+void ABCC_GetIsrStats( ABCC_IsrStatsType* psStats, BOOL fReset )
+{
+   static const ABCC_IsrStatsType sClearedStats = { 0 };
+   ABCC_PORT_UseCritical();
+
+   ABCC_PORT_EnterCritical();
+   *psStats = par_sIsrStats;
+   if( fReset )
+   {
+      par_sIsrStats = sClearedStats;
+   }
+   ABCC_PORT_ExitCritical();
+}
+#endif
+
 /*------------------------------------------------------------------------------
 ** pnABCC_DrvRun()
 **------------------------------------------------------------------------------
 */
 void ABCC_ParRunDriver( void )
 {
+   ABCC_PORT_UseCritical();
    ABCC_MainStateType eMainState = ABCC_GetMainState();
+   BOOL fRegSnapshot;
+   UINT16 iDeferredInts = 0;
 
    if( eMainState < ABCC_DRV_SETUP )
    {
@@ -91,7 +237,26 @@ void ABCC_ParRunDriver( void )
       return;
    }
 
-   if( ( ABCC_iInterruptEnableMask & ( ABP_INTMASK_WRMSGIEN | ABP_INTMASK_ANBRIEN ) ) == 0 )
+   /*
+   ** If all events are polled, read the buffer control and Anybus status
+   ** registers once and let all checks below use that snapshot instead of
+   ** reading them over the external bus again.
+   */
+   fRegSnapshot = ( ABCC_iInterruptEnableMask & ABCC_POLL_EVENT_INT_MASK ) == 0;
+   if( fRegSnapshot )
+   {
+      ABCC_DrvParTakeRegSnapshot();
+   }
+
+#if ABCC_CFG_INT_COALESCE_MASK
+   ABCC_PORT_EnterCritical();
+   iDeferredInts = par_iDeferredInts;
+   par_iDeferredInts = 0;
+   ABCC_PORT_ExitCritical();
+#endif
+
+   if( ( ( ABCC_iInterruptEnableMask & ( ABP_INTMASK_WRMSGIEN | ABP_INTMASK_ANBRIEN ) ) == 0 ) ||
+       ( iDeferredInts & ( ABP_INTSTATUS_WRMSGI | ABP_INTSTATUS_ANBRI ) ) )
    {
       ABCC_LinkCheckSendMessage();
    }
@@ -101,7 +266,8 @@ void ABCC_ParRunDriver( void )
       ABCC_TriggerRdPdUpdate();
    }
 
-   if( ( ABCC_iInterruptEnableMask & ABP_INTMASK_STATUSIEN ) == 0 )
+   if( ( ( ABCC_iInterruptEnableMask & ABP_INTMASK_STATUSIEN ) == 0 ) ||
+       ( iDeferredInts & ABP_INTSTATUS_STATUSI ) )
    {
       ABCC_TriggerAnbStatusUpdate();
    }
@@ -113,6 +279,11 @@ void ABCC_ParRunDriver( void )
 #if ABCC_CFG_DRV_CMD_SEQ_ENABLED
    ABCC_CmdSequencerExec();
 #endif
+
+   if( fRegSnapshot )
+   {
+      ABCC_DrvParReleaseRegSnapshot();
+   }
 }
 #if ABCC_CFG_INT_ENABLED
 void ABCC_ParISR( void )
@@ -121,6 +292,12 @@ void ABCC_ParISR( void )
    UINT16 iIntToHandleInISR;
    UINT16 iEventToHandleInCbf;
    ABCC_MainStateType eMainState;
+#if ABCC_CFG_ISR_STATS_ENABLED && defined( ABCC_PORT_GetTimestamp )
+   UINT32 lStartTime;
+   UINT32 lDuration;
+
+   lStartTime = ABCC_PORT_GetTimestamp();
+#endif
 
    eMainState = ABCC_GetMainState();
 
@@ -128,6 +305,9 @@ void ABCC_ParISR( void )
    ** Let the driver handle the interrupt and clear the interrupt register.
    */
    iIntStatus = pnABCC_DrvISR();
+#if ABCC_CFG_ISR_STATS_ENABLED
+   IsrStatsCountEvents( iIntStatus );
+#endif
 
    if( eMainState < ABCC_DRV_WAIT_COMMUNICATION_RDY )
    {
@@ -140,6 +320,10 @@ void ABCC_ParISR( void )
       return;
    }
 
+#if ABCC_CFG_INT_COALESCE_MASK
+   iIntStatus = CoalesceInts( iIntStatus );
+#endif
+
    /*
    ** Only handle event defined in ABCC_CFG_HANDLE_INT_IN_ISR_MASK
    ** Special case for sync. If sync is supported and the sync signal
@@ -190,6 +374,14 @@ void ABCC_ParISR( void )
          ABCC_CbfEvent( iEventToHandleInCbf );
       }
    }
+
+#if ABCC_CFG_ISR_STATS_ENABLED && defined( ABCC_PORT_GetTimestamp )
+   lDuration = ABCC_PORT_GetTimestamp() - lStartTime;
+   if( lDuration > par_sIsrStats.lMaxDuration )
+   {
+      par_sIsrStats.lMaxDuration = lDuration;
+   }
+#endif
 }
 #else
 void ABCC_ParISR( void )
@@ -57,6 +57,41 @@ static UINT16   par_drv_iSizeOfWritePd;
 
 static   UINT8    par_drv_bNbrOfCmds;          /* Number of commands supported by the application. */
 
+/*
+** Register snapshot, see ABCC_DrvParTakeRegSnapshot(). The values are in
+** native endian.
+*/
+static BOOL     par_drv_fRegSnapshot;
+static UINT16   par_drv_iBufCtrlSnapshot;
+static UINT16   par_drv_iAnbStatusSnapshot;
+
+#if ABCC_CFG_ISR_STATS_ENABLED
+/*
+** Number of interrupt status reads in the last ABCC_DrvParISR() call.
+*/
+static UINT16   par_drv_iIsrStatusReads;
+#endif
+
+#if ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED
+/*
+** Modified byte range of the write process data. iEnd is exclusive.
+*/
+typedef struct par_drv_WrPdRange
+{
+   UINT16 iStart;
+   UINT16 iEnd;
+}
+par_drv_WrPdRangeType;
+
+/*
+** Modified ranges sorted by offset, neither overlapping nor touching. One extra
+** entry is used while a range is inserted into a full list. No ranges means
+** that the whole write process data is written.
+*/
+static par_drv_WrPdRangeType par_drv_asWrPdDirty[ ABCC_CFG_PAR_WRPD_NUM_DIRTY_RANGES + 1 ];
+static UINT8 par_drv_bNumWrPdDirty;
+#endif
+
 static const    UINT16   iWRPDFlag     = 0x01;
 static const    UINT16   iRDPDFlag     = 0x02;
 static const    UINT16   iWRMSGFlag    = 0x04;
@@ -92,6 +127,56 @@ static const UINT16 iIntStatusAdrOffset =    ABP_INTSTATUS_ADR_OFFSET;
 
 #endif
 
+/*------------------------------------------------------------------------------
+** Returns the buffer control register, from the snapshot if one is taken.
+**------------------------------------------------------------------------------
+*/
+static UINT16 DrvParReadBufCtrl( void )
+{
+   UINT16 iBufCtrl;
+
+   if( par_drv_fRegSnapshot )
+   {
+      return( par_drv_iBufCtrlSnapshot );
+   }
+
+   iBufCtrl = ABCC_DrvRead16( iBufCtrlAdrOffset );
+   return( iLeExtBusTOi( iBufCtrl ) );
+}
+
+/*------------------------------------------------------------------------------
+** Returns the Anybus status register, from the snapshot if one is taken.
+**------------------------------------------------------------------------------
+*/
+static UINT16 DrvParReadAnbStatus( void )
+{
+   UINT16 iAnbStatus;
+
+   if( par_drv_fRegSnapshot )
+   {
+      return( par_drv_iAnbStatusSnapshot );
+   }
+
+   iAnbStatus = ABCC_DrvRead16( iAnbStatusAdrOffset );
+   return( iLeExtBusTOi( iAnbStatus ) );
+}
+
+void ABCC_DrvParTakeRegSnapshot( void )
+{
+   UINT16 iReg;
+
+   iReg = ABCC_DrvRead16( iBufCtrlAdrOffset );
+   par_drv_iBufCtrlSnapshot = iLeExtBusTOi( iReg );
+   iReg = ABCC_DrvRead16( iAnbStatusAdrOffset );
+   par_drv_iAnbStatusSnapshot = iLeExtBusTOi( iReg );
+   par_drv_fRegSnapshot = TRUE;
+}
+
+void ABCC_DrvParReleaseRegSnapshot( void )
+{
+   par_drv_fRegSnapshot = FALSE;
+}
+
 void ABCC_DrvParInit( UINT8 bOpmode )
 {
    (void)bOpmode;
@@ -100,6 +185,10 @@ void ABCC_DrvParInit( UINT8 bOpmode )
    par_drv_iSizeOfWritePd = 0;
    par_drv_bNbrOfCmds     = 0;
    par_drv_pbRdPdBuffer   = ABCC_DrvParallelGetRdPdBuffer();
+   par_drv_fRegSnapshot   = FALSE;
+#if ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED
+   par_drv_bNumWrPdDirty  = 0;
+#endif
 }
 
 
@@ -126,6 +215,9 @@ UINT16 ABCC_DrvParISR( void )
    ABCC_DrvWrite16( iIntStatusAdrOffset, iIntStatus );
    iIntStatus = ( iLeExtBusTOi( iIntStatus ) ) & ABCC_iInterruptEnableMask;
    iIntToHandle = iIntStatus;
+#if ABCC_CFG_ISR_STATS_ENABLED
+   par_drv_iIsrStatusReads = 1;
+#endif
 
    while( iIntStatus != 0 )
    {
@@ -133,10 +225,20 @@ UINT16 ABCC_DrvParISR( void )
     ABCC_DrvWrite16( iIntStatusAdrOffset, iIntStatus );
     iIntStatus = ( iLeExtBusTOi( iIntStatus ) ) & ABCC_iInterruptEnableMask;
     iIntToHandle |= iIntStatus;
+#if ABCC_CFG_ISR_STATS_ENABLED
+    par_drv_iIsrStatusReads++;
+#endif
    }
 
    return( iIntToHandle );
 }
+
+#if ABCC_CFG_ISR_STATS_ENABLED
+UINT16 ABCC_DrvParGetIsrStatusReads( void )
+{
+   return( par_drv_iIsrStatusReads );
+}
+#endif
 #else
 UINT16 ABCC_DrvParISR( void )
 {
@@ -212,6 +314,7 @@ BOOL ABCC_DrvParWriteMessage( ABP_MsgType* psWriteMsg )
    */
 
    ABCC_DrvWrite16( iBufCtrlAdrOffset, iTOiLeExtBus( iBufControlWriteFlags ) );
+   par_drv_iBufCtrlSnapshot |= iWRMSGFlag;
 #ifdef MSG_TIMING
    /*Toggle led for timing measurement*/
    GPIO_OUT0  = 1;
@@ -219,6 +322,117 @@ BOOL ABCC_DrvParWriteMessage( ABP_MsgType* psWriteMsg )
    return( TRUE );
 }
 
+#if ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED
+void ABCC_DrvParMarkWrPdDirty( UINT16 iOffset, UINT16 iSize )
+{
+   UINT16 iStart;
+   UINT16 iEnd;
+   UINT8  bFirst;
+   UINT8  bLast;
+   UINT8  bIndex;
+   UINT8  bMerge;
+   UINT16 iGap;
+   UINT16 iMinGap;
+
+   if( ( iSize == 0 ) || ( iOffset >= par_drv_iSizeOfWritePd ) )
+   {
+      return;
+   }
+
+   /*
+   ** Widen the range to whole 16 bit words of the interface.
+   */
+   iStart = iOffset & ~1u;
+   if( iSize > par_drv_iSizeOfWritePd - iOffset )
+   {
+      iEnd = par_drv_iSizeOfWritePd;
+   }
+   else
+   {
+      iEnd = ( iOffset + iSize + 1 ) & ~1u;
+      if( iEnd > par_drv_iSizeOfWritePd )
+      {
+         iEnd = par_drv_iSizeOfWritePd;
+      }
+   }
+
+   /*
+   ** Find the ranges that overlap or touch the new range and merge them into
+   ** one.
+   */
+   bFirst = 0;
+   while( ( bFirst < par_drv_bNumWrPdDirty ) &&
+          ( par_drv_asWrPdDirty[ bFirst ].iEnd < iStart ) )
+   {
+      bFirst++;
+   }
+
+   bLast = bFirst;
+   while( ( bLast < par_drv_bNumWrPdDirty ) &&
+          ( par_drv_asWrPdDirty[ bLast ].iStart <= iEnd ) )
+   {
+      if( par_drv_asWrPdDirty[ bLast ].iStart < iStart )
+      {
+         iStart = par_drv_asWrPdDirty[ bLast ].iStart;
+      }
+      if( par_drv_asWrPdDirty[ bLast ].iEnd > iEnd )
+      {
+         iEnd = par_drv_asWrPdDirty[ bLast ].iEnd;
+      }
+      bLast++;
+   }
+
+   /*
+   ** Replace the merged ranges [bFirst, bLast) with the new range.
+   */
+   if( bLast == bFirst )
+   {
+      for( bIndex = par_drv_bNumWrPdDirty; bIndex > bFirst; bIndex-- )
+      {
+         par_drv_asWrPdDirty[ bIndex ] = par_drv_asWrPdDirty[ bIndex - 1 ];
+      }
+      par_drv_bNumWrPdDirty++;
+   }
+   else if( bLast > bFirst + 1 )
+   {
+      for( bIndex = bLast; bIndex < par_drv_bNumWrPdDirty; bIndex++ )
+      {
+         par_drv_asWrPdDirty[ bIndex - ( bLast - bFirst - 1 ) ] = par_drv_asWrPdDirty[ bIndex ];
+      }
+      par_drv_bNumWrPdDirty -= bLast - bFirst - 1;
+   }
+
+   par_drv_asWrPdDirty[ bFirst ].iStart = iStart;
+   par_drv_asWrPdDirty[ bFirst ].iEnd = iEnd;
+
+   if( par_drv_bNumWrPdDirty > ABCC_CFG_PAR_WRPD_NUM_DIRTY_RANGES )
+   {
+      /*
+      ** Too many ranges, merge the two that are closest to each other. This
+      ** writes the least number of unmodified bytes.
+      */
+      bMerge = 0;
+      iMinGap = 0xFFFF;
+      for( bIndex = 0; bIndex + 1 < par_drv_bNumWrPdDirty; bIndex++ )
+      {
+         iGap = par_drv_asWrPdDirty[ bIndex + 1 ].iStart - par_drv_asWrPdDirty[ bIndex ].iEnd;
+         if( iGap < iMinGap )
+         {
+            iMinGap = iGap;
+            bMerge = bIndex;
+         }
+      }
+
+      par_drv_asWrPdDirty[ bMerge ].iEnd = par_drv_asWrPdDirty[ bMerge + 1 ].iEnd;
+      for( bIndex = bMerge + 1; bIndex + 1 < par_drv_bNumWrPdDirty; bIndex++ )
+      {
+         par_drv_asWrPdDirty[ bIndex ] = par_drv_asWrPdDirty[ bIndex + 1 ];
+      }
+      par_drv_bNumWrPdDirty--;
+   }
+}
+#endif
+
 void ABCC_DrvParWriteProcessData( void* pxProcessData )
 {
 
@@ -228,11 +442,41 @@ void ABCC_DrvParWriteProcessData( void* pxProcessData )
       ** Write process data.
       */
 #if !( ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED )
-      ABCC_HAL_ParallelWrite( ABP_WRPD_ADR_OFFSET,
-                              pxProcessData,
-                              par_drv_iSizeOfWritePd );
+#if ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED
+      if( par_drv_bNumWrPdDirty > 0 )
+      {
+         UINT8  bIndex;
+         UINT16 iStart;
+
+         /*
+         ** Only write the modified ranges.
+         */
+         for( bIndex = 0; bIndex < par_drv_bNumWrPdDirty; bIndex++ )
+         {
+#ifdef ABCC_SYS_16_BIT_CHAR
+            iStart = par_drv_asWrPdDirty[ bIndex ].iStart >> 1;
+#else
+            iStart = par_drv_asWrPdDirty[ bIndex ].iStart;
+#endif
+            ABCC_HAL_ParallelWrite( ABP_WRPD_ADR_OFFSET + iStart,
+                                    (UINT8*)pxProcessData + iStart,
+                                    par_drv_asWrPdDirty[ bIndex ].iEnd -
+                                    par_drv_asWrPdDirty[ bIndex ].iStart );
+         }
+         par_drv_bNumWrPdDirty = 0;
+      }
+      else
+#endif
+      {
+         ABCC_HAL_ParallelWrite( ABP_WRPD_ADR_OFFSET,
+                                 pxProcessData,
+                                 par_drv_iSizeOfWritePd );
+      }
 #else
       (void)pxProcessData;
+#if ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED
+      par_drv_bNumWrPdDirty = 0;
+#endif
 #endif
 
       /*
@@ -249,18 +493,14 @@ void ABCC_DrvParWriteProcessData( void* pxProcessData )
 
 BOOL ABCC_DrvParIsReadyForWriteMessage( void )
 {
-   UINT16 iBufControl;
-   iBufControl = ABCC_DrvRead16( iBufCtrlAdrOffset );
-
-   return( !( iLeExtBusTOi( iBufControl ) & iWRMSGFlag ) );
+   return( !( DrvParReadBufCtrl() & iWRMSGFlag ) );
 }
 
 
 BOOL ABCC_DrvParIsReadyForCmd( void )
 {
    UINT16 iBufControl;
-   iBufControl = ABCC_DrvRead16( iBufCtrlAdrOffset );
-   iBufControl = iLeExtBusTOi( iBufControl );
+   iBufControl = DrvParReadBufCtrl();
    return( !( iBufControl & iWRMSGFlag ) && ( iBufControl & iANBRFlag ) );
 }
 
@@ -287,6 +527,12 @@ void ABCC_DrvParSetPdSize( const UINT16 iReadPdSize, const UINT16 iWritePdSize )
    par_drv_iSizeOfReadPd = iReadPdSize;
    par_drv_iSizeOfWritePd = iWritePdSize;
    (void)par_drv_iSizeOfReadPd;
+#if ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED
+   /*
+   ** Ranges of the old mapping are meaningless, write everything next time.
+   */
+   par_drv_bNumWrPdDirty = 0;
+#endif
 }
 
 
@@ -312,12 +558,12 @@ UINT8 ABCC_DrvParGetAnybusState( void )
    /*
    ** Reading out the Anybus status.
    */
-   iAnbStatus = ABCC_DrvRead16( iAnbStatusAdrOffset );
+   iAnbStatus = DrvParReadAnbStatus();
 
    /*
    ** The Anybus state is stored in bits 0-2 of the read register.
    */
-   return( (UINT8)( iLeExtBusTOi( iAnbStatus ) & 0x07 ) );
+   return( (UINT8)( iAnbStatus & 0x07 ) );
 }
 
 
@@ -328,9 +574,9 @@ void* ABCC_DrvParReadProcessData( void )
    /*
    ** Check if the Anybus has updated the read process data.
    */
-   iBufctrl = ABCC_DrvRead16( iBufCtrlAdrOffset );
+   iBufctrl = DrvParReadBufCtrl();
 
-   if( iLeExtBusTOi( iBufctrl ) & iRDPDFlag  )
+   if( iBufctrl & iRDPDFlag  )
    {
       /*
       ** The RDPD flag must be set before we try to read the process data.
@@ -338,6 +584,7 @@ void* ABCC_DrvParReadProcessData( void )
       ** data available.
       */
       ABCC_DrvWrite16( iBufCtrlAdrOffset, iTOiLeExtBus( iRDPDFlag ) );
+      par_drv_iBufCtrlSnapshot &= ~iRDPDFlag;
 
       /*
       ** We have process data to read.
@@ -361,12 +608,25 @@ ABP_MsgType* ABCC_DrvParReadMessage( void )
 {
    UINT16 iBufctrl;
    UINT16 iMsgSize;
+   ABP_MsgHeaderType16 sHeader;
 
-   iBufctrl = ABCC_DrvRead16( iBufCtrlAdrOffset );
+   iBufctrl = DrvParReadBufCtrl();
 
-   if( iLeExtBusTOi( iBufctrl ) & iRDMSGFlag  )
+   if( iBufctrl & iRDMSGFlag  )
    {
-      DrvParSetMsgReceiverBuffer( ABCC_MemAlloc() );
+      /*
+      ** We have message data to read. First read the header to select a
+      ** buffer of suitable size and check the size of data area.
+      */
+      ABCC_DrvParallelRead( iRdMsgAdrOffset,
+                            &sHeader,
+                            ABCC_MSG_HEADER_TYPE_SIZEOF );
+
+      iMsgSize = iLeTOi( sHeader.iDataSize );
+
+      DrvParSetMsgReceiverBuffer(
+         ABCC_MemAllocRxMsg( ( ABCC_GetLowAddrOct( sHeader.iCmdReserved ) & ABP_MSG_HEADER_C_BIT ) != 0,
+                             iMsgSize ) );
 
       if( par_drv_uReadMessageData.psMsg == NULL )
       {
@@ -376,15 +636,7 @@ ABP_MsgType* ABCC_DrvParReadMessage( void )
          return( NULL );
       }
 
-      /*
-      ** We have message data to read. First read the header and check the size
-      ** of data area.
-      */
-      ABCC_DrvParallelRead( iRdMsgAdrOffset,
-                            par_drv_uReadMessageData.psMsg16,
-                            ABCC_MSG_HEADER_TYPE_SIZEOF );
-
-      iMsgSize = iLeTOi( par_drv_uReadMessageData.psMsg16->sHeader.iDataSize );
+      par_drv_uReadMessageData.psMsg16->sHeader = sHeader;
 
       if( ( iMsgSize <= ABCC_CFG_MAX_MSG_SIZE ) &&
           ( iMsgSize != 0 ) )
@@ -425,6 +677,7 @@ ABP_MsgType* ABCC_DrvParReadMessage( void )
       }
 
       ABCC_DrvWrite16( iBufCtrlAdrOffset, iTOiLeExtBus( iRDMSGFlag ) );
+      par_drv_iBufCtrlSnapshot &= ~iRDMSGFlag;
 
       return( par_drv_uReadMessageData.psMsg );
    }
@@ -466,8 +719,7 @@ BOOL ABCC_DrvParIsSupervised( void )
    /*
    ** Reading out the Anybus status.
    */
-   iAnbStatus = ABCC_DrvRead16( iAnbStatusAdrOffset );
-   iAnbStatus = iLeExtBusTOi( iAnbStatus );
+   iAnbStatus = DrvParReadAnbStatus();
 
    /*
    ** The Anybus supervision bis is stored in bit 3
@@ -482,8 +734,7 @@ UINT8 ABCC_DrvParGetAnbStatus( void )
    /*
    ** Reading out the Anybus status.
    */
-   iAnbStatus = ABCC_DrvRead16( iAnbStatusAdrOffset );
-   iAnbStatus = iLeExtBusTOi( iAnbStatus );
+   iAnbStatus = DrvParReadAnbStatus();
    return( (UINT8)iAnbStatus & 0xf );
 
 }
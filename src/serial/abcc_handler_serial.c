@@ -17,6 +17,7 @@
 #include "../abcc_handler.h"
 #include "../abcc_timer.h"
 #include "../abcc_command_sequencer.h"
+#include "../abcc_rx_dispatch.h"
 
 
 /*------------------------------------------------------------------------------
@@ -41,12 +42,29 @@ void ABCC_SerRunDriver( void )
       return;
    }
 
+#if ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED
+   if( ABCC_RxDispatchIsFull() )
+   {
+      /*
+      ** ABCC_RunDriverRx() has not dispatched the previous telegrams yet.
+      */
+      return;
+   }
+#endif
+
    ABCC_LinkRunDriverRx();
+#if ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED
+   /*
+   ** Hand the received telegram over to ABCC_RunDriverRx().
+   */
+   ABCC_RxDispatchCapture();
+#else
    ABCC_TriggerRdPdUpdate();
    ABCC_TriggerAnbStatusUpdate();
    ABCC_TriggerReceiveMessage();
 #if ABCC_CFG_DRV_CMD_SEQ_ENABLED
    ABCC_CmdSequencerExec();
+#endif
 #endif
    ABCC_CheckWrPdUpdate();
    ABCC_LinkCheckSendMessage();
@@ -35,6 +35,12 @@
 #define SER_CMD_STAT_REG_LEN ( ABP_UINT8_SIZEOF )
 #define SER_MSG_FRAG_LEN     ( 16 * ABP_UINT8_SIZEOF )
 #define SER_MSG_HEADER_LEN   ( 8 * ABP_UINT8_SIZEOF )
+
+/*
+** Offsets of the command and data size fields in the legacy message header.
+*/
+#define SER_MSG_HEADER_CMD_OFFSET          4
+#define SER_MSG_HEADER_DATA_SIZE_OFFSET    5
 #define SER_CRC_LEN          ( ABP_UINT16_SIZEOF )
 
 typedef struct
@@ -507,6 +513,7 @@ ABP_MsgType* ABCC_DrvSerRunDriverRx( void )
 {
    UINT16 iCalcCrc;
    UINT16 iReceivedCrc;
+   UINT16 iMsgSize;
 
    ABP_MsgType* psWriteMsg = NULL;
 
@@ -621,7 +628,16 @@ ABP_MsgType* ABCC_DrvSerRunDriverRx( void )
          {
             if( drv_psReadMessage == NULL )
             {
-               DrvSerSetMsgReceiverBuffer( ABCC_MemAlloc() );
+               /*
+               ** The first fragment starts with the legacy message header, use
+               ** it to select a buffer of suitable size. All fragments are
+               ** copied in full so the size is rounded up to whole fragments.
+               */
+               iMsgSize = drv_sRxTelegram.abRdMsg[ SER_MSG_HEADER_DATA_SIZE_OFFSET ];
+               iMsgSize = ( ( iMsgSize + SER_MSG_HEADER_LEN + SER_MSG_FRAG_LEN - 1 ) / SER_MSG_FRAG_LEN ) * SER_MSG_FRAG_LEN - SER_MSG_HEADER_LEN;
+               DrvSerSetMsgReceiverBuffer(
+                  ABCC_MemAllocRxMsg( ( drv_sRxTelegram.abRdMsg[ SER_MSG_HEADER_CMD_OFFSET ] & ABP_MSG_HEADER_C_BIT ) != 0,
+                                      iMsgSize ) );
 
                if( drv_psReadMessage == NULL )
                {
@@ -635,7 +651,7 @@ ABP_MsgType* ABCC_DrvSerRunDriverRx( void )
             /*
             ** Start receiving on legacy start position which corresponds to &drv_psReadMessage->sHeader.bSourceId
             */
-            drv_InitReadFrag( &sRxFragHandle, &drv_psReadMessage->sHeader.bSourceId, SER_MSG_FRAG_LEN, ABCC_CFG_MAX_MSG_SIZE + SER_MSG_HEADER_LEN );
+            drv_InitReadFrag( &sRxFragHandle, &drv_psReadMessage->sHeader.bSourceId, SER_MSG_FRAG_LEN, ABCC_MemGetBufferSize( drv_psReadMessage ) + SER_MSG_HEADER_LEN );
          }
 
          drv_AddReadFrag( &sRxFragHandle, drv_sRxTelegram.abRdMsg );
@@ -22,6 +22,7 @@
 #include "../abcc_handler.h"
 #include "../abcc_timer.h"
 #include "../abcc_command_sequencer.h"
+#include "../abcc_rx_dispatch.h"
 
 /*------------------------------------------------------------------------------
 ** pnABCC_DrvRun()
@@ -45,6 +46,17 @@ void ABCC_SpiRunDriver( void )
       return;
    }
 
+#if ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED
+   if( ABCC_RxDispatchIsFull() )
+   {
+      /*
+      ** ABCC_RunDriverRx() has not dispatched the previous frames yet. The
+      ** next transfer is started when there is room for its MISO frame.
+      */
+      return;
+   }
+#endif
+
    ABCC_CheckWrPdUpdate();
    ABCC_LinkCheckSendMessage();
 
@@ -70,12 +82,19 @@ void ABCC_SpiRunDriver( void )
    */
    ABCC_LinkRunDriverRx();
 
+#if ABCC_CFG_DRV_SPLIT_TX_RX_ENABLED
+   /*
+   ** Hand the received MISO frame over to ABCC_RunDriverRx().
+   */
+   ABCC_RxDispatchCapture();
+#else
    ABCC_TriggerRdPdUpdate();
    ABCC_TriggerAnbStatusUpdate();
    ABCC_TriggerReceiveMessage();
 #if ABCC_CFG_DRV_CMD_SEQ_ENABLED
    ABCC_CmdSequencerExec();
 #endif
+#endif
 }
 
 #if ABCC_CFG_INT_ENABLED
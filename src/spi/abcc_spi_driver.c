@@ -28,6 +28,15 @@
 
 #define ABCC_MSG_HEADER_TYPE_SIZEOF 12
 
+/*
+** ABCC_CFG_SPI_MSG_FRAG_LEN is in octets, the first fragment must hold the
+** complete 12 octet message header to select the buffer size class.
+*/
+#if ( ( ABCC_CFG_MEM_NUM_SMALL_MSG > 0 ) || ( ABCC_CFG_MEM_NUM_MEDIUM_MSG > 0 ) ) && \
+    ( ABCC_CFG_SPI_MSG_FRAG_LEN < ABCC_MSG_HEADER_TYPE_SIZEOF )
+#error "ABCC_CFG_SPI_MSG_FRAG_LEN must hold the message header when message buffer size classes are used"
+#endif
+
 /*------------------------------------------------------------------------------
 ** Since the masking of control registers are endian dependent since
 ** we operating on the mosi and misu structures that are little endian
@@ -128,6 +137,7 @@ typedef struct
   ABP_MsgType* psReadMsg;                 /* Pointer to the receive message buffer. */
   UINT16*            puCurrPtr;           /* Pointer to the current position in receive buffer. */
   UINT16             iNumWordsReceived;   /* Number of words received. */
+  UINT16             iMaxNumWords;        /* Size of the receive buffer in words. */
 } drv_SpiReadMsgFragInfoType;
 
 /*------------------------------------------------------------------------------
@@ -334,7 +344,9 @@ ABP_MsgType* ABCC_DrvSpiRunDriverRx( void )
 {
    UINT32 lRecievedCrc;
    UINT32 lCalculatedCrc;
+   UINT16 iNumWords;
    ABP_MsgType* psWriteMsg = NULL;
+   const ABP_MsgHeaderType16* psHeader;
 
    if( spi_drv_eState == SM_SPI_WAITING_FOR_MISO )
    {
@@ -448,7 +460,14 @@ ABP_MsgType* ABCC_DrvSpiRunDriverRx( void )
 
          if( spi_drv_sReadFragInfo.puCurrPtr == 0 )
          {
-            DrvSpiSetMsgReceiverBuffer( ABCC_MemAlloc() );
+            /*
+            ** The first fragment starts with the message header, use it to
+            ** select a buffer of suitable size.
+            */
+            psHeader = (const ABP_MsgHeaderType16*)spi_drv_sMisoFrame.iData;
+            DrvSpiSetMsgReceiverBuffer(
+               ABCC_MemAllocRxMsg( ( ABCC_GetLowAddrOct( psHeader->iCmdReserved ) & ABP_MSG_HEADER_C_BIT ) != 0,
+                                   iLeTOi( psHeader->iDataSize ) ) );
 
             if( spi_drv_sReadFragInfo.puCurrPtr == 0 )
             {
@@ -457,18 +476,26 @@ ABP_MsgType* ABCC_DrvSpiRunDriverRx( void )
             }
          }
 
-         if( ( ( spi_drv_sReadFragInfo.iNumWordsReceived + spi_drv_iMsgLen ) << 1 ) <=
-             ( ABCC_CFG_MAX_MSG_SIZE + ABCC_MSG_HEADER_TYPE_SIZEOF ) )
+         /*
+         ** Only copy the part of the fragment that fits in the buffer. The last
+         ** fragment is padded beyond the end of the message, and messages
+         ** exceeding the buffer size are handled in higher layers.
+         */
+         iNumWords = spi_drv_iMsgLen;
+
+         if( ( spi_drv_sReadFragInfo.iNumWordsReceived + iNumWords ) > spi_drv_sReadFragInfo.iMaxNumWords )
+         {
+            iNumWords = spi_drv_sReadFragInfo.iMaxNumWords - spi_drv_sReadFragInfo.iNumWordsReceived;
+         }
+
+         if( iNumWords > 0 )
          {
-            /*
-            ** Message fits in buffer so read it.
-            */
             ABCC_PORT_MemCpy( spi_drv_sReadFragInfo.puCurrPtr,
                               spi_drv_sMisoFrame.iData,
-                              spi_drv_iMsgLen << 1 );
+                              iNumWords << 1 );
 
-            spi_drv_sReadFragInfo.puCurrPtr += spi_drv_iMsgLen;
-            spi_drv_sReadFragInfo.iNumWordsReceived += spi_drv_iMsgLen;
+            spi_drv_sReadFragInfo.puCurrPtr += iNumWords;
+            spi_drv_sReadFragInfo.iNumWordsReceived += iNumWords;
          }
 
          if( spi_drv_sMisoFrame.iSpiStatusAnbStatus & iSpiStatusLastFrag )
@@ -529,6 +556,7 @@ static void spi_drv_DataReceived( void )
 static void spi_drv_ResetReadFragInfo( void )
 {
    spi_drv_sReadFragInfo.iNumWordsReceived = 0;
+   spi_drv_sReadFragInfo.iMaxNumWords = 0;
    spi_drv_sReadFragInfo.psReadMsg = NULL;
    spi_drv_sReadFragInfo.puCurrPtr = NULL;
 }
@@ -754,6 +782,12 @@ static void DrvSpiSetMsgReceiverBuffer( ABP_MsgType* const psReadMsg )
    #pragma GCC diagnostic pop
 #endif
       spi_drv_sReadFragInfo.iNumWordsReceived = 0;
+
+      if( psReadMsg != NULL )
+      {
+         spi_drv_sReadFragInfo.iMaxNumWords =
+            ( ABCC_MemGetBufferSize( psReadMsg ) + ABCC_MSG_HEADER_TYPE_SIZEOF ) >> 1;
+      }
    }
    else
    {
@@ -0,0 +1,50 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Host stand-in for abcc_types.h of the abcc-abp repository. Only used by the
+** test harness when the abcc-abp submodule is not checked out.
+********************************************************************************
+*/
+
+#ifndef ABCC_TYPES_H_
+#define ABCC_TYPES_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+typedef uint8_t   UINT8;
+typedef uint16_t  UINT16;
+typedef uint32_t  UINT32;
+typedef uint64_t  UINT64;
+typedef int8_t    INT8;
+typedef int16_t   INT16;
+typedef int32_t   INT32;
+typedef int64_t   INT64;
+typedef float     FLOAT32;
+typedef double    FLOAT64;
+typedef UINT8     BOOL;
+typedef UINT8     BOOL8;
+
+#ifndef TRUE
+#define TRUE      1
+#endif
+
+#ifndef FALSE
+#define FALSE     0
+#endif
+
+#define EXTFUNC   extern
+#define EXTVAR    extern
+
+#define PACKED_STRUCT __attribute__( ( packed ) )
+
+#define CPLUSPLUS_BEGIN
+#define CPLUSPLUS_END
+
+#define ABCC_SYS_PACK_ON
+#define ABCC_SYS_PACK_OFF
+
+#endif  /* inclusion lock */
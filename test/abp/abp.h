@@ -0,0 +1,275 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Host stand-in for abp.h of the abcc-abp repository. Only used by the test
+** harness when the abcc-abp submodule is not checked out.
+**
+** It declares just what the driver sources refer to. The message header layout
+** and the message header, segmentation and ANB status bits follow the Anybus
+** protocol. Object numbers, data types, operating modes and register offsets
+** only need to be distinct for the host tests and must not be used elsewhere.
+********************************************************************************
+*/
+
+#ifndef ABP_H_
+#define ABP_H_
+
+#include "abcc_types.h"
+
+/*------------------------------------------------------------------------------
+** Message sizes.
+**------------------------------------------------------------------------------
+*/
+#define ABP_MAX_MSG_255_DATA_BYTES           255
+#define ABP_MAX_MSG_DATA_BYTES               1524
+#define ABP_MAX_PROCESS_DATA                 4096
+
+/*------------------------------------------------------------------------------
+** Message header.
+**------------------------------------------------------------------------------
+*/
+#define ABP_MSG_HEADER_E_BIT                 0x80
+#define ABP_MSG_HEADER_C_BIT                 0x40
+#define ABP_MSG_HEADER_CMD_BITS              0x3F
+
+#define ABP_MSG_CMDEXT1_SEG_FIRST            0x01
+#define ABP_MSG_CMDEXT1_SEG_LAST             0x02
+#define ABP_MSG_CMDEXT1_SEG_ABORT            0x04
+
+typedef UINT8 ABP_MsgCmdType;
+typedef UINT8 ABP_MsgErrorCodeType;
+
+#define ABP_CMD_GET_ATTR                     0x01
+#define ABP_CMD_SET_ATTR                     0x02
+
+#define ABP_ERR_NO_RESOURCES                 0x0D
+
+typedef struct ABP_MsgHeaderType
+{
+   UINT16   iDataSize;
+   UINT16   iReserved;
+   UINT8    bSourceId;
+   UINT8    bDestObj;
+   UINT16   iInstance;
+   UINT8    bCmd;
+   UINT8    bReserved;
+   UINT8    bCmdExt0;
+   UINT8    bCmdExt1;
+}
+PACKED_STRUCT ABP_MsgHeaderType;
+
+typedef struct ABP_MsgHeaderType16
+{
+   UINT16   iDataSize;
+   UINT16   iReserved;
+   UINT16   iSourceIdDestObj;
+   UINT16   iInstance;
+   UINT16   iCmdReserved;
+   UINT16   iCmdExt0CmdExt1;
+}
+PACKED_STRUCT ABP_MsgHeaderType16;
+
+typedef struct ABP_MsgType
+{
+   ABP_MsgHeaderType sHeader;
+   UINT8    abData[ ABP_MAX_MSG_DATA_BYTES ];
+}
+PACKED_STRUCT ABP_MsgType;
+
+typedef struct ABP_MsgType16
+{
+   ABP_MsgHeaderType16 sHeader;
+   UINT16   aiData[ ABP_MAX_MSG_DATA_BYTES / 2 ];
+}
+PACKED_STRUCT ABP_MsgType16;
+
+#define ABP_SetMsgResponse( psMsg, iMsgDataSize )                              \
+   do                                                                          \
+   {                                                                           \
+      (psMsg)->sHeader.bCmd &= ~ABP_MSG_HEADER_C_BIT;                          \
+      (psMsg)->sHeader.iDataSize = (UINT16)(iMsgDataSize);                     \
+   }                                                                           \
+   while( 0 )
+
+#define ABP_SetMsgErrorResponse( psMsg, iMsgDataSize, eMsgErrorCode )          \
+   do                                                                          \
+   {                                                                           \
+      (psMsg)->sHeader.bCmd &= ~ABP_MSG_HEADER_C_BIT;                          \
+      (psMsg)->sHeader.bCmd |= ABP_MSG_HEADER_E_BIT;                           \
+      (psMsg)->sHeader.iDataSize = (UINT16)(iMsgDataSize);                     \
+      (psMsg)->abData[ 0 ] = (UINT8)(eMsgErrorCode);                           \
+   }                                                                           \
+   while( 0 )
+
+/*------------------------------------------------------------------------------
+** Objects and attributes.
+**------------------------------------------------------------------------------
+*/
+#define ABP_OBJ_NUM_ANB                      0x01
+#define ABP_OBJ_NUM_NW                       0x03
+#define ABP_OBJ_NUM_APPD                     0xFE
+
+#define ABP_ANB_IA_MODULE_TYPE               1
+#define ABP_ANB_IA_FW_VERSION                2
+#define ABP_ANB_IA_SETUP_COMPLETE            5
+
+#define ABP_NW_IA_NW_TYPE                    2
+#define ABP_NW_IA_DATA_FORMAT                5
+#define ABP_NW_IA_PARAM_SUPPORT              6
+#define ABP_NW_IA_WRITE_PD_SIZE              7
+#define ABP_NW_IA_READ_PD_SIZE               8
+
+#define ABP_NW_CMD_MAP_ADI_WRITE_EXT_AREA    0x17
+#define ABP_NW_CMD_MAP_ADI_READ_EXT_AREA     0x18
+
+#define ABP_NW_DATA_FORMAT_LSB_FIRST         0
+#define ABP_NW_DATA_FORMAT_MSB_FIRST         1
+
+#define ABP_APP_IA_FW_AVAILABLE              7
+
+#define ABP_APPD_REMAP_ADI_READ_AREA         0x14
+
+#define ABP_APPD_DESCR_GET_ACCESS            0x01
+#define ABP_APPD_DESCR_SET_ACCESS            0x02
+#define ABP_APPD_DESCR_MAPPABLE_WRITE_PD     0x08
+#define ABP_APPD_DESCR_MAPPABLE_READ_PD      0x10
+
+/*------------------------------------------------------------------------------
+** Data types.
+**------------------------------------------------------------------------------
+*/
+#define ABP_BOOL                             0
+#define ABP_SINT8                            1
+#define ABP_SINT16                           2
+#define ABP_SINT32                           3
+#define ABP_UINT8                            4
+#define ABP_UINT16                           5
+#define ABP_UINT32                           6
+#define ABP_CHAR                             7
+#define ABP_ENUM                             8
+#define ABP_BITS8                            9
+#define ABP_BITS16                           10
+#define ABP_BITS32                           11
+#define ABP_OCTET                            12
+#define ABP_SINT64                           16
+#define ABP_UINT64                           17
+#define ABP_FLOAT                            18
+#define ABP_DOUBLE                           19
+#define ABP_PAD0                             20
+#define ABP_PAD1                             21
+#define ABP_PAD2                             22
+#define ABP_PAD3                             23
+#define ABP_PAD4                             24
+#define ABP_PAD5                             25
+#define ABP_PAD6                             26
+#define ABP_PAD7                             27
+#define ABP_PAD8                             28
+#define ABP_PAD9                             29
+#define ABP_PAD10                            30
+#define ABP_PAD11                            31
+#define ABP_PAD12                            32
+#define ABP_PAD13                            33
+#define ABP_PAD14                            34
+#define ABP_PAD15                            35
+#define ABP_PAD16                            36
+#define ABP_BOOL1                            37
+#define ABP_BIT1                             38
+#define ABP_BIT2                             39
+#define ABP_BIT3                             40
+#define ABP_BIT4                             41
+#define ABP_BIT5                             42
+#define ABP_BIT6                             43
+#define ABP_BIT7                             44
+
+#define ABP_Is_PADx( x )                     ( ( (x) >= ABP_PAD0 ) && ( (x) <= ABP_PAD16 ) )
+#define ABP_Is_BITx( x )                     ( ( (x) >= ABP_BOOL1 ) && ( (x) <= ABP_BIT7 ) )
+
+#define ABP_UINT8_SIZEOF                     1
+#define ABP_UINT16_SIZEOF                    2
+#define ABP_UINT32_SIZEOF                    4
+#define ABP_UINT64_SIZEOF                    8
+#define ABP_DOUBLE_SIZEOF                    8
+
+/*------------------------------------------------------------------------------
+** Anybus state and application status.
+**------------------------------------------------------------------------------
+*/
+typedef UINT8 ABP_AnbStateType;
+typedef UINT8 ABP_AppStatusType;
+
+#define ABP_ANB_STATE_PROCESS_ACTIVE         4
+
+#define ABP_APPSTAT_NO_ERROR                 0
+
+#define ABP_STAT_S_BITS                      0x07
+#define ABP_STAT_SUP_BIT                     0x08
+#define ABP_STAT_R_BIT                       0x20
+#define ABP_STAT_M_BIT                       0x40
+
+#define ABP_CTRL_R_BIT                       0x20
+#define ABP_CTRL_M_BIT                       0x40
+#define ABP_CTRL_T_BIT                       0x80
+
+/*------------------------------------------------------------------------------
+** Operating modes and module id.
+**------------------------------------------------------------------------------
+*/
+#define ABP_OP_MODE_SPI                      1
+#define ABP_OP_MODE_16_BIT_PARALLEL          7
+#define ABP_OP_MODE_8_BIT_PARALLEL           8
+#define ABP_OP_MODE_SERIAL_19_2              9
+#define ABP_OP_MODE_SERIAL_57_6              10
+#define ABP_OP_MODE_SERIAL_115_2             11
+#define ABP_OP_MODE_SERIAL_625               12
+
+#define ABP_MODULE_ID_ACTIVE_ABCC40          2
+
+/*------------------------------------------------------------------------------
+** SPI control and status bits.
+**------------------------------------------------------------------------------
+*/
+#define ABP_SPI_CTRL_WRPD_VALID              0x01
+#define ABP_SPI_CTRL_CMDCNT                  0x06
+#define ABP_SPI_CTRL_M                       0x08
+#define ABP_SPI_CTRL_LAST_FRAG               0x10
+#define ABP_SPI_CTRL_T                       0x80
+
+#define ABP_SPI_STATUS_WRMSG_FULL            0x01
+#define ABP_SPI_STATUS_CMDCNT                0x06
+#define ABP_SPI_STATUS_M                     0x08
+#define ABP_SPI_STATUS_LAST_FRAG             0x10
+#define ABP_SPI_STATUS_NEW_PD                0x20
+
+/*------------------------------------------------------------------------------
+** Parallel interface memory map and registers.
+**------------------------------------------------------------------------------
+*/
+#define ABP_WRPD_ADR_OFFSET                  0x0000
+#define ABP_RDPD_ADR_OFFSET                  0x1000
+#define ABP_WRMSG_ADR_OFFSET                 0x2000
+#define ABP_RDMSG_ADR_OFFSET                 0x3000
+#define ABP_MODCAP_ADR_OFFSET                0x3FE0
+#define ABP_LEDSTATUS_ADR_OFFSET             0x3FE2
+#define ABP_APPSTATUS_ADR_OFFSET             0x3FF8
+#define ABP_ANBSTATUS_ADR_OFFSET             0x3FFA
+#define ABP_BUFCTRL_ADR_OFFSET               0x3FFC
+#define ABP_INTMASK_ADR_OFFSET               0x3FF4
+#define ABP_INTSTATUS_ADR_OFFSET             0x3FF6
+
+#define ABP_INTMASK_RDPDIEN                  0x01
+#define ABP_INTMASK_RDMSGIEN                 0x02
+#define ABP_INTMASK_WRMSGIEN                 0x04
+#define ABP_INTMASK_ANBRIEN                  0x08
+#define ABP_INTMASK_STATUSIEN                0x10
+#define ABP_INTMASK_SYNCIEN                  0x40
+
+#define ABP_INTSTATUS_RDPDI                  0x01
+#define ABP_INTSTATUS_RDMSGI                 0x02
+#define ABP_INTSTATUS_WRMSGI                 0x04
+#define ABP_INTSTATUS_ANBRI                  0x08
+#define ABP_INTSTATUS_STATUSI                0x10
+#define ABP_INTSTATUS_SYNCI                  0x40
+
+#endif  /* inclusion lock */
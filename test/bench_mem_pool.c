@@ -0,0 +1,195 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Message buffer pool stress benchmark.
+**
+** Several threads allocate and free message buffers as fast as they can while
+** a monitor thread reads the pool statistics. The benchmark reports the time
+** per allocate/free pair for 1, 2 and 4 threads and fails if the statistics
+** ever show more buffers in use than the pool holds, or if buffers are lost.
+**
+** Built once with the critical section pool and once with the lock-free pool,
+** see CMakeLists.txt.
+**
+** Usage: bench_mem_pool [iterations per thread]
+********************************************************************************
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc.h"
+#include "abcc_memory.h"
+
+#define BENCH_MAX_THREADS        4
+#define BENCH_BUFFERS_PER_THREAD 4
+
+static UINT32 bench_lIterations = 200000;
+static volatile BOOL bench_fRunning;
+static volatile BOOL bench_fStatsBroken;
+static UINT32 bench_alAllocFailures[ BENCH_MAX_THREADS ];
+
+static UINT64 NowNs( void )
+{
+   struct timespec sNow;
+
+   clock_gettime( CLOCK_MONOTONIC, &sNow );
+   return( (UINT64)sNow.tv_sec * 1000000000u + (UINT64)sNow.tv_nsec );
+}
+
+/*------------------------------------------------------------------------------
+** Allocates and frees buffers, holding up to BENCH_BUFFERS_PER_THREAD of them
+** at a time.
+**------------------------------------------------------------------------------
+*/
+static void* Worker( void* pxArg )
+{
+   ABP_MsgType* apsHeld[ BENCH_BUFFERS_PER_THREAD ] = { NULL };
+   UINT32 lThread = (UINT32)(size_t)pxArg;
+   UINT32 lSeed = lThread + 1;
+   UINT32 lFailures = 0;
+   UINT32 i;
+   UINT16 iSlot;
+
+   for( i = 0; i < bench_lIterations; i++ )
+   {
+      lSeed = lSeed * 1103515245u + 12345u;
+      iSlot = (UINT16)( ( lSeed >> 16 ) % BENCH_BUFFERS_PER_THREAD );
+
+      if( apsHeld[ iSlot ] != NULL )
+      {
+         ABCC_MemFree( &apsHeld[ iSlot ] );
+      }
+
+      apsHeld[ iSlot ] = ABCC_MemAlloc( (UINT16)( ( lSeed >> 8 ) % ABCC_CFG_MAX_MSG_SIZE ) );
+      if( apsHeld[ iSlot ] == NULL )
+      {
+         lFailures++;
+      }
+   }
+
+   for( iSlot = 0; iSlot < BENCH_BUFFERS_PER_THREAD; iSlot++ )
+   {
+      if( apsHeld[ iSlot ] != NULL )
+      {
+         ABCC_MemFree( &apsHeld[ iSlot ] );
+      }
+   }
+
+   bench_alAllocFailures[ lThread ] = lFailures;
+
+   return( NULL );
+}
+
+/*------------------------------------------------------------------------------
+** Checks the pool statistics while the workers run.
+**------------------------------------------------------------------------------
+*/
+static void* Monitor( void* pxArg )
+{
+   ABCC_MemStatsType sStats;
+   UINT8 bClass;
+
+   (void)pxArg;
+
+   while( bench_fRunning )
+   {
+      for( bClass = 0; ABCC_MemGetStats( bClass, &sStats ); bClass++ )
+      {
+         if( ( sStats.iNumFree > sStats.iNumBuffers ) ||
+             ( sStats.iMaxNumUsed > sStats.iNumBuffers ) )
+         {
+            bench_fStatsBroken = TRUE;
+         }
+      }
+
+      sched_yield();
+   }
+
+   return( NULL );
+}
+
+static BOOL RunThreads( UINT32 lNumThreads )
+{
+   pthread_t axWorker[ BENCH_MAX_THREADS ];
+   pthread_t xMonitor;
+   ABCC_MemStatsType sStats;
+   UINT32 lFailures = 0;
+   UINT64 llStartNs;
+   UINT64 llElapsedNs;
+   UINT32 i;
+   UINT8 bClass;
+   BOOL fOk = TRUE;
+
+   ABCC_MemCreatePool();
+   bench_fStatsBroken = FALSE;
+   bench_fRunning = TRUE;
+   pthread_create( &xMonitor, NULL, Monitor, NULL );
+
+   llStartNs = NowNs();
+   for( i = 0; i < lNumThreads; i++ )
+   {
+      pthread_create( &axWorker[ i ], NULL, Worker, (void*)(size_t)i );
+   }
+   for( i = 0; i < lNumThreads; i++ )
+   {
+      pthread_join( axWorker[ i ], NULL );
+      lFailures += bench_alAllocFailures[ i ];
+   }
+   llElapsedNs = NowNs() - llStartNs;
+
+   bench_fRunning = FALSE;
+   pthread_join( xMonitor, NULL );
+
+   for( bClass = 0; ABCC_MemGetStats( bClass, &sStats ); bClass++ )
+   {
+      if( sStats.iNumFree != sStats.iNumBuffers )
+      {
+         printf( "  class %u: %u of %u buffers returned\n",
+                 bClass, sStats.iNumFree, sStats.iNumBuffers );
+         fOk = FALSE;
+      }
+   }
+
+   if( bench_fStatsBroken )
+   {
+      printf( "  statistics showed more buffers in use than available\n" );
+      fOk = FALSE;
+   }
+
+   printf( "%u thread(s): %7.1f ns per alloc/free, %" PRIu32 " empty pool\n",
+           lNumThreads,
+           (double)llElapsedNs / ( (double)bench_lIterations * lNumThreads ),
+           lFailures );
+
+   return( fOk );
+}
+
+int main( int argc, char** argv )
+{
+   BOOL fOk = TRUE;
+
+   if( argc > 1 )
+   {
+      bench_lIterations = (UINT32)strtoul( argv[ 1 ], NULL, 0 );
+   }
+
+   printf( "%s pool, %u buffers, %" PRIu32 " iterations per thread\n",
+           ABCC_CFG_MEM_LOCK_FREE_POOL_ENABLED ? "Lock-free" : "Critical section",
+           ABCC_CFG_MAX_NUM_MSG_RESOURCES,
+           bench_lIterations );
+
+   fOk &= RunThreads( 1 );
+   fOk &= RunThreads( 2 );
+   fOk &= RunThreads( 4 );
+
+   return( fOk ? EXIT_SUCCESS : EXIT_FAILURE );
+}
@@ -0,0 +1,197 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Polled driver cycle benchmark.
+**
+** Runs ABCC_RunDriver() on the simulated 8 bit parallel interface, polled, and
+** counts the 16 bit register reads per cycle in four cases:
+**
+** - Idle, nothing to read or send.
+** - New read process data every cycle.
+** - A command from the module every cycle, answered by the application.
+** - Both of the above.
+**
+** The same cycle without the register snapshot of ABCC_ParRunDriver(), as
+** the driver ran it before, is built into the benchmark as a reference. The
+** time per ABCC_RunDriver() cycle is measured as well, built once with the
+** low level driver called through function pointers and once with
+** ABCC_CFG_DRV_STATIC_BINDING_ENABLED.
+**
+** Usage: bench_run_driver [cycles per run]
+********************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc.h"
+#include "abcc_handler.h"
+#include "abcc_link.h"
+#include "abcc_hal_stub.h"
+
+/*
+** Buffer control flags of the parallel interface.
+*/
+#define BENCH_BUFCTRL_RDPD    0x02
+#define BENCH_BUFCTRL_RDMSG   0x08
+#define BENCH_BUFCTRL_ANBR    0x10
+
+#define BENCH_PD_SIZE         8
+
+static UINT32 bench_lCycles = 100000;
+
+/*
+** Test case, the buffer control flags set by the module every cycle.
+*/
+typedef struct BenchCaseType
+{
+   const char* pcName;
+   UINT16 iBufCtrl;
+}
+BenchCaseType;
+
+static const BenchCaseType bench_asCases[] =
+{
+   { "idle",                 BENCH_BUFCTRL_ANBR },
+   { "read PD",              BENCH_BUFCTRL_ANBR | BENCH_BUFCTRL_RDPD },
+   { "command",              BENCH_BUFCTRL_ANBR | BENCH_BUFCTRL_RDMSG },
+   { "read PD + command",    BENCH_BUFCTRL_ANBR | BENCH_BUFCTRL_RDPD | BENCH_BUFCTRL_RDMSG }
+};
+
+static UINT64 NowNs( void )
+{
+   struct timespec sNow;
+
+   clock_gettime( CLOCK_MONOTONIC, &sNow );
+   return( (UINT64)sNow.tv_sec * 1000000000u + (UINT64)sNow.tv_nsec );
+}
+
+/*------------------------------------------------------------------------------
+** The polled cycle of ABCC_ParRunDriver() before the register snapshot. Every
+** check reads the registers it needs over the bus.
+**------------------------------------------------------------------------------
+*/
+static void RefRunDriver( void )
+{
+   ABCC_LinkCheckSendMessage();
+   ABCC_TriggerRdPdUpdate();
+   ABCC_TriggerAnbStatusUpdate();
+   ABCC_TriggerReceiveMessage();
+}
+
+/*------------------------------------------------------------------------------
+** Places a Get_Attribute command from the module in the read message area.
+**------------------------------------------------------------------------------
+*/
+static void PutModuleCmd( UINT8 bSourceId )
+{
+   ABP_MsgType* psCmd = (ABP_MsgType*)&hal_stub_abParMem[ ABP_RDMSG_ADR_OFFSET ];
+
+   memset( &psCmd->sHeader, 0, sizeof( psCmd->sHeader ) );
+   psCmd->sHeader.bSourceId = bSourceId;
+   psCmd->sHeader.bDestObj = ABP_OBJ_NUM_APPD;
+   psCmd->sHeader.iInstance = 1;
+   psCmd->sHeader.bCmd = ABP_MSG_HEADER_C_BIT | ABP_CMD_GET_ATTR;
+}
+
+/*------------------------------------------------------------------------------
+** Runs bench_lCycles cycles of a test case.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psCase      - Test case.
+**    pnRun       - Driver cycle to run, NULL for ABCC_RunDriver().
+**    prNs        - Returns the average time per cycle in ns.
+**
+** Returns:
+**    Average register reads per cycle, -1 if the driver reported an error.
+**------------------------------------------------------------------------------
+*/
+static double Run( const BenchCaseType* psCase, void ( *pnRun )( void ), double* prNs )
+{
+   UINT32 lCycle;
+   UINT64 llStartNs;
+   BOOL fOk = TRUE;
+
+   HAL_StubSetReg16( ABP_BUFCTRL_ADR_OFFSET, psCase->iBufCtrl );
+   HAL_StubResetCounters();
+   llStartNs = NowNs();
+
+   for( lCycle = 0; lCycle < bench_lCycles; lCycle++ )
+   {
+      if( psCase->iBufCtrl & BENCH_BUFCTRL_RDMSG )
+      {
+         PutModuleCmd( (UINT8)lCycle );
+      }
+
+      if( pnRun == NULL )
+      {
+         fOk &= ( ABCC_RunDriver() == ABCC_EC_NO_ERROR );
+      }
+      else
+      {
+         pnRun();
+      }
+   }
+
+   *prNs = (double)( NowNs() - llStartNs ) / bench_lCycles;
+   return( fOk ? (double)hal_stub_sParCounters.lNumRegReads / bench_lCycles : -1.0 );
+}
+
+int main( int argc, char** argv )
+{
+   double rDriver;
+   double rRef;
+   double rDriverNs;
+   double rRefNs;
+   UINT8 bCase;
+   BOOL fOk = TRUE;
+
+   if( argc > 1 )
+   {
+      bench_lCycles = (UINT32)strtoul( argv[ 1 ], NULL, 0 );
+   }
+
+   HAL_StubSetReg16( ABP_ANBSTATUS_ADR_OFFSET, ABP_ANB_STATE_PROCESS_ACTIVE );
+   HAL_StubSetReg16( ABP_BUFCTRL_ADR_OFFSET, BENCH_BUFCTRL_ANBR );
+
+   fOk &= ( ABCC_HwInit() == ABCC_EC_NO_ERROR );
+   fOk &= ( ABCC_StartDriver( 0 ) == ABCC_EC_NO_ERROR );
+   ABCC_RunTimerSystem( 1000 );
+   ABCC_RunTimerSystem( ABCC_CFG_STARTUP_TIME_MS );
+   fOk &= ( ABCC_isReadyForCommunication() == ABCC_READY_FOR_COMMUNICATION );
+   ABCC_SetPdSize( BENCH_PD_SIZE, BENCH_PD_SIZE );
+
+   if( !fOk )
+   {
+      printf( "Driver start failed\n" );
+      return( EXIT_FAILURE );
+   }
+
+   /*
+   ** Let the driver send the first command of its setup sequence, which the
+   ** simulated module never answers.
+   */
+   (void)ABCC_RunDriver();
+
+   printf( "%" PRIu32 " cycles per run, %s binding, per cycle:\n",
+           bench_lCycles,
+           ABCC_CFG_DRV_STATIC_BINDING_ENABLED ? "static" : "dynamic" );
+
+   for( bCase = 0; bCase < sizeof( bench_asCases ) / sizeof( bench_asCases[ 0 ] ); bCase++ )
+   {
+      rDriver = Run( &bench_asCases[ bCase ], NULL, &rDriverNs );
+      rRef = Run( &bench_asCases[ bCase ], RefRunDriver, &rRefNs );
+      printf( "%-20s reads %4.1f, reference reads %4.1f, ABCC_RunDriver() %6.1f ns\n",
+              bench_asCases[ bCase ].pcName, rDriver, rRef, rDriverNs );
+      fOk &= ( rDriver >= 0.0 );
+   }
+
+   return( fOk ? EXIT_SUCCESS : EXIT_FAILURE );
+}
@@ -0,0 +1,237 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Response handler lookup benchmark.
+**
+** Measures the time to find a free source id, map its response handler and
+** fetch the handler again when the response arrives, with 2, 16 and 64
+** commands outstanding. The driver's source id indexed table is compared with
+** the linear search table the driver used before, which is kept here as a
+** reference. Responses are taken oldest first.
+**
+** Usage: bench_src_id_lookup [commands per run]
+********************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc.h"
+#include "abcc_port.h"
+#include "abcc_link.h"
+
+#define BENCH_MAX_OUTSTANDING    64
+
+#if ABCC_CFG_MAX_NUM_APPL_CMDS < BENCH_MAX_OUTSTANDING
+#error "bench_src_id_lookup needs ABCC_CFG_MAX_NUM_APPL_CMDS >= 64"
+#endif
+
+/*
+** Reference table, same size as the driver's handler limit.
+*/
+#define REF_MAX_NUM_MSG_HDL      ( ABCC_CFG_MAX_NUM_APPL_CMDS + 1 )
+
+static ABCC_MsgHandlerFuncType ref_pnMsgHandler[ REF_MAX_NUM_MSG_HDL ];
+static UINT8                   ref_bMsgSrcId[ REF_MAX_NUM_MSG_HDL ];
+
+static UINT32 bench_lIterations = 1000000;
+static UINT8 bench_bSourceId;
+
+/*
+** Interface shared by the driver and the reference table.
+*/
+typedef struct BenchTableType
+{
+   const char* pcName;
+   BOOL ( *pnIsSrcIdUsed )( UINT8 bSrcId );
+   ABCC_ErrorCodeType ( *pnMap )( UINT8 bSrcId, ABCC_MsgHandlerFuncType pnHandler );
+   ABCC_MsgHandlerFuncType ( *pnGet )( UINT8 bSrcId );
+}
+BenchTableType;
+
+static void HandlerEven( ABP_MsgType* psMsg )
+{
+   (void)psMsg;
+}
+
+static void HandlerOdd( ABP_MsgType* psMsg )
+{
+   (void)psMsg;
+}
+
+static UINT64 NowNs( void )
+{
+   struct timespec sNow;
+
+   clock_gettime( CLOCK_MONOTONIC, &sNow );
+   return( (UINT64)sNow.tv_sec * 1000000000u + (UINT64)sNow.tv_nsec );
+}
+
+static ABCC_ErrorCodeType RefMap( UINT8 bSrcId, ABCC_MsgHandlerFuncType pnHandler )
+{
+   UINT16 iIndex;
+   ABCC_ErrorCodeType eResult = ABCC_EC_NO_RESOURCES;
+   ABCC_PORT_MSG_HANDLER_UseCritical();
+
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   for( iIndex = 0; iIndex < REF_MAX_NUM_MSG_HDL; iIndex++ )
+   {
+      if( ref_pnMsgHandler[ iIndex ] == NULL )
+      {
+         ref_pnMsgHandler[ iIndex ] = pnHandler;
+         ref_bMsgSrcId[ iIndex ] = bSrcId;
+         eResult = ABCC_EC_NO_ERROR;
+         break;
+      }
+   }
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
+
+   return( eResult );
+}
+
+static ABCC_MsgHandlerFuncType RefGet( UINT8 bSrcId )
+{
+   UINT16 iIndex;
+   ABCC_MsgHandlerFuncType pnHandler = NULL;
+   ABCC_PORT_MSG_HANDLER_UseCritical();
+
+   ABCC_PORT_MSG_HANDLER_EnterCritical();
+   for( iIndex = 0; iIndex < REF_MAX_NUM_MSG_HDL; iIndex++ )
+   {
+      if( ( ref_pnMsgHandler[ iIndex ] != NULL ) && ( ref_bMsgSrcId[ iIndex ] == bSrcId ) )
+      {
+         pnHandler = ref_pnMsgHandler[ iIndex ];
+         ref_pnMsgHandler[ iIndex ] = NULL;
+         break;
+      }
+   }
+   ABCC_PORT_MSG_HANDLER_ExitCritical();
+
+   return( pnHandler );
+}
+
+static BOOL RefIsSrcIdUsed( UINT8 bSrcId )
+{
+   UINT16 iIndex;
+
+   for( iIndex = 0; iIndex < REF_MAX_NUM_MSG_HDL; iIndex++ )
+   {
+      if( ( ref_pnMsgHandler[ iIndex ] != NULL ) && ( ref_bMsgSrcId[ iIndex ] == bSrcId ) )
+      {
+         return( TRUE );
+      }
+   }
+
+   return( FALSE );
+}
+
+static const BenchTableType bench_asTables[] =
+{
+   { "linear search (reference)", RefIsSrcIdUsed, RefMap, RefGet },
+   { "indexed by source id",      ABCC_LinkIsSrcIdUsed, ABCC_LinkMapMsgHandler, ABCC_LinkGetMsgHandler }
+};
+
+/*------------------------------------------------------------------------------
+** Finds the next unused source id, as ABCC_GetNewSourceId() does.
+**------------------------------------------------------------------------------
+*/
+static UINT8 NewSourceId( const BenchTableType* psTable )
+{
+   do
+   {
+      bench_bSourceId++;
+   }
+   while( psTable->pnIsSrcIdUsed( bench_bSourceId ) );
+
+   return( bench_bSourceId );
+}
+
+static ABCC_MsgHandlerFuncType HandlerOf( UINT8 bSrcId )
+{
+   return( ( bSrcId & 1 ) ? HandlerOdd : HandlerEven );
+}
+
+/*------------------------------------------------------------------------------
+** Sends and completes commands with iNumOutstanding commands kept outstanding.
+**------------------------------------------------------------------------------
+** Returns:
+**    ns per command, negative if a handler was lost or mixed up.
+**------------------------------------------------------------------------------
+*/
+static double Run( const BenchTableType* psTable, UINT16 iNumOutstanding )
+{
+   UINT8 abOutstanding[ BENCH_MAX_OUTSTANDING ];
+   UINT64 llStartNs;
+   UINT64 llElapsedNs;
+   UINT32 i;
+   UINT16 iOldest = 0;
+   UINT8 bSrcId;
+   BOOL fOk = TRUE;
+
+   bench_bSourceId = 0;
+
+   for( i = 0; i < iNumOutstanding; i++ )
+   {
+      bSrcId = NewSourceId( psTable );
+      fOk &= ( psTable->pnMap( bSrcId, HandlerOf( bSrcId ) ) == ABCC_EC_NO_ERROR );
+      abOutstanding[ i ] = bSrcId;
+   }
+
+   llStartNs = NowNs();
+   for( i = 0; i < bench_lIterations; i++ )
+   {
+      bSrcId = NewSourceId( psTable );
+      fOk &= ( psTable->pnMap( bSrcId, HandlerOf( bSrcId ) ) == ABCC_EC_NO_ERROR );
+      fOk &= ( psTable->pnGet( abOutstanding[ iOldest ] ) == HandlerOf( abOutstanding[ iOldest ] ) );
+      abOutstanding[ iOldest ] = bSrcId;
+      iOldest = ( iOldest + 1 ) % iNumOutstanding;
+   }
+   llElapsedNs = NowNs() - llStartNs;
+
+   for( i = 0; i < iNumOutstanding; i++ )
+   {
+      fOk &= ( psTable->pnGet( abOutstanding[ i ] ) != NULL );
+   }
+
+   return( fOk ? (double)llElapsedNs / bench_lIterations : -1.0 );
+}
+
+int main( int argc, char** argv )
+{
+   static const UINT16 aiNumOutstanding[] = { 2, 16, 64 };
+   double rNs;
+   UINT8 bTable;
+   UINT8 bRun;
+   BOOL fOk = TRUE;
+
+   if( argc > 1 )
+   {
+      bench_lIterations = (UINT32)strtoul( argv[ 1 ], NULL, 0 );
+   }
+
+   ABCC_LinkInit();
+
+   printf( "%" PRIu32 " commands per run, ns per source id + map + lookup\n",
+           bench_lIterations );
+
+   for( bTable = 0; bTable < sizeof( bench_asTables ) / sizeof( bench_asTables[ 0 ] ); bTable++ )
+   {
+      for( bRun = 0; bRun < sizeof( aiNumOutstanding ) / sizeof( aiNumOutstanding[ 0 ] ); bRun++ )
+      {
+         rNs = Run( &bench_asTables[ bTable ], aiNumOutstanding[ bRun ] );
+         printf( "%-26s %2u outstanding: %6.1f\n",
+                 bench_asTables[ bTable ].pcName,
+                 aiNumOutstanding[ bRun ],
+                 rNs );
+         fOk &= ( rNs >= 0.0 );
+      }
+   }
+
+   return( fOk ? EXIT_SUCCESS : EXIT_FAILURE );
+}
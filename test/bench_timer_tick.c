@@ -0,0 +1,232 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Timer tick benchmark.
+**
+** Measures ABCC_TimerTick() with 3, 64 and 512 running timers, once with no
+** timer expiring and once with one timer expiring per tick and restarted
+** after it. The linear timer table that the driver used before the heap is
+** built into the benchmark as a reference, with the same lock.
+**
+** Usage: bench_timer_tick [ticks per run]
+********************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abcc_port.h"
+#include "abcc_timer.h"
+
+#define BENCH_MAX_TIMERS      512
+
+#if ABCC_CFG_MAX_NUM_TIMERS < BENCH_MAX_TIMERS
+#error "bench_timer_tick needs ABCC_CFG_MAX_NUM_TIMERS >= 512"
+#endif
+
+/*
+** Long enough for no timer to expire during a run.
+*/
+#define BENCH_NO_TMO_MS       0x40000000UL
+
+/*
+** Reference timer, as in the linear timer table.
+*/
+typedef struct RefTimerType
+{
+   BOOL  fActive;
+   BOOL  fTmoOccured;
+   INT32 lTimeLeft;
+   ABCC_TimerTimeoutCallbackType pnHandleTimeout;
+}
+RefTimerType;
+
+static RefTimerType ref_asTimer[ BENCH_MAX_TIMERS ];
+static UINT16 ref_iNumTimers;
+
+static UINT32 bench_lTicks = 1000000;
+static UINT32 bench_lNumTimeouts;
+
+/*
+** Interface shared by the driver and the reference table.
+*/
+typedef struct BenchTimersType
+{
+   const char* pcName;
+   BOOL ( *pnStart )( ABCC_TimerHandle xHandle, UINT32 lTimeoutMs );
+   BOOL ( *pnStop )( ABCC_TimerHandle xHandle );
+   void ( *pnTick )( const INT16 iDeltaTimeMs );
+}
+BenchTimersType;
+
+static void TimeoutHandler( void )
+{
+   bench_lNumTimeouts++;
+}
+
+static UINT64 NowNs( void )
+{
+   struct timespec sNow;
+
+   clock_gettime( CLOCK_MONOTONIC, &sNow );
+   return( (UINT64)sNow.tv_sec * 1000000000u + (UINT64)sNow.tv_nsec );
+}
+
+static BOOL RefStart( ABCC_TimerHandle xHandle, UINT32 lTimeoutMs )
+{
+   BOOL fTmo;
+   ABCC_PORT_TIMER_UseCritical();
+
+   ABCC_PORT_TIMER_EnterCritical();
+   fTmo = ref_asTimer[ xHandle ].fTmoOccured;
+   ref_asTimer[ xHandle ].lTimeLeft = (INT32)lTimeoutMs;
+   ref_asTimer[ xHandle ].fTmoOccured = FALSE;
+   ref_asTimer[ xHandle ].fActive = TRUE;
+   ABCC_PORT_TIMER_ExitCritical();
+
+   return( fTmo );
+}
+
+static BOOL RefStop( ABCC_TimerHandle xHandle )
+{
+   BOOL fTmo;
+   ABCC_PORT_TIMER_UseCritical();
+
+   ABCC_PORT_TIMER_EnterCritical();
+   fTmo = ref_asTimer[ xHandle ].fTmoOccured;
+   ref_asTimer[ xHandle ].fActive = FALSE;
+   ref_asTimer[ xHandle ].fTmoOccured = FALSE;
+   ABCC_PORT_TIMER_ExitCritical();
+
+   return( fTmo );
+}
+
+static void RefTick( const INT16 iDeltaTimeMs )
+{
+   UINT16 iTimer;
+   ABCC_PORT_TIMER_UseCritical();
+
+   ABCC_PORT_TIMER_EnterCritical();
+   for( iTimer = 0; iTimer < ref_iNumTimers; iTimer++ )
+   {
+      if( ( ref_asTimer[ iTimer ].pnHandleTimeout != NULL ) &&
+          ( ref_asTimer[ iTimer ].fActive == TRUE ) )
+      {
+         ref_asTimer[ iTimer ].lTimeLeft -= (INT32)iDeltaTimeMs;
+         if( ref_asTimer[ iTimer ].lTimeLeft <= 0 )
+         {
+            ref_asTimer[ iTimer ].fTmoOccured = TRUE;
+            ref_asTimer[ iTimer ].fActive = FALSE;
+            ref_asTimer[ iTimer ].pnHandleTimeout();
+         }
+      }
+   }
+   ABCC_PORT_TIMER_ExitCritical();
+}
+
+static const BenchTimersType bench_asTimers[] =
+{
+   { "Linear table (reference)", RefStart, RefStop, RefTick },
+   { "Heap (driver)",            ABCC_TimerStart, ABCC_TimerStop, ABCC_TimerTick }
+};
+
+/*------------------------------------------------------------------------------
+** Runs bench_lTicks ticks of 1 ms.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psTimers    - Timers to measure.
+**    iNumTimers  - Number of running timers, each one of handle 0 and up.
+**    fExpire     - TRUE to let one timer expire per tick. Timer n is then
+**                  started with n + 1 ms and restarted with iNumTimers ms when
+**                  it has expired, so exactly one timer expires per tick.
+**
+** Returns:
+**    ns per tick, -1 if the timers did not expire as expected.
+**------------------------------------------------------------------------------
+*/
+static double Run( const BenchTimersType* psTimers, UINT16 iNumTimers, BOOL fExpire )
+{
+   UINT16 iTimer;
+   UINT32 lTick;
+   UINT64 llStartNs;
+   UINT64 llElapsedNs;
+
+   ref_iNumTimers = iNumTimers;
+
+   for( iTimer = 0; iTimer < iNumTimers; iTimer++ )
+   {
+      (void)psTimers->pnStart( iTimer, fExpire ? iTimer + 1u : BENCH_NO_TMO_MS );
+   }
+
+   bench_lNumTimeouts = 0;
+   llStartNs = NowNs();
+   for( lTick = 0; lTick < bench_lTicks; lTick++ )
+   {
+      psTimers->pnTick( 1 );
+      if( fExpire )
+      {
+         (void)psTimers->pnStart( (ABCC_TimerHandle)( lTick % iNumTimers ), iNumTimers );
+      }
+   }
+   llElapsedNs = NowNs() - llStartNs;
+
+   for( iTimer = 0; iTimer < iNumTimers; iTimer++ )
+   {
+      (void)psTimers->pnStop( iTimer );
+   }
+
+   if( bench_lNumTimeouts != ( fExpire ? bench_lTicks : 0 ) )
+   {
+      return( -1.0 );
+   }
+
+   return( (double)llElapsedNs / bench_lTicks );
+}
+
+int main( int argc, char** argv )
+{
+   static const UINT16 aiNumTimers[] = { 3, 64, 512 };
+   double rIdleNs;
+   double rExpireNs;
+   UINT16 iTimer;
+   UINT8 bTimers;
+   UINT8 bRun;
+   BOOL fOk = TRUE;
+
+   if( argc > 1 )
+   {
+      bench_lTicks = (UINT32)strtoul( argv[ 1 ], NULL, 0 );
+   }
+
+   ABCC_TimerInit();
+   for( iTimer = 0; iTimer < BENCH_MAX_TIMERS; iTimer++ )
+   {
+      fOk &= ( ABCC_TimerCreate( TimeoutHandler ) == iTimer );
+      ref_asTimer[ iTimer ].pnHandleTimeout = TimeoutHandler;
+   }
+
+   printf( "%" PRIu32 " ticks per run, ns per tick (no timeout / one timeout and restart)\n",
+           bench_lTicks );
+
+   for( bTimers = 0; bTimers < sizeof( bench_asTimers ) / sizeof( bench_asTimers[ 0 ] ); bTimers++ )
+   {
+      for( bRun = 0; bRun < sizeof( aiNumTimers ) / sizeof( aiNumTimers[ 0 ] ); bRun++ )
+      {
+         rIdleNs = Run( &bench_asTimers[ bTimers ], aiNumTimers[ bRun ], FALSE );
+         rExpireNs = Run( &bench_asTimers[ bTimers ], aiNumTimers[ bRun ], TRUE );
+         printf( "%-25s %3u timers: %7.1f / %7.1f\n",
+                 bench_asTimers[ bTimers ].pcName,
+                 aiNumTimers[ bRun ],
+                 rIdleNs,
+                 rExpireNs );
+         fOk &= ( rIdleNs >= 0.0 ) && ( rExpireNs >= 0.0 );
+      }
+   }
+
+   return( fOk ? EXIT_SUCCESS : EXIT_FAILURE );
+}
@@ -0,0 +1,111 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Write process data bus load benchmark.
+**
+** Counts the bus words the parallel driver writes per write process data
+** update of a 512 octet image when 1, 4 or 16 random 16 bit values change per
+** cycle. Each run is made with the whole image written, as without
+** ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED, and with the changed values marked
+** by ABCC_DrvParMarkWrPdDirty(). After every update the simulated write
+** process data area must equal the application image.
+**
+** Usage: bench_wrpd_bus_words [cycles per run]
+********************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc_driver_parallel_interface.h"
+#include "abcc_hal_stub.h"
+
+#if !ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED
+#error "bench_wrpd_bus_words needs ABCC_CFG_PAR_WRPD_PARTIAL_WRITE_ENABLED"
+#endif
+
+#define BENCH_WRPD_SIZE    512
+
+static UINT32 bench_lCycles = 10000;
+static UINT8 bench_abImage[ BENCH_WRPD_SIZE ];
+
+/*------------------------------------------------------------------------------
+** Runs bench_lCycles updates with iNumChanges changed values each.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iNumChanges - 16 bit values changed per cycle.
+**    fMark       - TRUE to mark the changed values.
+**
+** Returns:
+**    Average write process data bus words per cycle, -1 if the simulated
+**    write process data area ever differed from the image.
+**------------------------------------------------------------------------------
+*/
+static double Run( UINT16 iNumChanges, BOOL fMark )
+{
+   UINT32 lCycle;
+   UINT16 iChange;
+   UINT16 iOffset;
+   BOOL fOk = TRUE;
+
+   srand( 1 );
+   ABCC_DrvParInit( ABP_OP_MODE_8_BIT_PARALLEL );
+   ABCC_DrvParSetPdSize( 0, BENCH_WRPD_SIZE );
+   ABCC_DrvParWriteProcessData( bench_abImage );
+   HAL_StubResetCounters();
+
+   for( lCycle = 0; lCycle < bench_lCycles; lCycle++ )
+   {
+      for( iChange = 0; iChange < iNumChanges; iChange++ )
+      {
+         iOffset = (UINT16)( rand() % ( BENCH_WRPD_SIZE / 2 ) ) * 2;
+         bench_abImage[ iOffset ]++;
+         bench_abImage[ iOffset + 1 ] = (UINT8)lCycle;
+         if( fMark )
+         {
+            ABCC_DrvParMarkWrPdDirty( iOffset, 2 );
+         }
+      }
+
+      ABCC_DrvParWriteProcessData( bench_abImage );
+      fOk &= ( memcmp( &hal_stub_abParMem[ ABP_WRPD_ADR_OFFSET ],
+                       bench_abImage, BENCH_WRPD_SIZE ) == 0 );
+   }
+
+   return( fOk ? (double)hal_stub_sParCounters.lNumWrPdWords / bench_lCycles : -1.0 );
+}
+
+int main( int argc, char** argv )
+{
+   static const UINT16 aiNumChanges[] = { 1, 4, 16 };
+   double rFull;
+   double rMarked;
+   UINT8 bRun;
+   BOOL fOk = TRUE;
+
+   if( argc > 1 )
+   {
+      bench_lCycles = (UINT32)strtoul( argv[ 1 ], NULL, 0 );
+   }
+
+   printf( "%" PRIu32 " cycles per run, %u octet image, %u dirty ranges, "
+           "write PD bus words per cycle\n",
+           bench_lCycles, BENCH_WRPD_SIZE, ABCC_CFG_PAR_WRPD_NUM_DIRTY_RANGES );
+
+   for( bRun = 0; bRun < sizeof( aiNumChanges ) / sizeof( aiNumChanges[ 0 ] ); bRun++ )
+   {
+      rFull = Run( aiNumChanges[ bRun ], FALSE );
+      rMarked = Run( aiNumChanges[ bRun ], TRUE );
+      printf( "%2u changes: whole image %6.1f, marked ranges %6.1f\n",
+              aiNumChanges[ bRun ], rFull, rMarked );
+      fOk &= ( rFull >= 0.0 ) && ( rMarked >= 0.0 );
+   }
+
+   return( fOk ? EXIT_SUCCESS : EXIT_FAILURE );
+}
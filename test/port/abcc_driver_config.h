@@ -0,0 +1,35 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Driver configuration of the host test harness. The defaults below select the
+** 8 bit parallel operating mode, polled. Each test target may override any
+** ABCC_CFG_* value with a compile definition, see test/CMakeLists.txt.
+********************************************************************************
+*/
+
+#ifndef ABCC_DRIVER_CONFIG_H_
+#define ABCC_DRIVER_CONFIG_H_
+
+#ifndef ABCC_CFG_DRV_PARALLEL_ENABLED
+   #define ABCC_CFG_DRV_PARALLEL_ENABLED           1
+#endif
+
+#ifndef ABCC_CFG_OP_MODE_GETTABLE
+   #define ABCC_CFG_OP_MODE_GETTABLE               1
+#endif
+
+#ifndef ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED
+   #define ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED   0
+#endif
+
+#ifndef ABCC_CFG_INT_ENABLED
+   #define ABCC_CFG_INT_ENABLED                    0
+#endif
+
+#ifndef ABCC_CFG_LOG_SEVERITY
+   #define ABCC_CFG_LOG_SEVERITY                   ABCC_LOG_SEVERITY_ERROR_ENABLED
+#endif
+
+#endif  /* inclusion lock */
@@ -0,0 +1,17 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Lock domain mutexes of the host test harness, see abcc_software_port.h.
+********************************************************************************
+*/
+
+#include "abcc_software_port.h"
+
+pthread_mutex_t abcc_port_sLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t abcc_port_sTimerLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t abcc_port_sCmdSeqLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t abcc_port_sLinkLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t abcc_port_sMsgHandlerLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t abcc_port_sMemLock = PTHREAD_MUTEX_INITIALIZER;
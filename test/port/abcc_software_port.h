@@ -0,0 +1,66 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Software port of the host test harness.
+**
+** This is also an example of how the lock domains described in abcc_port.h map
+** to POSIX threads. Each domain is a mutex of its own, so an application
+** thread sending a command only waits for threads using the same driver
+** resource. The mutexes are not recursive, which is sufficient as long as no
+** two domains share a mutex.
+********************************************************************************
+*/
+
+#ifndef ABCC_SW_PORT_H_
+#define ABCC_SW_PORT_H_
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#define ABCC_PORT_printf( ... )              printf( __VA_ARGS__ )
+#define ABCC_PORT_vprintf( ... )             vprintf( __VA_ARGS__ )
+
+extern pthread_mutex_t abcc_port_sLock;
+extern pthread_mutex_t abcc_port_sTimerLock;
+extern pthread_mutex_t abcc_port_sCmdSeqLock;
+extern pthread_mutex_t abcc_port_sLinkLock;
+extern pthread_mutex_t abcc_port_sMsgHandlerLock;
+extern pthread_mutex_t abcc_port_sMemLock;
+
+#define ABCC_PORT_UseCritical()
+#define ABCC_PORT_EnterCritical()            (void)pthread_mutex_lock( &abcc_port_sLock )
+#define ABCC_PORT_ExitCritical()             (void)pthread_mutex_unlock( &abcc_port_sLock )
+
+#define ABCC_PORT_TIMER_UseCritical()
+#define ABCC_PORT_TIMER_EnterCritical()      (void)pthread_mutex_lock( &abcc_port_sTimerLock )
+#define ABCC_PORT_TIMER_ExitCritical()       (void)pthread_mutex_unlock( &abcc_port_sTimerLock )
+
+#define ABCC_PORT_CMDSEQ_UseCritical()
+#define ABCC_PORT_CMDSEQ_EnterCritical()     (void)pthread_mutex_lock( &abcc_port_sCmdSeqLock )
+#define ABCC_PORT_CMDSEQ_ExitCritical()      (void)pthread_mutex_unlock( &abcc_port_sCmdSeqLock )
+
+#define ABCC_PORT_LINK_UseCritical()
+#define ABCC_PORT_LINK_EnterCritical()       (void)pthread_mutex_lock( &abcc_port_sLinkLock )
+#define ABCC_PORT_LINK_ExitCritical()        (void)pthread_mutex_unlock( &abcc_port_sLinkLock )
+
+#define ABCC_PORT_MSG_HANDLER_UseCritical()
+#define ABCC_PORT_MSG_HANDLER_EnterCritical() (void)pthread_mutex_lock( &abcc_port_sMsgHandlerLock )
+#define ABCC_PORT_MSG_HANDLER_ExitCritical()  (void)pthread_mutex_unlock( &abcc_port_sMsgHandlerLock )
+
+#define ABCC_PORT_MEM_UseCritical()
+#define ABCC_PORT_MEM_EnterCritical()        (void)pthread_mutex_lock( &abcc_port_sMemLock )
+#define ABCC_PORT_MEM_ExitCritical()         (void)pthread_mutex_unlock( &abcc_port_sMemLock )
+
+/*
+** Tests that wait for responses without a running driver set
+** ABCC_SW_PORT_CMD_WAIT_TICKS_TIMER. Each yield of ABCC_CmdWait() then ticks
+** the timer system by 1 ms, so that the wait can time out.
+*/
+#if ABCC_SW_PORT_CMD_WAIT_TICKS_TIMER
+#define ABCC_PORT_CmdWaitYield()             ABCC_RunTimerSystem( 1 )
+#endif
+
+#endif  /* inclusion lock */
@@ -0,0 +1,76 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Application callbacks of the host test harness. Commands from the module
+** are rejected and fatal driver errors abort the test.
+********************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc.h"
+#include "abcc_application_data_interface.h"
+
+void ABCC_CbfAnbStateChanged( ABP_AnbStateType eNewAnbState )
+{
+   (void)eNewAnbState;
+}
+
+void ABCC_CbfDriverError( ABCC_LogSeverityType eSeverity,
+                          ABCC_ErrorCodeType  iErrorCode,
+                          UINT32  lAddInfo )
+{
+   if( eSeverity == ABCC_LOG_SEVERITY_FATAL )
+   {
+      fprintf( stderr, "Fatal driver error %d (0x%08" PRIx32 ")\n", (int)iErrorCode, lAddInfo );
+      abort();
+   }
+}
+
+void ABCC_CbfEvent( UINT16 iEvents )
+{
+   (void)iEvents;
+}
+
+void ABCC_CbfHandleCommandMessage( ABP_MsgType* psReceivedMsg )
+{
+   ABP_SetMsgErrorResponse( psReceivedMsg, 1, ABP_ERR_NO_RESOURCES );
+   ABCC_SendRespMsg( psReceivedMsg );
+}
+
+void ABCC_CbfNewReadPd( void* pxReadPd )
+{
+   (void)pxReadPd;
+}
+
+BOOL ABCC_CbfUpdateWriteProcessData( void* pxWritePd )
+{
+   (void)pxWritePd;
+   return( FALSE );
+}
+
+void ABCC_CbfUserInitReq( void )
+{
+}
+
+void ABCC_CbfWdTimeout( void )
+{
+}
+
+void ABCC_CbfWdTimeoutRecovered( void )
+{
+}
+
+UINT16 ABCC_CbfAdiMappingReq( const AD_AdiEntryType** const ppsAdiEntry,
+                              const AD_MapType**      const ppsDefaultMap )
+{
+   *ppsAdiEntry = NULL;
+   *ppsDefaultMap = NULL;
+   return( 0 );
+}
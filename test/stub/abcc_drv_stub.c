@@ -0,0 +1,143 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Message driver stub of the host test harness, see abcc_drv_stub.h.
+********************************************************************************
+*/
+
+#include <pthread.h>
+#include <string.h>
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc.h"
+#include "abcc_driver_interface.h"
+#include "abcc_memory.h"
+#include "abcc_drv_stub.h"
+
+static pthread_mutex_t drv_stub_sLock = PTHREAD_MUTEX_INITIALIZER;
+
+static BOOL drv_stub_fReadyForCmd;
+static ABP_MsgHeaderType drv_stub_asCmd[ DRV_STUB_MAX_CMDS ];
+static UINT32 drv_stub_lNumCmds;
+static ABP_MsgType* drv_stub_apsResp[ DRV_STUB_MAX_RESPONSES ];
+static UINT32 drv_stub_lRespRead;
+static UINT32 drv_stub_lRespWrite;
+
+#if !ABCC_CFG_DRV_STATIC_BINDING_ENABLED
+static BOOL IsReadyForWriteMessage( void )
+{
+   return( TRUE );
+}
+
+static BOOL IsReadyForCmd( void )
+{
+   BOOL fReady;
+
+   pthread_mutex_lock( &drv_stub_sLock );
+   fReady = drv_stub_fReadyForCmd;
+   pthread_mutex_unlock( &drv_stub_sLock );
+
+   return( fReady );
+}
+
+static BOOL WriteMessage( ABP_MsgType* psWriteMsg )
+{
+   pthread_mutex_lock( &drv_stub_sLock );
+   if( ABCC_IsCmdMsg( psWriteMsg ) )
+   {
+      drv_stub_asCmd[ drv_stub_lNumCmds % DRV_STUB_MAX_CMDS ] = psWriteMsg->sHeader;
+      drv_stub_lNumCmds++;
+   }
+   pthread_mutex_unlock( &drv_stub_sLock );
+
+   /*
+   ** Written at once, the buffer is freed by the caller.
+   */
+   return( TRUE );
+}
+
+static ABP_MsgType* ReadMessage( void )
+{
+   ABP_MsgType* psMsg = NULL;
+
+   pthread_mutex_lock( &drv_stub_sLock );
+   if( drv_stub_lRespRead != drv_stub_lRespWrite )
+   {
+      psMsg = drv_stub_apsResp[ drv_stub_lRespRead % DRV_STUB_MAX_RESPONSES ];
+      drv_stub_lRespRead++;
+   }
+   pthread_mutex_unlock( &drv_stub_sLock );
+
+   return( psMsg );
+}
+#endif
+
+void DRV_StubInstall( void )
+{
+   pthread_mutex_lock( &drv_stub_sLock );
+   drv_stub_fReadyForCmd = TRUE;
+   drv_stub_lNumCmds = 0;
+   drv_stub_lRespRead = 0;
+   drv_stub_lRespWrite = 0;
+   pthread_mutex_unlock( &drv_stub_sLock );
+
+#if !ABCC_CFG_DRV_STATIC_BINDING_ENABLED
+   pnABCC_DrvISReadyForWriteMessage = IsReadyForWriteMessage;
+   pnABCC_DrvISReadyForCmd = IsReadyForCmd;
+   pnABCC_DrvPrepareWriteMessage = NULL;
+   pnABCC_DrvWriteMessage = WriteMessage;
+   pnABCC_DrvReadMessage = ReadMessage;
+#endif
+}
+
+void DRV_StubSetReadyForCmd( BOOL fReady )
+{
+   pthread_mutex_lock( &drv_stub_sLock );
+   drv_stub_fReadyForCmd = fReady;
+   pthread_mutex_unlock( &drv_stub_sLock );
+}
+
+UINT32 DRV_StubGetNumCmds( void )
+{
+   UINT32 lNumCmds;
+
+   pthread_mutex_lock( &drv_stub_sLock );
+   lNumCmds = drv_stub_lNumCmds;
+   pthread_mutex_unlock( &drv_stub_sLock );
+
+   return( lNumCmds );
+}
+
+UINT8 DRV_StubGetCmdSourceId( UINT32 lIndex )
+{
+   UINT8 bSrcId;
+
+   pthread_mutex_lock( &drv_stub_sLock );
+   bSrcId = drv_stub_asCmd[ lIndex % DRV_STUB_MAX_CMDS ].bSourceId;
+   pthread_mutex_unlock( &drv_stub_sLock );
+
+   return( bSrcId );
+}
+
+BOOL DRV_StubRespond( UINT32 lIndex )
+{
+   ABP_MsgType* psResp = ABCC_MemAlloc( 0 );
+
+   if( psResp == NULL )
+   {
+      return( FALSE );
+   }
+
+   pthread_mutex_lock( &drv_stub_sLock );
+   psResp->sHeader = drv_stub_asCmd[ lIndex % DRV_STUB_MAX_CMDS ];
+   ABP_SetMsgResponse( psResp, 0 );
+   drv_stub_apsResp[ drv_stub_lRespWrite % DRV_STUB_MAX_RESPONSES ] = psResp;
+   drv_stub_lRespWrite++;
+   pthread_mutex_unlock( &drv_stub_sLock );
+
+   return( TRUE );
+}
@@ -0,0 +1,84 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Message driver stub of the host test harness.
+**
+** Replaces the message functions of the low level driver (dynamic binding) by
+** a simulated module that accepts every written message and returns the
+** responses queued by the test. Used by tests of the message layers that do
+** not need a simulated operating mode. The stub is thread safe.
+********************************************************************************
+*/
+
+#ifndef ABCC_DRV_STUB_H_
+#define ABCC_DRV_STUB_H_
+
+#include "abcc_types.h"
+#include "abp.h"
+
+/*
+** Max number of written commands kept by the stub and of queued responses.
+*/
+#define DRV_STUB_MAX_CMDS        256
+#define DRV_STUB_MAX_RESPONSES   256
+
+/*------------------------------------------------------------------------------
+** Installs the stub as the low level driver and resets it. The module is ready
+** for commands.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void DRV_StubInstall( void );
+
+/*------------------------------------------------------------------------------
+** Sets whether the simulated module accepts commands. Commands sent while it
+** does not are queued by the driver.
+**------------------------------------------------------------------------------
+** Arguments:
+**    fReady   - TRUE if commands are accepted.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void DRV_StubSetReadyForCmd( BOOL fReady );
+
+/*------------------------------------------------------------------------------
+** Returns the number of commands written to the simulated module.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT32 DRV_StubGetNumCmds( void );
+
+/*------------------------------------------------------------------------------
+** Returns the source id of a command written to the simulated module.
+**------------------------------------------------------------------------------
+** Arguments:
+**    lIndex   - Index of the command, in the order written.
+**
+** Returns:
+**    Source id.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT8 DRV_StubGetCmdSourceId( UINT32 lIndex );
+
+/*------------------------------------------------------------------------------
+** Queues the response to a written command. The response is returned by the
+** next read of a message.
+**------------------------------------------------------------------------------
+** Arguments:
+**    lIndex   - Index of the command, in the order written.
+**
+** Returns:
+**    FALSE if no message buffer was available.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL DRV_StubRespond( UINT32 lIndex );
+
+#endif  /* inclusion lock */
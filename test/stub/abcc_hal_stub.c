@@ -0,0 +1,213 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Hardware abstraction stub of the host test harness, see abcc_hal_stub.h.
+********************************************************************************
+*/
+
+#include <string.h>
+#include <time.h>
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc_hardware_abstraction.h"
+#include "abcc_hardware_abstraction_parallel.h"
+#include "abcc_hardware_abstraction_spi.h"
+#include "abcc_hardware_abstraction_serial.h"
+#include "abcc_hal_stub.h"
+
+UINT8 hal_stub_bOpmode = ABP_OP_MODE_8_BIT_PARALLEL;
+UINT8 hal_stub_abParMem[ HAL_STUB_PAR_MEM_SIZE ];
+HAL_StubParCountersType hal_stub_sParCounters;
+
+static UINT8 hal_stub_abRdPdBuffer[ ABP_MAX_PROCESS_DATA ];
+static UINT8 hal_stub_abWrPdBuffer[ ABP_MAX_PROCESS_DATA ];
+
+/*------------------------------------------------------------------------------
+** Returns TRUE if the register is written by the module only.
+**------------------------------------------------------------------------------
+*/
+static BOOL IsModuleReg( UINT16 iOffset )
+{
+   return( ( iOffset == ABP_BUFCTRL_ADR_OFFSET ) ||
+           ( iOffset == ABP_INTSTATUS_ADR_OFFSET ) ||
+           ( iOffset == ABP_ANBSTATUS_ADR_OFFSET ) );
+}
+
+/*------------------------------------------------------------------------------
+** Counts a write and returns the number of octets that fit in the memory.
+**------------------------------------------------------------------------------
+*/
+static UINT16 CountWrite( UINT16 iOffset, UINT16 iLength )
+{
+   hal_stub_sParCounters.lNumWrites++;
+   hal_stub_sParCounters.lNumWordsWritten += ( iLength + 1 ) / 2;
+
+   /*
+   ** The write process data area starts at offset 0.
+   */
+   if( iOffset < ABP_WRPD_ADR_OFFSET + ABP_MAX_PROCESS_DATA )
+   {
+      hal_stub_sParCounters.lNumWrPdWrites++;
+      hal_stub_sParCounters.lNumWrPdWords += ( iLength + 1 ) / 2;
+   }
+
+   if( iOffset >= HAL_STUB_PAR_MEM_SIZE )
+   {
+      return( 0 );
+   }
+
+   if( iLength > HAL_STUB_PAR_MEM_SIZE - iOffset )
+   {
+      iLength = HAL_STUB_PAR_MEM_SIZE - iOffset;
+   }
+
+   return( iLength );
+}
+
+void HAL_StubSetReg16( UINT16 iOffset, UINT16 iValue )
+{
+   hal_stub_abParMem[ iOffset ] = (UINT8)iValue;
+   hal_stub_abParMem[ iOffset + 1 ] = (UINT8)( iValue >> 8 );
+}
+
+UINT16 HAL_StubGetReg16( UINT16 iOffset )
+{
+   return( (UINT16)( hal_stub_abParMem[ iOffset ] |
+                     ( hal_stub_abParMem[ iOffset + 1 ] << 8 ) ) );
+}
+
+void HAL_StubResetCounters( void )
+{
+   memset( &hal_stub_sParCounters, 0, sizeof( hal_stub_sParCounters ) );
+}
+
+BOOL ABCC_HAL_HwInit( void )
+{
+   return( TRUE );
+}
+
+BOOL ABCC_HAL_Init( void )
+{
+   return( TRUE );
+}
+
+void ABCC_HAL_Close( void )
+{
+}
+
+void ABCC_HAL_AbccInterruptEnable( void )
+{
+}
+
+void ABCC_HAL_AbccInterruptDisable( void )
+{
+}
+
+void ABCC_HAL_HWReset( void )
+{
+}
+
+void ABCC_HAL_HWReleaseReset( void )
+{
+}
+
+UINT8 ABCC_HAL_GetOpmode( void )
+{
+   return( hal_stub_bOpmode );
+}
+
+UINT8 ABCC_HAL_ReadModuleId( void )
+{
+   return( ABP_MODULE_ID_ACTIVE_ABCC40 );
+}
+
+BOOL ABCC_HAL_ModuleDetect( void )
+{
+   return( TRUE );
+}
+
+UINT64 ABCC_HAL_GetTimestampNs( void )
+{
+   struct timespec sNow;
+
+   clock_gettime( CLOCK_MONOTONIC, &sNow );
+
+   return( (UINT64)sNow.tv_sec * 1000000000u + (UINT64)sNow.tv_nsec );
+}
+
+void ABCC_HAL_ParallelRead( UINT16 iMemOffset, void* pxData, UINT16 iLength )
+{
+   hal_stub_sParCounters.lNumReads++;
+   hal_stub_sParCounters.lNumWordsRead += ( iLength + 1 ) / 2;
+
+   if( ( iMemOffset < HAL_STUB_PAR_MEM_SIZE ) &&
+       ( iLength <= HAL_STUB_PAR_MEM_SIZE - iMemOffset ) )
+   {
+      memcpy( pxData, &hal_stub_abParMem[ iMemOffset ], iLength );
+   }
+}
+
+UINT16 ABCC_HAL_ParallelRead16( UINT16 iMemOffset )
+{
+   hal_stub_sParCounters.lNumReads++;
+   hal_stub_sParCounters.lNumWordsRead++;
+   hal_stub_sParCounters.lNumRegReads++;
+
+   return( HAL_StubGetReg16( iMemOffset ) );
+}
+
+void ABCC_HAL_ParallelWrite( UINT16 iMemOffset, void* pxData, UINT16 iLength )
+{
+   iLength = CountWrite( iMemOffset, iLength );
+   memcpy( &hal_stub_abParMem[ iMemOffset ], pxData, iLength );
+}
+
+void ABCC_HAL_ParallelWrite16( UINT16 iMemOffset, UINT16 iData )
+{
+   if( ( CountWrite( iMemOffset, 2 ) == 2 ) && !IsModuleReg( iMemOffset ) )
+   {
+      HAL_StubSetReg16( iMemOffset, iData );
+   }
+}
+
+void* ABCC_HAL_ParallelGetRdPdBuffer( void )
+{
+   return( hal_stub_abRdPdBuffer );
+}
+
+void* ABCC_HAL_ParallelGetWrPdBuffer( void )
+{
+   return( hal_stub_abWrPdBuffer );
+}
+
+void ABCC_HAL_SpiRegDataReceived( ABCC_HAL_SpiDataReceivedCbfType pnDataReceived )
+{
+   (void)pnDataReceived;
+}
+
+void ABCC_HAL_SpiSendReceive( void* pxSendDataBuffer, void* pxReceiveDataBuffer, UINT16 iLength )
+{
+   (void)pxSendDataBuffer;
+   memset( pxReceiveDataBuffer, 0, iLength );
+}
+
+void ABCC_HAL_SerRegDataReceived( ABCC_HAL_SerDataReceivedCbfType pnDataReceived )
+{
+   (void)pnDataReceived;
+}
+
+void ABCC_HAL_SerSendReceive( void* pxTxDataBuffer, void* pxRxDataBuffer,
+                              UINT16 iTxSize, UINT16 iRxSize )
+{
+   (void)pxTxDataBuffer;
+   (void)iTxSize;
+   memset( pxRxDataBuffer, 0, iRxSize );
+}
+
+void ABCC_HAL_SerRestart( void )
+{
+}
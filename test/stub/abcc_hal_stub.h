@@ -0,0 +1,93 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Hardware abstraction stub of the host test harness.
+**
+** The parallel interface is backed by a memory array standing in for the
+** module. The registers owned by the module (buffer control, interrupt status
+** and Anybus status) are only changed through HAL_StubSetReg16(), writes from
+** the driver to them are counted but not stored. All bus transactions are
+** counted so that tests can report the bus load of a driver cycle.
+**
+** The SPI and serial functions only return an all-zero frame.
+********************************************************************************
+*/
+
+#ifndef ABCC_HAL_STUB_H_
+#define ABCC_HAL_STUB_H_
+
+#include "abcc_types.h"
+
+/*
+** Size of the simulated parallel interface memory in octets.
+*/
+#define HAL_STUB_PAR_MEM_SIZE    0x4000
+
+/*
+** Bus transaction counters of the parallel interface. Words are 16 bit bus
+** words, a block transfer of n octets counts as ( n + 1 ) / 2 words.
+*/
+typedef struct HAL_StubParCounters
+{
+   UINT32   lNumReads;           /* Read transactions. */
+   UINT32   lNumWrites;          /* Write transactions. */
+   UINT32   lNumWordsRead;       /* Bus words read. */
+   UINT32   lNumWordsWritten;    /* Bus words written. */
+   UINT32   lNumRegReads;        /* 16 bit register reads. */
+   UINT32   lNumWrPdWrites;      /* Write transactions to the write PD area. */
+   UINT32   lNumWrPdWords;       /* Bus words written to the write PD area. */
+}
+HAL_StubParCountersType;
+
+/*
+** Operating mode returned by ABCC_HAL_GetOpmode(), 8 bit parallel by default.
+*/
+EXTFUNC UINT8 hal_stub_bOpmode;
+
+/*
+** Simulated parallel interface memory and its transaction counters.
+*/
+EXTFUNC UINT8 hal_stub_abParMem[ HAL_STUB_PAR_MEM_SIZE ];
+EXTFUNC HAL_StubParCountersType hal_stub_sParCounters;
+
+/*------------------------------------------------------------------------------
+** Sets a 16 bit register of the simulated parallel interface, as the module
+** would.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iOffset  - Register offset in octets.
+**    iValue   - New register value.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void HAL_StubSetReg16( UINT16 iOffset, UINT16 iValue );
+
+/*------------------------------------------------------------------------------
+** Returns a 16 bit register of the simulated parallel interface.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iOffset  - Register offset in octets.
+**
+** Returns:
+**    Register value.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT16 HAL_StubGetReg16( UINT16 iOffset );
+
+/*------------------------------------------------------------------------------
+** Clears the parallel interface transaction counters.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void HAL_StubResetCounters( void );
+
+#endif  /* inclusion lock */
@@ -0,0 +1,152 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Command handle test.
+**
+** Checks ABCC_CmdCancel() before and after the response has arrived, that a
+** cancelled command keeps its handle entry until its response is discarded,
+** and that ABCC_CmdWait() times out. Built with
+** ABCC_SW_PORT_CMD_WAIT_TICKS_TIMER, so each yield of the wait ticks the timer
+** system by 1 ms.
+********************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc.h"
+#include "abcc_link.h"
+#include "abcc_memory.h"
+#include "abcc_timer.h"
+#include "abcc_cmd_async.h"
+#include "abcc_drv_stub.h"
+
+#define TEST_CHECK( x )                                                        \
+   do                                                                          \
+   {                                                                           \
+      if( !( x ) )                                                             \
+      {                                                                        \
+         printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x );        \
+         test_fOk = FALSE;                                                     \
+      }                                                                        \
+   }                                                                           \
+   while( 0 )
+
+static BOOL test_fOk = TRUE;
+
+static UINT16 NumBuffersUsed( void )
+{
+   ABCC_MemStatsType sStats;
+
+   TEST_CHECK( ABCC_MemGetStats( 0, &sStats ) );
+   return( sStats.iNumBuffers - sStats.iNumFree );
+}
+
+static ABCC_ErrorCodeType SendCmd( UINT8 bSrcId, ABCC_CmdHandleType* pxHandle )
+{
+   ABP_MsgType* psMsg = ABCC_MemAlloc( 1 );
+   ABCC_ErrorCodeType eResult;
+
+   ABCC_GetAttribute( psMsg, ABP_OBJ_NUM_ANB, 1, ABP_ANB_IA_FW_VERSION, bSrcId );
+   eResult = ABCC_SendCmdAsync( psMsg, pxHandle );
+   if( eResult != ABCC_EC_NO_ERROR )
+   {
+      ABCC_ReturnMsgBuffer( &psMsg );
+   }
+
+   return( eResult );
+}
+
+/*------------------------------------------------------------------------------
+** Answers a written command and lets the driver route the response, freeing
+** the buffer unless the response handler took it.
+**------------------------------------------------------------------------------
+*/
+static void Respond( UINT32 lIndex )
+{
+   ABCC_MsgHandlerFuncType pnHandler;
+   ABP_MsgType* psMsg;
+
+   TEST_CHECK( DRV_StubRespond( lIndex ) );
+
+   while( ( psMsg = ABCC_LinkReadMessage() ) != NULL )
+   {
+      ABCC_MemSetBufferStatus( psMsg, ABCC_MEM_BUFSTAT_IN_APPL_HANDLER );
+      pnHandler = ABCC_LinkGetMsgHandler( ABCC_GetMsgSourceId( psMsg ) );
+      if( pnHandler != NULL )
+      {
+         pnHandler( psMsg );
+      }
+      if( ABCC_MemGetBufferStatus( psMsg ) == ABCC_MEM_BUFSTAT_IN_APPL_HANDLER )
+      {
+         ABCC_ReturnMsgBuffer( &psMsg );
+      }
+   }
+}
+
+int main( void )
+{
+   ABCC_CmdHandleType xFirst;
+   ABCC_CmdHandleType xSecond;
+   ABCC_CmdHandleType xThird;
+   ABP_MsgType* psResp;
+   UINT64 llStartMs;
+
+   ABCC_TimerInit();
+   ABCC_LinkInit();
+   ABCC_CmdAsyncInit();
+   DRV_StubInstall();
+
+   /*
+   ** A pending command that is cancelled keeps its entry and source id until
+   ** the response arrives.
+   */
+   TEST_CHECK( SendCmd( 1, &xFirst ) == ABCC_EC_NO_ERROR );
+   TEST_CHECK( SendCmd( 2, &xSecond ) == ABCC_EC_NO_ERROR );
+   TEST_CHECK( ABCC_CmdCancel( xFirst ) );
+   TEST_CHECK( !ABCC_CmdCancel( xFirst ) );
+   TEST_CHECK( !ABCC_CmdPoll( xFirst ) );
+   TEST_CHECK( ABCC_CmdTake( xFirst ) == NULL );
+   TEST_CHECK( !ABCC_CmdWait( xFirst, 10 ) );
+   TEST_CHECK( SendCmd( 3, &xThird ) == ABCC_EC_NO_RESOURCES );
+   TEST_CHECK( ABCC_LinkIsSrcIdUsed( 1 ) );
+
+   Respond( 0 );
+   TEST_CHECK( !ABCC_LinkIsSrcIdUsed( 1 ) );
+   TEST_CHECK( NumBuffersUsed() == 0 );
+   TEST_CHECK( SendCmd( 3, &xThird ) == ABCC_EC_NO_ERROR );
+
+   /*
+   ** A response that has arrived is freed by the cancel.
+   */
+   Respond( 1 );
+   TEST_CHECK( ABCC_CmdPoll( xSecond ) );
+   TEST_CHECK( NumBuffersUsed() == 1 );
+   TEST_CHECK( ABCC_CmdCancel( xSecond ) );
+   TEST_CHECK( ABCC_CmdTake( xSecond ) == NULL );
+   TEST_CHECK( NumBuffersUsed() == 0 );
+
+   /*
+   ** The wait times out after the given time on the timer system clock, and
+   ** returns at once when the response has arrived.
+   */
+   llStartMs = ABCC_TimerGetUptimeMs();
+   TEST_CHECK( !ABCC_CmdWait( xThird, 20 ) );
+   TEST_CHECK( ABCC_TimerGetUptimeMs() - llStartMs == 20 );
+
+   Respond( 2 );
+   TEST_CHECK( ABCC_CmdWait( xThird, 20 ) );
+   psResp = ABCC_CmdTake( xThird );
+   TEST_CHECK( psResp != NULL );
+   ABCC_ReturnMsgBuffer( &psResp );
+   TEST_CHECK( NumBuffersUsed() == 0 );
+
+   printf( "%s\n", test_fOk ? "OK" : "FAILED" );
+
+   return( test_fOk ? EXIT_SUCCESS : EXIT_FAILURE );
+}
@@ -0,0 +1,224 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Command batch test.
+**
+** Checks the argument checks of ABCC_SendCmdMsgBatch(), the per command
+** priority and response timeout, and that the buffers are owned as for
+** ABCC_SendCmdMsg() when the batch is rejected.
+********************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc.h"
+#include "abcc_link.h"
+#include "abcc_memory.h"
+#include "abcc_timer.h"
+#include "abcc_drv_stub.h"
+
+#define TEST_CHECK( x )                                                        \
+   do                                                                          \
+   {                                                                           \
+      if( !( x ) )                                                             \
+      {                                                                        \
+         printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x );        \
+         test_fOk = FALSE;                                                     \
+      }                                                                        \
+   }                                                                           \
+   while( 0 )
+
+#define TEST_BATCH_SIZE    3
+
+static BOOL test_fOk = TRUE;
+static UINT32 test_lNumTimeouts;
+
+static void RespHandler( ABP_MsgType* psMsg )
+{
+   if( ABCC_IsRespTimeout( psMsg ) )
+   {
+      test_lNumTimeouts++;
+   }
+}
+
+static UINT16 NumBuffersUsed( void )
+{
+   ABCC_MemStatsType sStats;
+
+   TEST_CHECK( ABCC_MemGetStats( 0, &sStats ) );
+   return( sStats.iNumBuffers - sStats.iNumFree );
+}
+
+static void FillBatch( ABCC_CmdMsgBatchEntryType* pasCmds, UINT8 bFirstSrcId )
+{
+   UINT8 bMsg;
+
+   for( bMsg = 0; bMsg < TEST_BATCH_SIZE; bMsg++ )
+   {
+      pasCmds[ bMsg ].psCmdMsg = ABCC_MemAlloc( 1 );
+      ABCC_GetAttribute( pasCmds[ bMsg ].psCmdMsg, ABP_OBJ_NUM_ANB, 1,
+                         ABP_ANB_IA_FW_VERSION, bFirstSrcId + bMsg );
+      pasCmds[ bMsg ].pnMsgHandler = RespHandler;
+      pasCmds[ bMsg ].bPriority = 0;
+      pasCmds[ bMsg ].lTimeoutMs = 0;
+   }
+}
+
+static void FreeBatch( ABCC_CmdMsgBatchEntryType* pasCmds )
+{
+   UINT8 bMsg;
+
+   for( bMsg = 0; bMsg < TEST_BATCH_SIZE; bMsg++ )
+   {
+      ABCC_ReturnMsgBuffer( &pasCmds[ bMsg ].psCmdMsg );
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Lets the module take all queued commands and answers them.
+**------------------------------------------------------------------------------
+*/
+static void SendAndRespond( void )
+{
+   ABCC_MsgHandlerFuncType pnHandler;
+   ABP_MsgType* psMsg;
+   UINT32 lIndex;
+
+   lIndex = DRV_StubGetNumCmds();
+   DRV_StubSetReadyForCmd( TRUE );
+   while( ABCC_LinkIsSendPending() )
+   {
+      ABCC_LinkCheckSendMessage();
+   }
+
+   for( ; lIndex < DRV_StubGetNumCmds(); lIndex++ )
+   {
+      TEST_CHECK( DRV_StubRespond( lIndex ) );
+   }
+
+   while( ( psMsg = ABCC_LinkReadMessage() ) != NULL )
+   {
+      pnHandler = ABCC_LinkGetMsgHandler( ABCC_GetMsgSourceId( psMsg ) );
+      if( pnHandler != NULL )
+      {
+         pnHandler( psMsg );
+      }
+      ABCC_ReturnMsgBuffer( &psMsg );
+   }
+
+   DRV_StubSetReadyForCmd( FALSE );
+}
+
+int main( void )
+{
+   ABCC_CmdMsgBatchEntryType asCmds[ TEST_BATCH_SIZE ];
+   ABCC_CmdMsgBatchEntryType asMore[ TEST_BATCH_SIZE ];
+   UINT32 lIndex;
+
+   ABCC_TimerInit();
+   ABCC_LinkInit();
+   DRV_StubInstall();
+   DRV_StubSetReadyForCmd( FALSE );
+
+   /*
+   ** Argument checks, the buffers stay with the application.
+   */
+   TEST_CHECK( ABCC_SendCmdMsgBatch( NULL, 0 ) == ABCC_EC_NO_ERROR );
+   TEST_CHECK( ABCC_SendCmdMsgBatch( NULL, 1 ) == ABCC_EC_PARAMETER_NOT_VALID );
+
+   FillBatch( asCmds, 1 );
+   asCmds[ 1 ].pnMsgHandler = NULL;
+   TEST_CHECK( ABCC_SendCmdMsgBatch( asCmds, TEST_BATCH_SIZE ) == ABCC_EC_PARAMETER_NOT_VALID );
+   asCmds[ 1 ].pnMsgHandler = RespHandler;
+   asCmds[ 2 ].bPriority = ABCC_CFG_NUM_CMD_PRIO;
+   TEST_CHECK( ABCC_SendCmdMsgBatch( asCmds, TEST_BATCH_SIZE ) == ABCC_EC_PARAMETER_NOT_VALID );
+   TEST_CHECK( NumBuffersUsed() == TEST_BATCH_SIZE );
+   TEST_CHECK( !ABCC_LinkIsSrcIdUsed( 1 ) );
+
+   /*
+   ** Per command priority, source id 2 is sent first.
+   */
+   asCmds[ 1 ].bPriority = 1;
+   asCmds[ 2 ].bPriority = 0;
+   TEST_CHECK( ABCC_SendCmdMsgBatch( asCmds, TEST_BATCH_SIZE ) == ABCC_EC_NO_ERROR );
+   SendAndRespond();
+   TEST_CHECK( DRV_StubGetNumCmds() == TEST_BATCH_SIZE );
+   TEST_CHECK( DRV_StubGetCmdSourceId( 0 ) == 2 );
+   TEST_CHECK( DRV_StubGetCmdSourceId( 1 ) == 1 );
+   TEST_CHECK( DRV_StubGetCmdSourceId( 2 ) == 3 );
+   TEST_CHECK( NumBuffersUsed() == 0 );
+
+   /*
+   ** Per command timeout, only source id 11 times out.
+   */
+   FillBatch( asCmds, 10 );
+   asCmds[ 1 ].lTimeoutMs = 50;
+   TEST_CHECK( ABCC_SendCmdMsgBatch( asCmds, TEST_BATCH_SIZE ) == ABCC_EC_NO_ERROR );
+   ABCC_TimerTick( 60 );
+   ABCC_LinkCheckRespTimeouts();
+   TEST_CHECK( test_lNumTimeouts == 1 );
+   TEST_CHECK( !ABCC_LinkIsSrcIdUsed( 11 ) );
+   TEST_CHECK( ABCC_LinkIsSrcIdUsed( 10 ) );
+
+   /*
+   ** A full queue frees the buffers of the rejected batch, as for a single
+   ** command.
+   */
+   FillBatch( asMore, 20 );
+   TEST_CHECK( ABCC_SendCmdMsgBatch( asMore, TEST_BATCH_SIZE ) == ABCC_EC_LINK_CMD_QUEUE_FULL );
+   TEST_CHECK( NumBuffersUsed() == TEST_BATCH_SIZE - 1 );
+   TEST_CHECK( !ABCC_LinkIsSrcIdUsed( 20 ) );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS - 2 );
+
+   /*
+   ** A mapping failure leaves them with the application and releases the
+   ** reserved command resources.
+   */
+   FillBatch( asMore, 12 );
+   TEST_CHECK( ABCC_SendCmdMsgBatch( asMore, 2 ) == ABCC_EC_NO_RESOURCES );
+   TEST_CHECK( !ABCC_LinkIsSrcIdUsed( 13 ) );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS - 2 );
+   FreeBatch( asMore );
+
+   SendAndRespond();
+   TEST_CHECK( NumBuffersUsed() == 0 );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS );
+
+   /*
+   ** Commands that the module has taken but not answered hold their command
+   ** resources, although the queue is empty.
+   */
+   lIndex = DRV_StubGetNumCmds();
+   FillBatch( asCmds, 30 );
+   DRV_StubSetReadyForCmd( TRUE );
+   TEST_CHECK( ABCC_SendCmdMsgBatch( asCmds, TEST_BATCH_SIZE ) == ABCC_EC_NO_ERROR );
+   while( ABCC_LinkIsSendPending() )
+   {
+      ABCC_LinkCheckSendMessage();
+   }
+   TEST_CHECK( DRV_StubGetNumCmds() == lIndex + TEST_BATCH_SIZE );
+
+   FillBatch( asMore, 40 );
+   TEST_CHECK( ABCC_SendCmdMsgBatch( asMore, 2 ) == ABCC_EC_LINK_CMD_QUEUE_FULL );
+   TEST_CHECK( !ABCC_LinkIsSrcIdUsed( 40 ) );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS - TEST_BATCH_SIZE );
+   ABCC_ReturnMsgBuffer( &asMore[ 2 ].psCmdMsg );
+
+   for( ; lIndex < DRV_StubGetNumCmds(); lIndex++ )
+   {
+      TEST_CHECK( DRV_StubRespond( lIndex ) );
+   }
+   SendAndRespond();
+   TEST_CHECK( NumBuffersUsed() == 0 );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS );
+
+   printf( "%s\n", test_fOk ? "OK" : "FAILED" );
+
+   return( test_fOk ? EXIT_SUCCESS : EXIT_FAILURE );
+}
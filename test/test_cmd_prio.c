@@ -0,0 +1,134 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Command priority test.
+**
+** Queued commands are sent highest priority class first and in order within a
+** class. All classes share one queue of ABCC_CFG_MAX_NUM_APPL_CMDS entries,
+** which a single class can fill.
+********************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc.h"
+#include "abcc_link.h"
+#include "abcc_memory.h"
+#include "abcc_timer.h"
+#include "abcc_drv_stub.h"
+
+#define TEST_CHECK( x )                                                        \
+   do                                                                          \
+   {                                                                           \
+      if( !( x ) )                                                             \
+      {                                                                        \
+         printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x );        \
+         test_fOk = FALSE;                                                     \
+      }                                                                        \
+   }                                                                           \
+   while( 0 )
+
+static BOOL test_fOk = TRUE;
+
+static void RespHandler( ABP_MsgType* psMsg )
+{
+   (void)psMsg;
+}
+
+static ABCC_ErrorCodeType SendCmd( UINT8 bSrcId, UINT8 bPriority, UINT32 lTimeoutMs )
+{
+   ABP_MsgType* psMsg = ABCC_MemAlloc( 1 );
+   ABCC_ErrorCodeType eResult;
+
+   ABCC_GetAttribute( psMsg, ABP_OBJ_NUM_ANB, 1, ABP_ANB_IA_FW_VERSION, bSrcId );
+   eResult = ABCC_SendCmdMsgEx( psMsg, RespHandler, bPriority, lTimeoutMs );
+   if( eResult == ABCC_EC_PARAMETER_NOT_VALID )
+   {
+      ABCC_ReturnMsgBuffer( &psMsg );
+   }
+
+   return( eResult );
+}
+
+/*------------------------------------------------------------------------------
+** Lets the module take all queued commands and answers them.
+**------------------------------------------------------------------------------
+*/
+static void SendAndRespond( void )
+{
+   ABCC_MsgHandlerFuncType pnHandler;
+   ABP_MsgType* psMsg;
+   UINT32 lIndex;
+
+   lIndex = DRV_StubGetNumCmds();
+   DRV_StubSetReadyForCmd( TRUE );
+   while( ABCC_LinkIsSendPending() )
+   {
+      ABCC_LinkCheckSendMessage();
+   }
+
+   for( ; lIndex < DRV_StubGetNumCmds(); lIndex++ )
+   {
+      TEST_CHECK( DRV_StubRespond( lIndex ) );
+   }
+
+   while( ( psMsg = ABCC_LinkReadMessage() ) != NULL )
+   {
+      pnHandler = ABCC_LinkGetMsgHandler( ABCC_GetMsgSourceId( psMsg ) );
+      TEST_CHECK( pnHandler != NULL );
+      ABCC_ReturnMsgBuffer( &psMsg );
+   }
+
+   DRV_StubSetReadyForCmd( FALSE );
+}
+
+int main( void )
+{
+   static const UINT8 abPriority[] = { 0, 2, 1, 2, 0, 1 };
+   static const UINT8 abSendOrder[] = { 2, 4, 3, 6, 1, 5 };
+   UINT8 bCmd;
+
+   ABCC_TimerInit();
+   ABCC_LinkInit();
+   DRV_StubInstall();
+   DRV_StubSetReadyForCmd( FALSE );
+
+   /*
+   ** Source id n + 1 is sent with priority abPriority[ n ].
+   */
+   for( bCmd = 0; bCmd < sizeof( abPriority ); bCmd++ )
+   {
+      TEST_CHECK( SendCmd( bCmd + 1, abPriority[ bCmd ], 0 ) == ABCC_EC_NO_ERROR );
+   }
+   TEST_CHECK( SendCmd( 7, 2, 0 ) == ABCC_EC_LINK_CMD_QUEUE_FULL );
+   TEST_CHECK( SendCmd( 7, ABCC_CFG_NUM_CMD_PRIO, 0 ) == ABCC_EC_PARAMETER_NOT_VALID );
+   TEST_CHECK( SendCmd( 7, 0, 100 ) == ABCC_EC_PARAMETER_NOT_VALID );
+
+   SendAndRespond();
+   TEST_CHECK( DRV_StubGetNumCmds() == sizeof( abSendOrder ) );
+   for( bCmd = 0; bCmd < sizeof( abSendOrder ); bCmd++ )
+   {
+      TEST_CHECK( DRV_StubGetCmdSourceId( bCmd ) == abSendOrder[ bCmd ] );
+   }
+
+   /*
+   ** One class can use every entry.
+   */
+   for( bCmd = 0; bCmd < ABCC_CFG_MAX_NUM_APPL_CMDS; bCmd++ )
+   {
+      TEST_CHECK( SendCmd( bCmd + 10, 1, 0 ) == ABCC_EC_NO_ERROR );
+   }
+   SendAndRespond();
+   TEST_CHECK( DRV_StubGetNumCmds() == sizeof( abSendOrder ) + ABCC_CFG_MAX_NUM_APPL_CMDS );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS );
+
+   printf( "%s\n", test_fOk ? "OK" : "FAILED" );
+
+   return( test_fOk ? EXIT_SUCCESS : EXIT_FAILURE );
+}
@@ -0,0 +1,214 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Response timeout test.
+**
+** A command that times out while queued is removed and its command resource
+** released at once. A command that times out after it has been sent keeps its
+** command resource and source id until the module responds, and the late
+** response is discarded. If the module never responds they are released when
+** the grace period ends. The response handler is called once with a timeout
+** response in all cases.
+********************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc.h"
+#include "abcc_link.h"
+#include "abcc_memory.h"
+#include "abcc_timer.h"
+#include "abcc_drv_stub.h"
+
+#define TEST_CHECK( x )                                                        \
+   do                                                                          \
+   {                                                                           \
+      if( !( x ) )                                                             \
+      {                                                                        \
+         printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x );        \
+         test_fOk = FALSE;                                                     \
+      }                                                                        \
+   }                                                                           \
+   while( 0 )
+
+static BOOL test_fOk = TRUE;
+static UINT32 test_lNumTimeouts;
+static UINT32 test_lNumResponses;
+
+static void RespHandler( ABP_MsgType* psMsg )
+{
+   if( ABCC_IsRespTimeout( psMsg ) )
+   {
+      test_lNumTimeouts++;
+   }
+   else
+   {
+      test_lNumResponses++;
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Sends a command in a buffer taken directly from the pool, as when a received
+** message is reused, so that it is not stopped by ABCC_GetCmdMsgBuffer().
+**------------------------------------------------------------------------------
+*/
+static ABCC_ErrorCodeType TrySendCmd( UINT8 bSrcId, UINT32 lTimeoutMs )
+{
+   ABP_MsgType* psMsg = ABCC_MemAlloc( ABCC_CFG_MAX_MSG_SIZE );
+
+   TEST_CHECK( psMsg != NULL );
+   ABCC_GetAttribute( psMsg, ABP_OBJ_NUM_ANB, 1, ABP_ANB_IA_FW_VERSION, bSrcId );
+
+   return( ABCC_SendCmdMsgWithTimeout( psMsg, RespHandler, lTimeoutMs ) );
+}
+
+static ABP_MsgType* SendCmd( UINT8 bSrcId, UINT32 lTimeoutMs )
+{
+   ABP_MsgType* psMsg = ABCC_GetCmdMsgBuffer();
+
+   TEST_CHECK( psMsg != NULL );
+   ABCC_GetAttribute( psMsg, ABP_OBJ_NUM_ANB, 1, ABP_ANB_IA_FW_VERSION, bSrcId );
+   TEST_CHECK( ABCC_SendCmdMsgWithTimeout( psMsg, RespHandler, lTimeoutMs ) == ABCC_EC_NO_ERROR );
+
+   return( psMsg );
+}
+
+/*------------------------------------------------------------------------------
+** Delivers the messages returned by the stub, as the receive path does.
+**------------------------------------------------------------------------------
+*/
+static void ReceiveResponses( void )
+{
+   ABCC_MsgHandlerFuncType pnHandler;
+   ABP_MsgType* psMsg;
+
+   while( ( psMsg = ABCC_LinkReadMessage() ) != NULL )
+   {
+      pnHandler = ABCC_LinkGetMsgHandler( ABCC_GetMsgSourceId( psMsg ) );
+      if( pnHandler != NULL )
+      {
+         pnHandler( psMsg );
+      }
+      ABCC_ReturnMsgBuffer( &psMsg );
+   }
+}
+
+static void Wait( INT16 iMs )
+{
+   ABCC_TimerTick( iMs );
+   ABCC_LinkCheckRespTimeouts();
+}
+
+int main( void )
+{
+   ABCC_MemStatsType sStats;
+   UINT8 bSrcId;
+
+   ABCC_TimerInit();
+   ABCC_LinkInit();
+   DRV_StubInstall();
+
+   /*
+   ** Source id 1 is sent at once, source id 2 is queued.
+   */
+   (void)SendCmd( 1, 100 );
+   DRV_StubSetReadyForCmd( FALSE );
+   (void)SendCmd( 2, 50 );
+   TEST_CHECK( DRV_StubGetNumCmds() == 1 );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS - 2 );
+
+   /*
+   ** The queued command times out, is removed and releases its resource.
+   */
+   Wait( 60 );
+   TEST_CHECK( test_lNumTimeouts == 1 );
+   TEST_CHECK( !ABCC_LinkIsSendPending() );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS - 1 );
+   TEST_CHECK( !ABCC_LinkIsSrcIdUsed( 2 ) );
+
+   DRV_StubSetReadyForCmd( TRUE );
+   ABCC_LinkCheckSendMessage();
+   TEST_CHECK( DRV_StubGetNumCmds() == 1 );
+
+   /*
+   ** The sent command times out but keeps its resource and source id.
+   */
+   Wait( 50 );
+   TEST_CHECK( test_lNumTimeouts == 2 );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS - 1 );
+   TEST_CHECK( ABCC_LinkIsSrcIdUsed( 1 ) );
+   TEST_CHECK( ABCC_LinkMapMsgHandler( 1, RespHandler ) == ABCC_EC_NO_RESOURCES );
+
+   /*
+   ** The late response releases them and is discarded.
+   */
+   TEST_CHECK( DRV_StubRespond( 0 ) );
+   ReceiveResponses();
+   TEST_CHECK( test_lNumResponses == 0 );
+   TEST_CHECK( test_lNumTimeouts == 2 );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS );
+   TEST_CHECK( !ABCC_LinkIsSrcIdUsed( 1 ) );
+
+   /*
+   ** A response in time is delivered and the timeout never fires.
+   */
+   (void)SendCmd( 3, 100 );
+   TEST_CHECK( DRV_StubRespond( 1 ) );
+   ReceiveResponses();
+   Wait( 200 );
+   TEST_CHECK( test_lNumResponses == 1 );
+   TEST_CHECK( test_lNumTimeouts == 2 );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS );
+
+   /*
+   ** Commands that are never answered hold their resources, also after they
+   ** have timed out, so further commands are rejected.
+   */
+   for( bSrcId = 10; bSrcId < ( 10 + ABCC_CFG_MAX_NUM_APPL_CMDS ); bSrcId++ )
+   {
+      (void)SendCmd( bSrcId, 100 );
+   }
+   TEST_CHECK( ABCC_GetCmdQueueSize() == 0 );
+   TEST_CHECK( ABCC_GetCmdMsgBuffer() == NULL );
+   TEST_CHECK( TrySendCmd( 20, 100 ) == ABCC_EC_LINK_CMD_QUEUE_FULL );
+
+   Wait( 150 );
+   TEST_CHECK( test_lNumTimeouts == 2 + ABCC_CFG_MAX_NUM_APPL_CMDS );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == 0 );
+   TEST_CHECK( TrySendCmd( 20, 100 ) == ABCC_EC_LINK_CMD_QUEUE_FULL );
+   TEST_CHECK( ABCC_LinkIsSrcIdUsed( 10 ) );
+
+   /*
+   ** The grace period ends and releases them, a response after that is
+   ** discarded.
+   */
+   Wait( ABCC_CFG_CMD_RESP_TIMEOUT_GRACE_MS );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS );
+   TEST_CHECK( !ABCC_LinkIsSrcIdUsed( 10 ) );
+
+   TEST_CHECK( DRV_StubRespond( 2 ) );
+   ReceiveResponses();
+   TEST_CHECK( test_lNumResponses == 1 );
+   TEST_CHECK( test_lNumTimeouts == 2 + ABCC_CFG_MAX_NUM_APPL_CMDS );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS );
+
+   (void)SendCmd( 10, 100 );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS - 1 );
+   TEST_CHECK( DRV_StubRespond( DRV_StubGetNumCmds() - 1 ) );
+   ReceiveResponses();
+   TEST_CHECK( test_lNumResponses == 2 );
+   TEST_CHECK( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS );
+
+   TEST_CHECK( ABCC_MemGetStats( 0, &sStats ) );
+   TEST_CHECK( sStats.iNumFree == sStats.iNumBuffers );
+
+   printf( "%s\n", test_fOk ? "OK" : "FAILED" );
+
+   return( test_fOk ? EXIT_SUCCESS : EXIT_FAILURE );
+}
@@ -0,0 +1,342 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Lock domain stress test.
+**
+** Application threads send commands with response timeouts and through
+** command handles, some of which are cancelled, while a driver thread answers
+** them through the message driver stub, routes the responses and runs the
+** timer system. Every domain of abcc_port.h is a mutex of its own (see
+** abcc_software_port.h), so the threads only serialize where the driver
+** nests the domains. The test checks that every response handler is called
+** once and that no buffer, handle or command resource is lost. It is also
+** built with ThreadSanitizer (test_lock_stress_tsan) where the compiler
+** supports it, which reports any access that a domain fails to protect.
+********************************************************************************
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc.h"
+#include "abcc_link.h"
+#include "abcc_memory.h"
+#include "abcc_timer.h"
+#include "abcc_cmd_async.h"
+#include "abcc_drv_stub.h"
+
+#define TEST_CHECK( x )                                                        \
+   do                                                                          \
+   {                                                                           \
+      if( !( x ) )                                                             \
+      {                                                                        \
+         printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x );        \
+         SetFailed();                                                          \
+      }                                                                        \
+   }                                                                           \
+   while( 0 )
+
+#define TEST_NUM_SYNC_THREADS    2
+#define TEST_NUM_ASYNC_THREADS   2
+#define TEST_DEFAULT_NUM_CMDS    20000
+
+/*
+** The driver thread answers the written commands every
+** TEST_RESP_INTERVAL_MS. Commands sent with a response handler have a timeout
+** of 1 to TEST_MAX_RESP_TIMEOUT_MS, so that some time out before they are
+** answered.
+*/
+#define TEST_RESP_INTERVAL_MS    4
+#define TEST_MAX_RESP_TIMEOUT_MS 8
+
+/*
+** Driver thread cycles to wait for the driver to settle after the application
+** threads are done.
+*/
+#define TEST_MAX_DRAIN_CYCLES    1000000
+
+static UINT32 test_lNumCmds = TEST_DEFAULT_NUM_CMDS;
+
+static pthread_mutex_t test_sLock = PTHREAD_MUTEX_INITIALIZER;
+static BOOL test_fOk = TRUE;
+static UINT32 test_lNumSent;
+static UINT32 test_lNumHandled;
+static UINT32 test_lNumTimeouts;
+static BOOL test_fStop;
+
+static void SetFailed( void )
+{
+   pthread_mutex_lock( &test_sLock );
+   test_fOk = FALSE;
+   pthread_mutex_unlock( &test_sLock );
+}
+
+static void CountSent( void )
+{
+   pthread_mutex_lock( &test_sLock );
+   test_lNumSent++;
+   pthread_mutex_unlock( &test_sLock );
+}
+
+static void RespHandler( ABP_MsgType* psMsg )
+{
+   pthread_mutex_lock( &test_sLock );
+   test_lNumHandled++;
+   if( ABCC_IsRespTimeout( psMsg ) )
+   {
+      test_lNumTimeouts++;
+   }
+   pthread_mutex_unlock( &test_sLock );
+}
+
+static ABP_MsgType* AllocCmd( void )
+{
+   ABP_MsgType* psMsg;
+
+   while( ( psMsg = ABCC_GetCmdMsgBuffer() ) == NULL )
+   {
+      sched_yield();
+   }
+   ABCC_GetAttribute( psMsg, ABP_OBJ_NUM_ANB, 1, ABP_ANB_IA_FW_VERSION,
+                      ABCC_GetNewSourceId() );
+
+   return( psMsg );
+}
+
+/*------------------------------------------------------------------------------
+** Sends commands with a response handler and a response timeout. A command
+** that is not accepted is sent again in a new buffer with a new source id,
+** the rejected buffer having been freed by the driver if its queue was full.
+**------------------------------------------------------------------------------
+*/
+static void* SyncThread( void* pxArg )
+{
+   ABP_MsgType* psMsg;
+   ABCC_ErrorCodeType eResult;
+   UINT32 lCmd;
+
+   (void)pxArg;
+
+   for( lCmd = 0; lCmd < test_lNumCmds; lCmd++ )
+   {
+      for( ;; )
+      {
+         psMsg = AllocCmd();
+         eResult = ABCC_SendCmdMsgWithTimeout( psMsg, RespHandler,
+                                               1 + lCmd % TEST_MAX_RESP_TIMEOUT_MS );
+         if( eResult == ABCC_EC_NO_ERROR )
+         {
+            break;
+         }
+         if( eResult != ABCC_EC_LINK_CMD_QUEUE_FULL )
+         {
+            ABCC_ReturnMsgBuffer( &psMsg );
+         }
+         sched_yield();
+      }
+      CountSent();
+   }
+
+   return( NULL );
+}
+
+/*------------------------------------------------------------------------------
+** Sends commands through command handles, and takes or cancels them. Every
+** fourth command is cancelled before its response has been polled. A command
+** that is not accepted is handled as in SyncThread().
+**------------------------------------------------------------------------------
+*/
+static void* AsyncThread( void* pxArg )
+{
+   ABCC_CmdHandleType xHandle;
+   ABCC_ErrorCodeType eResult;
+   ABP_MsgType* psMsg;
+   UINT32 lCmd;
+
+   (void)pxArg;
+
+   for( lCmd = 0; lCmd < test_lNumCmds; lCmd++ )
+   {
+      psMsg = AllocCmd();
+      while( ( eResult = ABCC_SendCmdAsync( psMsg, &xHandle ) ) != ABCC_EC_NO_ERROR )
+      {
+         if( eResult != ABCC_EC_LINK_CMD_QUEUE_FULL )
+         {
+            ABCC_ReturnMsgBuffer( &psMsg );
+         }
+         sched_yield();
+         psMsg = AllocCmd();
+      }
+
+      if( ( lCmd % 4 ) == 0 )
+      {
+         TEST_CHECK( ABCC_CmdCancel( xHandle ) );
+         continue;
+      }
+
+      while( !ABCC_CmdPoll( xHandle ) )
+      {
+         sched_yield();
+      }
+      psMsg = ABCC_CmdTake( xHandle );
+      TEST_CHECK( psMsg != NULL );
+      if( psMsg != NULL )
+      {
+         TEST_CHECK( ABCC_ReturnMsgBuffer( &psMsg ) == ABCC_EC_NO_ERROR );
+      }
+   }
+
+   return( NULL );
+}
+
+/*------------------------------------------------------------------------------
+** Runs the parts of ABCC_RunDriver() that the message layers need: answers
+** the written commands, routes the responses, sends queued commands and ticks
+** the timer system by 1 ms per cycle.
+**------------------------------------------------------------------------------
+*/
+static void* DriverThread( void* pxArg )
+{
+   ABCC_MsgHandlerFuncType pnHandler;
+   ABP_MsgType* psMsg;
+   UINT32 lNumAnswered = 0;
+   UINT32 lCycle = 0;
+   BOOL fStop = FALSE;
+
+   (void)pxArg;
+
+   while( !fStop )
+   {
+      if( ( lCycle % TEST_RESP_INTERVAL_MS ) == 0 )
+      {
+         while( ( lNumAnswered < DRV_StubGetNumCmds() ) &&
+                DRV_StubRespond( lNumAnswered ) )
+         {
+            lNumAnswered++;
+         }
+      }
+      lCycle++;
+
+      while( ( psMsg = ABCC_LinkReadMessage() ) != NULL )
+      {
+         ABCC_MemSetBufferStatus( psMsg, ABCC_MEM_BUFSTAT_IN_APPL_HANDLER );
+         pnHandler = ABCC_LinkGetMsgHandler( ABCC_GetMsgSourceId( psMsg ) );
+         if( pnHandler != NULL )
+         {
+            pnHandler( psMsg );
+         }
+         if( ABCC_MemGetBufferStatus( psMsg ) == ABCC_MEM_BUFSTAT_IN_APPL_HANDLER )
+         {
+            ABCC_ReturnMsgBuffer( &psMsg );
+         }
+      }
+
+      ABCC_LinkCheckSendMessage();
+      ABCC_RunTimerSystem( 1 );
+      ABCC_LinkCheckRespTimeouts();
+      sched_yield();
+
+      pthread_mutex_lock( &test_sLock );
+      fStop = test_fStop;
+      pthread_mutex_unlock( &test_sLock );
+   }
+
+   return( NULL );
+}
+
+static BOOL IsDrained( void )
+{
+   ABCC_MemStatsType sStats;
+   BOOL fDrained;
+
+   pthread_mutex_lock( &test_sLock );
+   fDrained = ( test_lNumHandled == test_lNumSent );
+   pthread_mutex_unlock( &test_sLock );
+
+   TEST_CHECK( ABCC_MemGetStats( 0, &sStats ) );
+
+   return( fDrained &&
+           ( ABCC_GetCmdQueueSize() == ABCC_CFG_MAX_NUM_APPL_CMDS ) &&
+           ( sStats.iNumFree == sStats.iNumBuffers ) );
+}
+
+int main( int argc, char** argv )
+{
+   pthread_t asThread[ TEST_NUM_SYNC_THREADS + TEST_NUM_ASYNC_THREADS ];
+   pthread_t sDriverThread;
+   ABCC_CmdHandleType axHandle[ ABCC_CFG_CMD_ASYNC_NUM_HANDLES ];
+   ABCC_MemStatsType sStats;
+   ABP_MsgType* psMsg;
+   UINT32 lCycle;
+   UINT32 i;
+
+   if( argc > 1 )
+   {
+      test_lNumCmds = (UINT32)strtoul( argv[ 1 ], NULL, 0 );
+   }
+
+   ABCC_TimerInit();
+   ABCC_LinkInit();
+   ABCC_CmdAsyncInit();
+   DRV_StubInstall();
+
+   TEST_CHECK( pthread_create( &sDriverThread, NULL, DriverThread, NULL ) == 0 );
+   for( i = 0; i < TEST_NUM_SYNC_THREADS + TEST_NUM_ASYNC_THREADS; i++ )
+   {
+      TEST_CHECK( pthread_create( &asThread[ i ], NULL,
+                                  ( i < TEST_NUM_SYNC_THREADS ) ? SyncThread : AsyncThread,
+                                  NULL ) == 0 );
+   }
+   for( i = 0; i < TEST_NUM_SYNC_THREADS + TEST_NUM_ASYNC_THREADS; i++ )
+   {
+      pthread_join( asThread[ i ], NULL );
+   }
+
+   /*
+   ** The driver thread keeps running until the late responses to cancelled
+   ** and timed out commands have released their resources.
+   */
+   for( lCycle = 0; ( lCycle < TEST_MAX_DRAIN_CYCLES ) && !IsDrained(); lCycle++ )
+   {
+      sched_yield();
+   }
+   TEST_CHECK( lCycle < TEST_MAX_DRAIN_CYCLES );
+
+   pthread_mutex_lock( &test_sLock );
+   test_fStop = TRUE;
+   pthread_mutex_unlock( &test_sLock );
+   pthread_join( sDriverThread, NULL );
+
+   TEST_CHECK( test_lNumSent == TEST_NUM_SYNC_THREADS * test_lNumCmds );
+   TEST_CHECK( test_lNumHandled == test_lNumSent );
+
+   /*
+   ** Every handle has been released.
+   */
+   for( i = 0; i < ABCC_CFG_CMD_ASYNC_NUM_HANDLES; i++ )
+   {
+      psMsg = AllocCmd();
+      TEST_CHECK( ABCC_SendCmdAsync( psMsg, &axHandle[ i ] ) == ABCC_EC_NO_ERROR );
+   }
+   for( i = 0; i < ABCC_CFG_CMD_ASYNC_NUM_HANDLES; i++ )
+   {
+      TEST_CHECK( ABCC_CmdCancel( axHandle[ i ] ) );
+   }
+
+   printf( "%u commands per thread, %u of %u response handler calls were timeouts\n",
+           (unsigned)test_lNumCmds, (unsigned)test_lNumTimeouts,
+           (unsigned)test_lNumHandled );
+   TEST_CHECK( ABCC_MemGetStats( 0, &sStats ) );
+   TEST_CHECK( sStats.iNumFree == sStats.iNumBuffers );
+
+   printf( "%s\n", test_fOk ? "OK" : "FAILED" );
+
+   return( test_fOk ? EXIT_SUCCESS : EXIT_FAILURE );
+}
@@ -0,0 +1,182 @@
+/*******************************************************************************
+** Copyright 2013-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Timer heap test.
+**
+** Creates ABCC_CFG_MAX_NUM_TIMERS timers and runs random sequences of start,
+** stop and tick on them. Every result is compared with a reference model that
+** counts down the time left of each timer, as the timer system did before the
+** heap: the return values of ABCC_TimerStart() and ABCC_TimerStop(), the
+** number of expired timers per tick and ABCC_TimerGetTimeToNextTmoMs().
+**
+** Usage: test_timer_heap [operations]
+********************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abcc_timer.h"
+
+#define TEST_CHECK( x )                                                        \
+   do                                                                          \
+   {                                                                           \
+      if( !( x ) )                                                             \
+      {                                                                        \
+         printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x );        \
+         test_fOk = FALSE;                                                     \
+      }                                                                        \
+   }                                                                           \
+   while( 0 )
+
+/*
+** Reference model of one timer.
+*/
+typedef struct RefTimerType
+{
+   BOOL  fActive;
+   BOOL  fTmoOccured;
+   INT32 lTimeLeft;
+}
+RefTimerType;
+
+static BOOL test_fOk = TRUE;
+static UINT32 test_lNumOperations = 200000;
+static UINT32 test_lNumTimeouts;
+
+static RefTimerType ref_asTimer[ ABCC_CFG_MAX_NUM_TIMERS ];
+
+static void TimeoutHandler( void )
+{
+   test_lNumTimeouts++;
+}
+
+/*------------------------------------------------------------------------------
+** Ticks the reference model.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iDeltaTimeMs - Time since the last tick.
+**
+** Returns:
+**    Number of timers that expired.
+**------------------------------------------------------------------------------
+*/
+static UINT32 RefTick( INT16 iDeltaTimeMs )
+{
+   UINT16 iTimer;
+   UINT32 lNumTimeouts = 0;
+
+   for( iTimer = 0; iTimer < ABCC_CFG_MAX_NUM_TIMERS; iTimer++ )
+   {
+      if( ref_asTimer[ iTimer ].fActive )
+      {
+         ref_asTimer[ iTimer ].lTimeLeft -= iDeltaTimeMs;
+         if( ref_asTimer[ iTimer ].lTimeLeft <= 0 )
+         {
+            ref_asTimer[ iTimer ].fActive = FALSE;
+            ref_asTimer[ iTimer ].fTmoOccured = TRUE;
+            lNumTimeouts++;
+         }
+      }
+   }
+
+   return( lNumTimeouts );
+}
+
+static UINT32 RefTimeToNextTmoMs( void )
+{
+   UINT16 iTimer;
+   UINT32 lTimeToTmo = ABCC_TIMER_NO_TMO;
+
+   for( iTimer = 0; iTimer < ABCC_CFG_MAX_NUM_TIMERS; iTimer++ )
+   {
+      if( ref_asTimer[ iTimer ].fActive )
+      {
+         if( ref_asTimer[ iTimer ].lTimeLeft <= 0 )
+         {
+            lTimeToTmo = 0;
+         }
+         else if( (UINT32)ref_asTimer[ iTimer ].lTimeLeft < lTimeToTmo )
+         {
+            lTimeToTmo = (UINT32)ref_asTimer[ iTimer ].lTimeLeft;
+         }
+      }
+   }
+
+   return( lTimeToTmo );
+}
+
+int main( int argc, char** argv )
+{
+   ABCC_TimerHandle xHandle;
+   UINT16 iTimer;
+   UINT32 lOperation;
+   UINT32 lNumRefTimeouts;
+   UINT32 lTimeoutMs;
+   INT16 iDeltaTimeMs;
+   BOOL fTmo;
+
+   if( argc > 1 )
+   {
+      test_lNumOperations = (UINT32)strtoul( argv[ 1 ], NULL, 0 );
+   }
+
+   srand( 1 );
+   ABCC_TimerInit();
+
+   /*
+   ** All timers can be created, one more can not.
+   */
+   for( iTimer = 0; iTimer < ABCC_CFG_MAX_NUM_TIMERS; iTimer++ )
+   {
+      TEST_CHECK( ABCC_TimerCreate( TimeoutHandler ) == iTimer );
+   }
+   TEST_CHECK( ABCC_TimerCreate( TimeoutHandler ) == ABCC_TIMER_NO_HANDLE );
+
+   for( lOperation = 0; ( lOperation < test_lNumOperations ) && test_fOk; lOperation++ )
+   {
+      xHandle = (ABCC_TimerHandle)( rand() % ABCC_CFG_MAX_NUM_TIMERS );
+
+      switch( rand() % 4 )
+      {
+      case 0:
+      case 1:
+         /*
+         ** Short timeouts with duplicates, so that timers expire in the same
+         ** tick and restarts move timers both ways in the heap.
+         */
+         lTimeoutMs = (UINT32)( rand() % 200 );
+         fTmo = ABCC_TimerStart( xHandle, lTimeoutMs );
+         TEST_CHECK( fTmo == ref_asTimer[ xHandle ].fTmoOccured );
+         ref_asTimer[ xHandle ].fActive = TRUE;
+         ref_asTimer[ xHandle ].fTmoOccured = FALSE;
+         ref_asTimer[ xHandle ].lTimeLeft = (INT32)lTimeoutMs;
+         break;
+
+      case 2:
+         fTmo = ABCC_TimerStop( xHandle );
+         TEST_CHECK( fTmo == ref_asTimer[ xHandle ].fTmoOccured );
+         ref_asTimer[ xHandle ].fActive = FALSE;
+         ref_asTimer[ xHandle ].fTmoOccured = FALSE;
+         break;
+
+      default:
+         iDeltaTimeMs = (INT16)( rand() % 5 );
+         test_lNumTimeouts = 0;
+         ABCC_TimerTick( iDeltaTimeMs );
+         lNumRefTimeouts = RefTick( iDeltaTimeMs );
+         TEST_CHECK( test_lNumTimeouts == lNumRefTimeouts );
+         break;
+      }
+
+      TEST_CHECK( ABCC_TimerGetTimeToNextTmoMs() == RefTimeToNextTmoMs() );
+   }
+
+   printf( "%s\n", test_fOk ? "OK" : "FAILED" );
+
+   return( test_fOk ? EXIT_SUCCESS : EXIT_FAILURE );
+}